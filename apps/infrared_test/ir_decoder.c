@@ -0,0 +1,523 @@
+#include <string.h>
+#include "ir_nec_timing.h"
+#include "ir_decoder.h"
+
+/**
+ * @brief Leader prefilter geometry
+ *
+ * Leader mark and space are each quantised into 256us buckets. Every bucket holds the mask of
+ * decoders whose leader window overlaps it, so candidates are two loads and an AND.
+ */
+#define IR_PREFILTER_SHIFT    8
+#define IR_PREFILTER_BUCKETS  64
+
+/**
+ * @brief Tolerance for pulse distance/width timings, in us
+ *
+ * Overridable at build time so tools/ir_fuzz can compare accuracy curves of different margins.
+ */
+#ifndef IR_DECODE_MARGIN
+#define IR_DECODE_MARGIN      300
+#endif
+
+/**
+ * @brief Timing specs of the non-NEC protocols, in microseconds
+ */
+#define SAMSUNG_LEADING_CODE_DURATION_0  4500
+#define SAMSUNG_LEADING_CODE_DURATION_1  4500
+
+#define SONY_LEADING_CODE_DURATION_0     2400
+#define SONY_LEADING_CODE_DURATION_1     600
+#define SONY_PAYLOAD_ZERO_DURATION_0     600
+#define SONY_PAYLOAD_ONE_DURATION_0      1200
+#define SONY_PAYLOAD_DURATION_1          600
+
+#define RC5_HALF_BIT_DURATION            889
+#define RC5_HALF_BITS                    28
+
+#define RC6_UNIT_DURATION                444
+#define RC6_LEADING_CODE_DURATION_0      2666
+#define RC6_LEADING_CODE_DURATION_1      889
+#define RC6_UNITS                        44
+
+typedef struct {
+    const ir_decoder_t *decoders[IR_DECODER_MAX_DECODERS];
+    size_t decoder_num;
+    uint16_t mark_buckets[IR_PREFILTER_BUCKETS];
+    uint16_t space_buckets[IR_PREFILTER_BUCKETS];
+    ir_decoder_stats_t stats;
+} ir_decoder_registry_t;
+
+static ir_decoder_registry_t s_registry;
+
+/**
+ * @brief Last decoded NEC code, reported by NEC repeat frames
+ */
+static ir_scan_code_t s_nec_last_code;
+
+static inline bool ir_in_range(uint32_t signal_duration, uint32_t spec_duration)
+{
+    return (signal_duration < (spec_duration + IR_DECODE_MARGIN)) &&
+           (signal_duration + IR_DECODE_MARGIN > spec_duration);
+}
+
+static inline uint32_t ir_bucket(uint32_t duration)
+{
+    uint32_t bucket = duration >> IR_PREFILTER_SHIFT;
+    return bucket < IR_PREFILTER_BUCKETS ? bucket : IR_PREFILTER_BUCKETS - 1;
+}
+
+/**
+ * @brief Read LSB-first pulse distance bits: fixed mark, space selects 0 or 1
+ */
+static bool ir_read_pulse_distance(const rmt_symbol_word_t *symbols, size_t bits, uint32_t mark,
+                                   uint32_t space0, uint32_t space1, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (size_t i = 0; i < bits; i++) {
+        if (!ir_in_range(symbols[i].duration0, mark)) {
+            return false;
+        }
+        if (ir_in_range(symbols[i].duration1, space1)) {
+            result |= 1u << i;
+        } else if (!ir_in_range(symbols[i].duration1, space0)) {
+            return false;
+        }
+    }
+    *value = result;
+    return true;
+}
+
+/**
+ * @brief Expand mark/space durations into a per-unit level stream (1 = mark)
+ *
+ * Each duration must round to 1..3 units. A zero duration or an over-long final space
+ * terminates the stream.
+ *
+ * @return Number of units written, 0 on malformed input
+ */
+static size_t ir_expand_units(const rmt_symbol_word_t *symbols, size_t symbol_num, uint32_t unit,
+                              uint8_t *levels, size_t max_units)
+{
+    size_t unit_num = 0;
+    for (size_t i = 0; i < symbol_num; i++) {
+        const uint32_t durations[2] = {symbols[i].duration0, symbols[i].duration1};
+        for (int half = 0; half < 2; half++) {
+            if (durations[half] == 0) {
+                return unit_num;
+            }
+            uint32_t units = (durations[half] + unit / 2) / unit;
+            if (units > 3 && half == 1 && i == symbol_num - 1) {
+                return unit_num;
+            }
+            if (units == 0 || units > 3 || unit_num + units > max_units) {
+                return 0;
+            }
+            for (uint32_t u = 0; u < units; u++) {
+                levels[unit_num++] = (half == 0);
+            }
+        }
+    }
+    return unit_num;
+}
+
+/**
+ * @brief Read a Manchester bit spanning 2 * width units, returns 0/1 or -1 if not a valid transition
+ */
+static int ir_read_manchester(const uint8_t *levels, size_t width, uint8_t one_first_level)
+{
+    for (size_t u = 1; u < width; u++) {
+        if (levels[u] != levels[0] || levels[width + u] != levels[width]) {
+            return -1;
+        }
+    }
+    if (levels[0] == levels[width]) {
+        return -1;
+    }
+    return levels[0] == one_first_level;
+}
+
+static bool ir_decode_nec(const rmt_symbol_word_t *symbols, size_t symbol_num, ir_scan_code_t *out)
+{
+    if (symbol_num == 2) {
+        if (!ir_in_range(symbols[0].duration0, NEC_REPEAT_CODE_DURATION_0) ||
+            !ir_in_range(symbols[0].duration1, NEC_REPEAT_CODE_DURATION_1) ||
+            s_nec_last_code.protocol != IR_PROTO_NEC) {
+            return false;
+        }
+        *out = s_nec_last_code;
+        out->flags |= IR_SCAN_FLAG_REPEAT;
+        return true;
+    }
+    if (symbol_num != 34 ||
+        !ir_in_range(symbols[0].duration0, NEC_LEADING_CODE_DURATION_0) ||
+        !ir_in_range(symbols[0].duration1, NEC_LEADING_CODE_DURATION_1)) {
+        return false;
+    }
+    uint32_t payload;
+    if (!ir_read_pulse_distance(&symbols[1], 32, NEC_PAYLOAD_ZERO_DURATION_0,
+                                NEC_PAYLOAD_ZERO_DURATION_1, NEC_PAYLOAD_ONE_DURATION_1, &payload)) {
+        return false;
+    }
+    *out = (ir_scan_code_t) {
+        .protocol = IR_PROTO_NEC,
+        .bits = 32,
+        .address = payload & 0xFFFF,
+        .command = payload >> 16,
+    };
+    s_nec_last_code = *out;
+    return true;
+}
+
+static bool ir_decode_samsung(const rmt_symbol_word_t *symbols, size_t symbol_num, ir_scan_code_t *out)
+{
+    if (symbol_num != 34 ||
+        !ir_in_range(symbols[0].duration0, SAMSUNG_LEADING_CODE_DURATION_0) ||
+        !ir_in_range(symbols[0].duration1, SAMSUNG_LEADING_CODE_DURATION_1)) {
+        return false;
+    }
+    uint32_t payload;
+    if (!ir_read_pulse_distance(&symbols[1], 32, NEC_PAYLOAD_ZERO_DURATION_0,
+                                NEC_PAYLOAD_ZERO_DURATION_1, NEC_PAYLOAD_ONE_DURATION_1, &payload)) {
+        return false;
+    }
+    *out = (ir_scan_code_t) {
+        .protocol = IR_PROTO_SAMSUNG,
+        .bits = 32,
+        .address = payload & 0xFFFF,
+        .command = payload >> 16,
+    };
+    return true;
+}
+
+static bool ir_decode_sony(const rmt_symbol_word_t *symbols, size_t symbol_num, ir_scan_code_t *out)
+{
+    size_t bits = symbol_num - 1;
+    if (bits != 12 && bits != 15 && bits != 20) {
+        return false;
+    }
+    if (!ir_in_range(symbols[0].duration0, SONY_LEADING_CODE_DURATION_0) ||
+        !ir_in_range(symbols[0].duration1, SONY_LEADING_CODE_DURATION_1)) {
+        return false;
+    }
+    uint32_t payload = 0;
+    for (size_t i = 0; i < bits; i++) {
+        const rmt_symbol_word_t *sym = &symbols[1 + i];
+        // the last space merges into the idle gap and is not checked
+        if (i + 1 < bits && !ir_in_range(sym->duration1, SONY_PAYLOAD_DURATION_1)) {
+            return false;
+        }
+        if (ir_in_range(sym->duration0, SONY_PAYLOAD_ONE_DURATION_0)) {
+            payload |= 1u << i;
+        } else if (!ir_in_range(sym->duration0, SONY_PAYLOAD_ZERO_DURATION_0)) {
+            return false;
+        }
+    }
+    *out = (ir_scan_code_t) {
+        .protocol = IR_PROTO_SONY,
+        .bits = bits,
+        .address = payload >> 7,
+        .command = payload & 0x7F,
+    };
+    return true;
+}
+
+static bool ir_decode_rc5(const rmt_symbol_word_t *symbols, size_t symbol_num, ir_scan_code_t *out)
+{
+    uint8_t levels[RC5_HALF_BITS + 1];
+    // the first half of the start bit is a space and merges into the idle line
+    levels[0] = 0;
+    size_t half_bits = 1 + ir_expand_units(symbols, symbol_num, RC5_HALF_BIT_DURATION, &levels[1], RC5_HALF_BITS);
+    if (half_bits == RC5_HALF_BITS - 1) {
+        levels[half_bits++] = 0; // trailing space of a final zero bit merges into the idle line
+    }
+    if (half_bits != RC5_HALF_BITS) {
+        return false;
+    }
+    uint32_t frame = 0;
+    for (size_t bit = 0; bit < RC5_HALF_BITS / 2; bit++) {
+        int value = ir_read_manchester(&levels[2 * bit], 1, 0);
+        if (value < 0) {
+            return false;
+        }
+        frame = (frame << 1) | (uint32_t)value;
+    }
+    // frame: S1 | S2 (inverted command bit 6) | toggle | 5 address bits | 6 command bits
+    if (!(frame & (1u << 13))) {
+        return false;
+    }
+    *out = (ir_scan_code_t) {
+        .protocol = IR_PROTO_RC5,
+        .bits = 14,
+        .flags = (frame & (1u << 11)) ? IR_SCAN_FLAG_TOGGLE : 0,
+        .address = (frame >> 6) & 0x1F,
+        .command = (frame & 0x3F) | ((frame & (1u << 12)) ? 0 : 0x40),
+    };
+    return true;
+}
+
+static bool ir_decode_rc6(const rmt_symbol_word_t *symbols, size_t symbol_num, ir_scan_code_t *out)
+{
+    if (!ir_in_range(symbols[0].duration0, RC6_LEADING_CODE_DURATION_0) ||
+        !ir_in_range(symbols[0].duration1, RC6_LEADING_CODE_DURATION_1)) {
+        return false;
+    }
+    uint8_t levels[RC6_UNITS];
+    size_t units = ir_expand_units(&symbols[1], symbol_num - 1, RC6_UNIT_DURATION, levels, RC6_UNITS);
+    if (units == 0 || units + 1 < RC6_UNITS) {
+        return false;
+    }
+    while (units < RC6_UNITS) {
+        levels[units++] = 0; // trailing space of a final one bit merges into the idle line
+    }
+    // start bit, 3 mode bits, double width trailer (toggle), 8 address bits, 8 command bits
+    uint32_t frame = 0;
+    size_t pos = 0;
+    for (size_t bit = 0; bit < 21; bit++) {
+        size_t width = (bit == 4) ? 2 : 1;
+        int value = ir_read_manchester(&levels[pos], width, 1);
+        if (value < 0) {
+            return false;
+        }
+        frame = (frame << 1) | (uint32_t)value;
+        pos += 2 * width;
+    }
+    if (!(frame & (1u << 20)) || (frame & (0x7u << 17))) {
+        return false; // missing start bit or not mode 0
+    }
+    *out = (ir_scan_code_t) {
+        .protocol = IR_PROTO_RC6,
+        .bits = 16,
+        .flags = (frame & (1u << 16)) ? IR_SCAN_FLAG_TOGGLE : 0,
+        .address = (frame >> 8) & 0xFF,
+        .command = frame & 0xFF,
+    };
+    return true;
+}
+
+/**
+ * @brief Generic pulse distance fallback: constant marks, two space classes
+ */
+static bool ir_decode_pulse_distance(const rmt_symbol_word_t *symbols, size_t symbol_num, ir_scan_code_t *out)
+{
+    // leader and trailing stop mark are not payload
+    size_t bits = symbol_num - 2;
+    const rmt_symbol_word_t *payload = &symbols[1];
+    if (bits > 64) {
+        return false;
+    }
+    uint32_t mark = payload[0].duration0;
+    uint32_t space_min = UINT32_MAX;
+    uint32_t space_max = 0;
+    for (size_t i = 0; i < bits; i++) {
+        if (!ir_in_range(payload[i].duration0, mark)) {
+            return false;
+        }
+        space_min = payload[i].duration1 < space_min ? payload[i].duration1 : space_min;
+        space_max = payload[i].duration1 > space_max ? payload[i].duration1 : space_max;
+    }
+    if (space_max * 2 < space_min * 3) {
+        return false; // spaces are not bimodal
+    }
+    uint32_t threshold = (space_min + space_max) / 2;
+    uint64_t value = 0;
+    for (size_t i = 0; i < bits; i++) {
+        uint32_t space = payload[i].duration1;
+        uint32_t nearest = space >= threshold ? space_max : space_min;
+        if (space + nearest / 4 < nearest || space > nearest + nearest / 4) {
+            return false;
+        }
+        if (space >= threshold) {
+            value |= 1ull << i;
+        }
+    }
+    *out = (ir_scan_code_t) {
+        .protocol = IR_PROTO_PULSE_DISTANCE,
+        .bits = bits,
+        .address = (uint32_t)(value >> 32),
+        .command = (uint32_t)value,
+    };
+    return true;
+}
+
+static const ir_decoder_t s_default_decoders[] = {
+    {
+        .name = "NEC", .protocol = IR_PROTO_NEC,
+        .leader_mark_min = NEC_LEADING_CODE_DURATION_0 - IR_DECODE_MARGIN,
+        .leader_mark_max = NEC_LEADING_CODE_DURATION_0 + IR_DECODE_MARGIN,
+        .leader_space_min = NEC_REPEAT_CODE_DURATION_1 - IR_DECODE_MARGIN,
+        .leader_space_max = NEC_LEADING_CODE_DURATION_1 + IR_DECODE_MARGIN,
+        .min_symbols = 2, .max_symbols = 34,
+        .decode = ir_decode_nec,
+    },
+    {
+        .name = "Samsung", .protocol = IR_PROTO_SAMSUNG,
+        .leader_mark_min = SAMSUNG_LEADING_CODE_DURATION_0 - IR_DECODE_MARGIN,
+        .leader_mark_max = SAMSUNG_LEADING_CODE_DURATION_0 + IR_DECODE_MARGIN,
+        .leader_space_min = SAMSUNG_LEADING_CODE_DURATION_1 - IR_DECODE_MARGIN,
+        .leader_space_max = SAMSUNG_LEADING_CODE_DURATION_1 + IR_DECODE_MARGIN,
+        .min_symbols = 34, .max_symbols = 34,
+        .decode = ir_decode_samsung,
+    },
+    {
+        // ahead of Sony: the leader windows overlap and Sony's pulse width check accepts RC6 units
+        .name = "RC6", .protocol = IR_PROTO_RC6,
+        .leader_mark_min = RC6_LEADING_CODE_DURATION_0 - IR_DECODE_MARGIN,
+        .leader_mark_max = RC6_LEADING_CODE_DURATION_0 + IR_DECODE_MARGIN,
+        .leader_space_min = RC6_LEADING_CODE_DURATION_1 - IR_DECODE_MARGIN,
+        .leader_space_max = RC6_LEADING_CODE_DURATION_1 + IR_DECODE_MARGIN,
+        .min_symbols = 11, .max_symbols = 23,
+        .decode = ir_decode_rc6,
+    },
+    {
+        .name = "Sony", .protocol = IR_PROTO_SONY,
+        .leader_mark_min = SONY_LEADING_CODE_DURATION_0 - IR_DECODE_MARGIN,
+        .leader_mark_max = SONY_LEADING_CODE_DURATION_0 + IR_DECODE_MARGIN,
+        .leader_space_min = SONY_LEADING_CODE_DURATION_1 - IR_DECODE_MARGIN,
+        .leader_space_max = SONY_LEADING_CODE_DURATION_1 + IR_DECODE_MARGIN,
+        .min_symbols = 13, .max_symbols = 21,
+        .decode = ir_decode_sony,
+    },
+    {
+        // no leader: the first mark is one or two half bits
+        .name = "RC5", .protocol = IR_PROTO_RC5,
+        .leader_mark_min = RC5_HALF_BIT_DURATION / 2,
+        .leader_mark_max = RC5_HALF_BIT_DURATION * 5 / 2,
+        .leader_space_min = RC5_HALF_BIT_DURATION / 2,
+        .leader_space_max = RC5_HALF_BIT_DURATION * 5 / 2,
+        .min_symbols = 7, .max_symbols = 14,
+        .decode = ir_decode_rc5,
+    },
+    {
+        .name = "PulseDistance", .protocol = IR_PROTO_PULSE_DISTANCE,
+        .leader_mark_min = 0, .leader_mark_max = UINT16_MAX,
+        .leader_space_min = 0, .leader_space_max = UINT16_MAX,
+        .min_symbols = 10, .max_symbols = 66,
+        .decode = ir_decode_pulse_distance,
+    },
+};
+
+esp_err_t ir_decoder_register(const ir_decoder_t *decoder)
+{
+    if (!decoder || !decoder->decode || decoder->min_symbols == 0 ||
+        decoder->min_symbols > decoder->max_symbols ||
+        decoder->leader_mark_min > decoder->leader_mark_max ||
+        decoder->leader_space_min > decoder->leader_space_max) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_registry.decoder_num >= IR_DECODER_MAX_DECODERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    uint16_t bit = 1u << s_registry.decoder_num;
+    for (uint32_t b = ir_bucket(decoder->leader_mark_min); b <= ir_bucket(decoder->leader_mark_max); b++) {
+        s_registry.mark_buckets[b] |= bit;
+    }
+    for (uint32_t b = ir_bucket(decoder->leader_space_min); b <= ir_bucket(decoder->leader_space_max); b++) {
+        s_registry.space_buckets[b] |= bit;
+    }
+    s_registry.decoders[s_registry.decoder_num++] = decoder;
+    return ESP_OK;
+}
+
+esp_err_t ir_decoder_register_defaults(void)
+{
+    for (size_t i = 0; i < sizeof(s_default_decoders) / sizeof(s_default_decoders[0]); i++) {
+        esp_err_t err = ir_decoder_register(&s_default_decoders[i]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+void ir_decoder_reset(void)
+{
+    memset(&s_registry, 0, sizeof(s_registry));
+    memset(&s_nec_last_code, 0, sizeof(s_nec_last_code));
+}
+
+uint32_t ir_decoder_candidates(uint32_t leader_mark, uint32_t leader_space)
+{
+    return s_registry.mark_buckets[ir_bucket(leader_mark)] & s_registry.space_buckets[ir_bucket(leader_space)];
+}
+
+/**
+ * @brief Exact leader window and symbol count check, the buckets are coarse
+ */
+static inline bool ir_decoder_fits(const ir_decoder_t *decoder, uint32_t mark, uint32_t space, size_t symbol_num)
+{
+    return symbol_num >= decoder->min_symbols && symbol_num <= decoder->max_symbols &&
+           mark >= decoder->leader_mark_min && mark <= decoder->leader_mark_max &&
+           space >= decoder->leader_space_min && space <= decoder->leader_space_max;
+}
+
+uint32_t ir_decoder_plausible(const rmt_symbol_word_t *symbols, size_t symbol_num)
+{
+    if (!symbols || symbol_num == 0) {
+        return 0;
+    }
+    uint32_t mark = symbols[0].duration0;
+    uint32_t space = symbols[0].duration1;
+    uint32_t candidates = ir_decoder_candidates(mark, space);
+    uint32_t plausible = 0;
+    while (candidates) {
+        size_t idx = __builtin_ctz(candidates);
+        candidates &= candidates - 1;
+        if (ir_decoder_fits(s_registry.decoders[idx], mark, space, symbol_num)) {
+            plausible |= 1u << idx;
+        }
+    }
+    return plausible;
+}
+
+const ir_decoder_t *ir_decoder_decode(const rmt_symbol_word_t *symbols, size_t symbol_num, ir_scan_code_t *out)
+{
+    s_registry.stats.frames++;
+    if (!symbols || !out || symbol_num == 0) {
+        s_registry.stats.decoded[IR_PROTO_UNKNOWN]++;
+        return NULL;
+    }
+    uint32_t mark = symbols[0].duration0;
+    uint32_t space = symbols[0].duration1;
+    uint32_t candidates = ir_decoder_candidates(mark, space);
+    if (!candidates) {
+        s_registry.stats.prefiltered++;
+    }
+    while (candidates) {
+        size_t idx = __builtin_ctz(candidates);
+        candidates &= candidates - 1;
+        const ir_decoder_t *decoder = s_registry.decoders[idx];
+        // buckets are coarse, re-check the exact window before paying for a decode
+        if (!ir_decoder_fits(decoder, mark, space, symbol_num)) {
+            continue;
+        }
+        s_registry.stats.attempts++;
+        if (decoder->decode(symbols, symbol_num, out)) {
+            s_registry.stats.decoded[decoder->protocol]++;
+            return decoder;
+        }
+    }
+    s_registry.stats.decoded[IR_PROTO_UNKNOWN]++;
+    return NULL;
+}
+
+void ir_decoder_get_stats(ir_decoder_stats_t *stats)
+{
+    if (stats) {
+        *stats = s_registry.stats;
+    }
+}
+
+const char *ir_decoder_protocol_name(ir_protocol_t protocol)
+{
+    static const char *const names[IR_PROTO_MAX] = {
+        [IR_PROTO_UNKNOWN] = "Unknown",
+        [IR_PROTO_NEC] = "NEC",
+        [IR_PROTO_SAMSUNG] = "Samsung",
+        [IR_PROTO_SONY] = "Sony",
+        [IR_PROTO_RC5] = "RC5",
+        [IR_PROTO_RC6] = "RC6",
+        [IR_PROTO_PULSE_DISTANCE] = "PulseDistance",
+    };
+    return (protocol < IR_PROTO_MAX) ? names[protocol] : names[IR_PROTO_UNKNOWN];
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "hal/rmt_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum number of decoders that can be registered
+ */
+#define IR_DECODER_MAX_DECODERS  16
+
+/**
+ * @brief Supported IR protocols
+ */
+typedef enum {
+    IR_PROTO_UNKNOWN = 0,
+    IR_PROTO_NEC,
+    IR_PROTO_SAMSUNG,
+    IR_PROTO_SONY,
+    IR_PROTO_RC5,
+    IR_PROTO_RC6,
+    IR_PROTO_PULSE_DISTANCE,
+    IR_PROTO_MAX,
+} ir_protocol_t;
+
+#define IR_SCAN_FLAG_REPEAT  (1u << 0) /*!< Frame is a repeat code, address/command are the last decoded ones */
+#define IR_SCAN_FLAG_TOGGLE  (1u << 1) /*!< RC5/RC6 toggle bit was set */
+
+/**
+ * @brief Compact, protocol-tagged scan code of a recognised frame
+ */
+typedef struct {
+    uint8_t protocol; /*!< ir_protocol_t */
+    uint8_t bits;     /*!< Number of payload bits decoded */
+    uint8_t flags;    /*!< IR_SCAN_FLAG_* */
+    uint8_t rsvd;
+    uint32_t address; /*!< Protocol address field (or high payload bits for pulse distance) */
+    uint32_t command; /*!< Protocol command field (or low payload bits for pulse distance) */
+} ir_scan_code_t;
+
+/**
+ * @brief Decoder callback, returns true if the frame was decoded into out
+ *
+ * Symbols are raw RX captures: duration0 is the mark, duration1 the following space.
+ */
+typedef bool (*ir_decode_fn_t)(const rmt_symbol_word_t *symbols, size_t symbol_num, ir_scan_code_t *out);
+
+/**
+ * @brief Protocol decoder descriptor
+ *
+ * The leader window is used by the prefilter to skip decoders that cannot match,
+ * use 0 / UINT16_MAX bounds for protocols without a fixed leader.
+ */
+typedef struct {
+    const char *name;          /*!< Protocol name, for logs */
+    ir_protocol_t protocol;    /*!< Protocol tag put in decoded scan codes */
+    uint16_t leader_mark_min;  /*!< Leader mark window, in us */
+    uint16_t leader_mark_max;
+    uint16_t leader_space_min; /*!< Leader space window, in us */
+    uint16_t leader_space_max;
+    uint16_t min_symbols;      /*!< Symbol count bounds, inclusive */
+    uint16_t max_symbols;
+    ir_decode_fn_t decode;     /*!< Decode callback */
+} ir_decoder_t;
+
+/**
+ * @brief Decode path counters
+ */
+typedef struct {
+    uint32_t frames;                    /*!< Frames passed to ir_decoder_decode() */
+    uint32_t prefiltered;               /*!< Frames with no plausible decoder after the prefilter */
+    uint32_t attempts;                  /*!< Decoder callbacks invoked */
+    uint32_t decoded[IR_PROTO_MAX];     /*!< Frames decoded, per protocol (IR_PROTO_UNKNOWN = undecoded) */
+} ir_decoder_stats_t;
+
+/**
+ * @brief Register a protocol decoder
+ *
+ * Decoders are tried in registration order, register generic fallbacks last.
+ *
+ * @param[in] decoder Decoder descriptor, must stay valid while registered
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_ERR_NO_MEM if IR_DECODER_MAX_DECODERS are already registered
+ *      - ESP_OK on success
+ */
+esp_err_t ir_decoder_register(const ir_decoder_t *decoder);
+
+/**
+ * @brief Register the built-in NEC, Samsung, RC6, Sony, RC5 and pulse distance decoders
+ */
+esp_err_t ir_decoder_register_defaults(void);
+
+/**
+ * @brief Remove all decoders and reset the counters
+ */
+void ir_decoder_reset(void);
+
+/**
+ * @brief Decode a captured frame with the first matching plausible decoder
+ *
+ * @param[in] symbols Raw RX symbols
+ * @param[in] symbol_num Number of symbols
+ * @param[out] out Decoded scan code, only written on success
+ * @return Decoder that recognised the frame, NULL if none did
+ */
+const ir_decoder_t *ir_decoder_decode(const rmt_symbol_word_t *symbols, size_t symbol_num, ir_scan_code_t *out);
+
+/**
+ * @brief Bitmask of registered decoders whose leader window contains (mark, space)
+ *
+ * Bit n corresponds to the n-th registered decoder. Constant time.
+ */
+uint32_t ir_decoder_candidates(uint32_t leader_mark, uint32_t leader_space);
+
+/**
+ * @brief Bitmask of registered decoders whose exact leader window and symbol count bounds fit the frame
+ *
+ * The check ir_decoder_decode() makes before invoking a decoder, without invoking any.
+ * Bit n corresponds to the n-th registered decoder.
+ */
+uint32_t ir_decoder_plausible(const rmt_symbol_word_t *symbols, size_t symbol_num);
+
+/**
+ * @brief Get a copy of the decode path counters
+ */
+void ir_decoder_get_stats(ir_decoder_stats_t *stats);
+
+/**
+ * @brief Printable protocol name
+ */
+const char *ir_decoder_protocol_name(ir_protocol_t protocol);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "ir_nec_timing.h"
+#include "ir_symbol_kernels.h"
+#include "ir_kernel_bench.h"
+#include "os_crc32.h"
+
+#define IR_BENCH_MAX_SYMBOLS  512
+#define IR_BENCH_ITERATIONS   200
+
+static const char *TAG = "IR_bench";
+
+typedef void (*ir_bench_kernel_t)(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num);
+typedef uint32_t (*ir_bench_crc_t)(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num);
+
+static rmt_symbol_word_t s_bench_input[IR_BENCH_MAX_SYMBOLS];
+static rmt_symbol_word_t s_bench_output[IR_BENCH_MAX_SYMBOLS];
+static rmt_symbol_word_t s_bench_check[IR_BENCH_MAX_SYMBOLS];
+
+/**
+ * @brief Fill the input with back-to-back NEC frames as captured by the RX channel
+ *
+ * Levels are inverted (active-low receiver) and durations carry a few tens of us of jitter.
+ */
+static void ir_bench_fill_input(void)
+{
+    uint32_t seed = 0x1234567u;
+    for (size_t i = 0; i < IR_BENCH_MAX_SYMBOLS; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        int jitter0 = (int)((seed >> 8) % 121) - 60;
+        int jitter1 = (int)((seed >> 20) % 121) - 60;
+        size_t pos = i % 34;
+        uint32_t d0 = NEC_PAYLOAD_ZERO_DURATION_0;
+        uint32_t d1 = (seed & 0x80) ? NEC_PAYLOAD_ONE_DURATION_1 : NEC_PAYLOAD_ZERO_DURATION_1;
+        if (pos == 0) {
+            d0 = NEC_LEADING_CODE_DURATION_0;
+            d1 = NEC_LEADING_CODE_DURATION_1;
+        } else if (pos == 33) {
+            d1 = 12000; // inter-frame gap, exercises the fallback path
+        }
+        s_bench_input[i] = (rmt_symbol_word_t) {
+            .level0 = 0,
+            .duration0 = d0 + jitter0,
+            .level1 = 1,
+            .duration1 = d1 + jitter1,
+        };
+    }
+}
+
+static void ir_bench_invert_ref(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num)
+{
+    ir_symbols_invert_ref(input, output, symbol_num);
+}
+
+static void ir_bench_normalize_ref(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num)
+{
+    ir_symbols_invert_ref(input, output, symbol_num);
+    ir_symbols_normalize_ref(output, symbol_num);
+}
+
+static float ir_bench_measure(ir_bench_kernel_t kernel, size_t symbol_num)
+{
+    int64_t start = esp_timer_get_time();
+    for (int it = 0; it < IR_BENCH_ITERATIONS; it++) {
+        kernel(s_bench_input, s_bench_output, symbol_num);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    if (elapsed_us <= 0) {
+        elapsed_us = 1;
+    }
+    return (float)(symbol_num * IR_BENCH_ITERATIONS) / (float)elapsed_us;
+}
+
+static void ir_bench_compare(const char *name, ir_bench_kernel_t ref, ir_bench_kernel_t word, size_t symbol_num)
+{
+    ref(s_bench_input, s_bench_check, symbol_num);
+    word(s_bench_input, s_bench_output, symbol_num);
+    bool match = memcmp(s_bench_check, s_bench_output, symbol_num * sizeof(rmt_symbol_word_t)) == 0;
+
+    float ref_rate = ir_bench_measure(ref, symbol_num);
+    float word_rate = ir_bench_measure(word, symbol_num);
+    printf("%-10s %4u symbols: ref %7.2f sym/us, word %7.2f sym/us, speedup x%.2f%s\r\n",
+           name, (unsigned)symbol_num, ref_rate, word_rate, word_rate / ref_rate,
+           match ? "" : " (OUTPUT MISMATCH)");
+}
+
+static uint32_t ir_bench_crc_bytewise(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num)
+{
+    (void)output;
+    return os_crc32_update_bytewise(OS_CRC32_INIT, input, symbol_num * sizeof(rmt_symbol_word_t));
+}
+
+static uint32_t ir_bench_crc_sliced(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num)
+{
+    (void)output;
+    return os_crc32_update_sliced(OS_CRC32_INIT, input, symbol_num * sizeof(rmt_symbol_word_t));
+}
+
+static uint32_t ir_bench_crc_default(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num)
+{
+    (void)output;
+    return os_crc32_update(OS_CRC32_INIT, input, symbol_num * sizeof(rmt_symbol_word_t));
+}
+
+/* What the replay path did before: copy, then a separate bytewise validation pass */
+static uint32_t ir_bench_crc_copy_2pass(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num)
+{
+    memcpy(output, input, symbol_num * sizeof(rmt_symbol_word_t));
+    return os_crc32_update_bytewise(OS_CRC32_INIT, output, symbol_num * sizeof(rmt_symbol_word_t));
+}
+
+static uint32_t ir_bench_crc_copy_fused(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num)
+{
+    return os_crc32_copy(output, input, symbol_num * sizeof(rmt_symbol_word_t), OS_CRC32_INIT);
+}
+
+static float ir_bench_measure_crc(ir_bench_crc_t crc_fn, size_t symbol_num, uint32_t *crc)
+{
+    int64_t start = esp_timer_get_time();
+    for (int it = 0; it < IR_BENCH_ITERATIONS; it++) {
+        *crc = crc_fn(s_bench_input, s_bench_output, symbol_num);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    if (elapsed_us <= 0) {
+        elapsed_us = 1;
+    }
+    return (float)(symbol_num * sizeof(rmt_symbol_word_t) * IR_BENCH_ITERATIONS) / (float)elapsed_us;
+}
+
+/**
+ * @brief Compare the CRC-32 engines in MB/s (bytes/us) against the bytewise table reference
+ */
+static void ir_bench_crc(size_t symbol_num)
+{
+    static const struct {
+        const char *name;
+        ir_bench_crc_t fn;
+    } engines[] = {
+        {"bytewise", ir_bench_crc_bytewise},
+        {"slice-by-4", ir_bench_crc_sliced},
+        {OS_CRC32_USE_ROM ? "rom" : "default", ir_bench_crc_default},
+        {"copy+bytewise", ir_bench_crc_copy_2pass},
+        {"copy+crc fused", ir_bench_crc_copy_fused},
+    };
+    uint32_t ref_crc = 0;
+    float ref_rate = ir_bench_measure_crc(engines[0].fn, symbol_num, &ref_crc);
+
+    for (size_t i = 0; i < sizeof(engines) / sizeof(engines[0]); i++) {
+        uint32_t crc = 0;
+        float rate = i ? ir_bench_measure_crc(engines[i].fn, symbol_num, &crc) : ref_rate;
+        if (i == 0) {
+            crc = ref_crc;
+        }
+        printf("crc32 %-14s %4u symbols: %7.2f MB/s, x%.2f%s\r\n",
+               engines[i].name, (unsigned)symbol_num, rate, rate / ref_rate,
+               crc == ref_crc ? "" : " (CRC MISMATCH)");
+    }
+}
+
+void ir_kernel_bench_run(void)
+{
+    static const size_t frame_sizes[] = {64, 256, 512};
+
+    ESP_LOGI(TAG, "symbol kernel benchmark, %d iterations per run", IR_BENCH_ITERATIONS);
+    ir_bench_fill_input();
+    for (size_t i = 0; i < sizeof(frame_sizes) / sizeof(frame_sizes[0]); i++) {
+        ir_bench_compare("invert", ir_bench_invert_ref, ir_symbols_invert, frame_sizes[i]);
+        ir_bench_compare("normalize", ir_bench_normalize_ref, ir_symbols_normalize_frame, frame_sizes[i]);
+    }
+
+    uint32_t check = os_crc32_update(OS_CRC32_INIT, "123456789", 9);
+    if (check != OS_CRC32_CHECK) {
+        ESP_LOGE(TAG, "crc32 check value %08" PRIx32 " != %08" PRIx32, check, (uint32_t)OS_CRC32_CHECK);
+    }
+    for (size_t i = 0; i < sizeof(frame_sizes) / sizeof(frame_sizes[0]); i++) {
+        ir_bench_crc(frame_sizes[i]);
+    }
+}
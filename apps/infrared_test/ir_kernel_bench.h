@@ -0,0 +1,18 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Benchmark the IR symbol kernels and print symbols/us per variant
+ *
+ * Runs the reference and word-level kernels on 64, 256 and 512 symbol frames built from
+ * a jittered NEC capture, and checks that both variants produce identical output. Also
+ * compares the CRC-32 engines (bytewise, slice-by-4, ROM, fused copy) on the same frames.
+ */
+void ir_kernel_bench_run(void);
+
+#ifdef __cplusplus
+}
+#endif
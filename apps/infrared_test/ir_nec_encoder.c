@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
 #include "esp_check.h"
+#include "freertos/FreeRTOS.h"
 #include "ir_nec_encoder.h"
 
 static const char *TAG = "nec_encoder";
@@ -16,8 +18,37 @@ typedef struct {
     rmt_symbol_word_t nec_leading_symbol; // NEC leading code with RMT representation
     rmt_symbol_word_t nec_ending_symbol;  // NEC ending code with RMT representation
     int state;
+    bool in_use;                  // slot taken in the static pool
 } rmt_ir_nec_encoder_t;
 
+// NEC encoders live in a static pool instead of rmt_alloc_encoder_mem(): .bss is internal RAM,
+// as the RMT ISR requires, and creating/deleting encoders never touches the heap
+static rmt_ir_nec_encoder_t s_nec_encoder_pool[IR_NEC_ENCODER_POOL_SIZE];
+static portMUX_TYPE s_nec_encoder_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static rmt_ir_nec_encoder_t *ir_nec_encoder_pool_take(void)
+{
+    rmt_ir_nec_encoder_t *nec_encoder = NULL;
+    portENTER_CRITICAL(&s_nec_encoder_pool_lock);
+    for (size_t i = 0; i < IR_NEC_ENCODER_POOL_SIZE; i++) {
+        if (!s_nec_encoder_pool[i].in_use) {
+            nec_encoder = &s_nec_encoder_pool[i];
+            memset(nec_encoder, 0, sizeof(*nec_encoder));
+            nec_encoder->in_use = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_nec_encoder_pool_lock);
+    return nec_encoder;
+}
+
+static void ir_nec_encoder_pool_give(rmt_ir_nec_encoder_t *nec_encoder)
+{
+    portENTER_CRITICAL(&s_nec_encoder_pool_lock);
+    nec_encoder->in_use = false;
+    portEXIT_CRITICAL(&s_nec_encoder_pool_lock);
+}
+
 static size_t rmt_encode_ir_nec(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
 {
     rmt_ir_nec_encoder_t *nec_encoder = __containerof(encoder, rmt_ir_nec_encoder_t, base);
@@ -81,7 +112,7 @@ static esp_err_t rmt_del_ir_nec_encoder(rmt_encoder_t *encoder)
     rmt_ir_nec_encoder_t *nec_encoder = __containerof(encoder, rmt_ir_nec_encoder_t, base);
     rmt_del_encoder(nec_encoder->copy_encoder);
     rmt_del_encoder(nec_encoder->bytes_encoder);
-    free(nec_encoder);
+    ir_nec_encoder_pool_give(nec_encoder);
     return ESP_OK;
 }
 
@@ -99,8 +130,8 @@ esp_err_t rmt_new_ir_nec_encoder(const ir_nec_encoder_config_t *config, rmt_enco
     esp_err_t ret = ESP_OK;
     rmt_ir_nec_encoder_t *nec_encoder = NULL;
     ESP_GOTO_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
-    nec_encoder = rmt_alloc_encoder_mem(sizeof(rmt_ir_nec_encoder_t));
-    ESP_GOTO_ON_FALSE(nec_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for ir nec encoder");
+    nec_encoder = ir_nec_encoder_pool_take();
+    ESP_GOTO_ON_FALSE(nec_encoder, ESP_ERR_NO_MEM, err, TAG, "ir nec encoder pool exhausted (IR_NEC_ENCODER_POOL_SIZE=%d)", IR_NEC_ENCODER_POOL_SIZE);
     nec_encoder->base.encode = rmt_encode_ir_nec;
     nec_encoder->base.del = rmt_del_ir_nec_encoder;
     nec_encoder->base.reset = rmt_ir_nec_encoder_reset;
@@ -148,7 +179,7 @@ err:
         if (nec_encoder->copy_encoder) {
             rmt_del_encoder(nec_encoder->copy_encoder);
         }
-        free(nec_encoder);
+        ir_nec_encoder_pool_give(nec_encoder);
     }
     return ret;
 }
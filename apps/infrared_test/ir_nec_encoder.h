@@ -12,6 +12,13 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Number of IR NEC encoders that can exist at the same time (static pool, no heap)
+ */
+#ifndef IR_NEC_ENCODER_POOL_SIZE
+#define IR_NEC_ENCODER_POOL_SIZE 1
+#endif
+
 /**
  * @brief IR NEC scan code representation
  */
@@ -34,14 +41,17 @@ typedef struct {
  * @param[out] ret_encoder Returned encoder handle
  * @return
  *      - ESP_ERR_INVALID_ARG for any invalid arguments
- *      - ESP_ERR_NO_MEM out of memory when creating IR NEC encoder
+ *      - ESP_ERR_NO_MEM if the encoder pool is exhausted or the copy/bytes sub-encoders cannot be created
  *      - ESP_OK if creating encoder successfully
  */
 esp_err_t rmt_new_ir_nec_encoder(const ir_nec_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
 
 /**
  * @brief Get the copy encoder out of the NEC encoder
- * 
+ *
+ * Lets raw frames be sent with the same copy encoder instead of creating a second one. Safe as long as
+ * both encoders are only used on one TX channel, which encodes one transaction at a time.
+ *
  * @param encoder NEC encoder pointer
  * @param ret_cpy_enc Return copy encoder
  * @return esp_err_t Status code
@@ -7,143 +7,78 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "driver/rmt_tx.h"
 #include "driver/rmt_rx.h"
 #include "ir_nec_encoder.h"
+#include "ir_nec_timing.h"
+#include "ir_symbol_kernels.h"
+#include "ir_kernel_bench.h"
+#include "ir_decoder.h"
+#include "ir_screen.h"
+#include "os_crc32.h"
+#include "os_spsc.h"
+#include "ir_power.h"
+#include "mem_budget.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
 
 #include <string.h>
 #include <stdlib.h>
+#include <inttypes.h>
 
 #define EXAMPLE_IR_RESOLUTION_HZ     1000000 // 1MHz resolution, 1 tick = 1us
 #define EXAMPLE_IR_TX_GPIO_NUM       18
 #define EXAMPLE_IR_RX_GPIO_NUM       17
-#define EXAMPLE_IR_NEC_DECODE_MARGIN 300     // Tolerance for parsing RMT symbols into bit stream
 
-/**
- * @brief NEC timing spec
- */
-#define NEC_LEADING_CODE_DURATION_0  9000
-#define NEC_LEADING_CODE_DURATION_1  4500
-#define NEC_PAYLOAD_ZERO_DURATION_0  560
-#define NEC_PAYLOAD_ZERO_DURATION_1  560
-#define NEC_PAYLOAD_ONE_DURATION_0   560
-#define NEC_PAYLOAD_ONE_DURATION_1   1690
-#define NEC_REPEAT_CODE_DURATION_0   9000
-#define NEC_REPEAT_CODE_DURATION_1   2250
-
-static const char *TAG = "IR_main";
-
-/**
- * @brief Saving NEC decode results
- */
-static uint16_t s_nec_code_address;
-static uint16_t s_nec_code_command;
-
-/**
- * @brief Check whether a duration is within expected range
- */
-static inline bool nec_check_in_range(uint32_t signal_duration, uint32_t spec_duration)
-{
-    return (signal_duration < (spec_duration + EXAMPLE_IR_NEC_DECODE_MARGIN)) &&
-           (signal_duration > (spec_duration - EXAMPLE_IR_NEC_DECODE_MARGIN));
-}
+#define EXAMPLE_IR_KERNEL_BENCH      0       // Set to 1 to benchmark the symbol kernels at boot
+#define EXAMPLE_MEM_REPORT_TIMEOUTS  60      // Log the stack/heap report every N idle RX timeouts (~1 s each)
 
-/**
- * @brief Check whether a RMT symbol represents NEC logic zero
- */
-static bool nec_parse_logic0(rmt_symbol_word_t *rmt_nec_symbols)
-{
-    return nec_check_in_range(rmt_nec_symbols->duration0, NEC_PAYLOAD_ZERO_DURATION_0) &&
-           nec_check_in_range(rmt_nec_symbols->duration1, NEC_PAYLOAD_ZERO_DURATION_1);
-}
+#define EXAMPLE_IR_RX_CORE           OS_CORE_IR  // RMT RX interrupt, capture and decode; app_main stays on core 0
+#define EXAMPLE_IR_RX_TASK_PRIO      10          // above app_main, below the RMT driver's own work
+#define EXAMPLE_IR_RX_TASK_STACK     4096
+#define EXAMPLE_IR_RX_RING_DEPTH     4           // decoded frames in flight to app_main (power of two)
+#define EXAMPLE_IR_TX_LINGER_MS      250         // a channel stays enabled this long after its last use, for back-to-back sends
 
-/**
- * @brief Check whether a RMT symbol represents NEC logic one
- */
-static bool nec_parse_logic1(rmt_symbol_word_t *rmt_nec_symbols)
-{
-    return nec_check_in_range(rmt_nec_symbols->duration0, NEC_PAYLOAD_ONE_DURATION_0) &&
-           nec_check_in_range(rmt_nec_symbols->duration1, NEC_PAYLOAD_ONE_DURATION_1);
-}
+static const char *TAG = "IR_main";
 
 /**
- * @brief Decode RMT symbols into NEC address and command
+ * @brief Print the captured RMT symbols and the decode result
  */
-static bool nec_parse_frame(rmt_symbol_word_t *rmt_nec_symbols)
+static void example_parse_ir_frame(const rmt_symbol_word_t *rmt_symbols, size_t symbol_num,
+                                   const ir_decoder_t *decoder, const ir_scan_code_t *scan_code)
 {
-    rmt_symbol_word_t *cur = rmt_nec_symbols;
-    uint16_t address = 0;
-    uint16_t command = 0;
-    bool valid_leading_code = nec_check_in_range(cur->duration0, NEC_LEADING_CODE_DURATION_0) &&
-                              nec_check_in_range(cur->duration1, NEC_LEADING_CODE_DURATION_1);
-    if (!valid_leading_code) {
-        return false;
-    }
-    cur++;
-    for (int i = 0; i < 16; i++) {
-        if (nec_parse_logic1(cur)) {
-            address |= 1 << i;
-        } else if (nec_parse_logic0(cur)) {
-            address &= ~(1 << i);
-        } else {
-            return false;
-        }
-        cur++;
+    const char *label = decoder ? decoder->name : "IR";  // the protocol that decoded it, if any
+    printf("%s frame start---\r\n", label);
+    for (size_t i = 0; i < symbol_num; i++) {
+        printf("{%d:%d},{%d:%d}\r\n", rmt_symbols[i].level0, rmt_symbols[i].duration0,
+               rmt_symbols[i].level1, rmt_symbols[i].duration1);
     }
-    for (int i = 0; i < 16; i++) {
-        if (nec_parse_logic1(cur)) {
-            command |= 1 << i;
-        } else if (nec_parse_logic0(cur)) {
-            command &= ~(1 << i);
-        } else {
-            return false;
-        }
-        cur++;
+    printf("---%s frame end: ", label);
+    if (!decoder) {
+        printf("Unknown IR frame\r\n\r\n");
+        return;
     }
-    // save address and command
-    s_nec_code_address = address;
-    s_nec_code_command = command;
-    return true;
-}
-
-/**
- * @brief Check whether the RMT symbols represent NEC repeat code
- */
-static bool nec_parse_frame_repeat(rmt_symbol_word_t *rmt_nec_symbols)
-{
-    return nec_check_in_range(rmt_nec_symbols->duration0, NEC_REPEAT_CODE_DURATION_0) &&
-           nec_check_in_range(rmt_nec_symbols->duration1, NEC_REPEAT_CODE_DURATION_1);
+    printf("%s Address=%04" PRIX32 ", Command=%04" PRIX32 "%s\r\n\r\n", decoder->name,
+           scan_code->address, scan_code->command,
+           (scan_code->flags & IR_SCAN_FLAG_REPEAT) ? ", repeat" : "");
 }
 
 /**
- * @brief Decode RMT symbols into NEC scan code and print the result
+ * @brief Per-stage counters of the RX pipeline, each written by one task only
  */
-static void example_parse_nec_frame(rmt_symbol_word_t *rmt_nec_symbols, size_t symbol_num)
-{
-    printf("NEC frame start---\r\n");
-    for (size_t i = 0; i < symbol_num; i++) {
-        printf("{%d:%d},{%d:%d}\r\n", rmt_nec_symbols[i].level0, rmt_nec_symbols[i].duration0,
-               rmt_nec_symbols[i].level1, rmt_nec_symbols[i].duration1);
-    }
-    printf("---NEC frame end: ");
-    // decode RMT symbols
-    switch (symbol_num) {
-    case 34: // NEC normal frame
-        if (nec_parse_frame(rmt_nec_symbols)) {
-            printf("Address=%04X, Command=%04X\r\n\r\n", s_nec_code_address, s_nec_code_command);
-        }
-        break;
-    case 2: // NEC repeat frame
-        if (nec_parse_frame_repeat(rmt_nec_symbols)) {
-            printf("Address=%04X, Command=%04X, repeat\r\n\r\n", s_nec_code_address, s_nec_code_command);
-        }
-        break;
-    default:
-        printf("Unknown NEC frame\r\n\r\n");
-        break;
-    }
-}
+typedef struct {
+    uint64_t rx_busy_us;     // ir_rx task: screen, decode and hand-off (EXAMPLE_IR_RX_CORE)
+    uint64_t reject_busy_us; // ir_rx task: the part of rx_busy_us spent on captures the screen rejected
+    uint64_t app_busy_us;    // app_main: store, print, replay (core 0)
+    uint32_t frames;         // frames taken off the ring by app_main
+    uint32_t dropped;        // captured while the ring was full, noise not included
+    uint32_t queue_us_max;   // RX done -> picked up by app_main
+    uint64_t queue_us_sum;
+} ir_pipeline_stats_t;
+
+static ir_pipeline_stats_t s_pipe;
 
 static bool example_rmt_rx_done_callback(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *edata, void *user_data)
 {
@@ -160,80 +95,99 @@ typedef struct
 {
     rmt_symbol_word_t rmt_frame_data[MAX_FRAME_SIZE];
     size_t symbol_num;
+    ir_scan_code_t scan_code; // protocol != IR_PROTO_UNKNOWN when stored compactly instead of raw symbols
+    bool nec_symbols; // symbols snapped to the NEC classes, replayed behind the NEC leader; otherwise durations as captured
+    uint32_t crc32; // os_crc32 of the stored scan code or symbols, folded in while storing
 }rmt_frame_obj_t;
 
 rmt_frame_obj_t ir_cmd = {0};
 
+/**
+ * @brief One captured frame on its way from the ir_rx task to app_main
+ *
+ * rmt_receive() writes straight into the ring record, the RX task adds the decode result and publishes it.
+ */
+typedef struct {
+    rmt_symbol_word_t symbols[MAX_FRAME_SIZE];
+    size_t symbol_num;
+    const ir_decoder_t *decoder;  // NULL if no decoder matched
+    ir_scan_code_t scan_code;
+    int64_t captured_us;          // RX done, for the queue latency
+} ir_rx_frame_t;
+
+/**
+ * @brief Frame buffers and queue storage, sized at build time
+ *
+ * Kept out of task stacks and the heap: the RX buffer is written by the RMT driver and the TX frame is read
+ * while the transmission runs, so both must outlive the call that hands them over.
+ */
+typedef struct {
+    ir_rx_frame_t rx_frames[EXAMPLE_IR_RX_RING_DEPTH];  // os_spsc ring storage, rmt_receive() targets
+    rmt_symbol_word_t rx_overflow[MAX_FRAME_SIZE];      // rmt_receive() target while the ring is full
+    rmt_symbol_word_t normalized[MAX_FRAME_SIZE];       // save_rmt_cmd() scratch
+    rmt_frame_obj_t tx_frame;                           // raw replay, read by the copy encoder
+    ir_nec_scan_code_t tx_scan_code;                    // compact replay, read by the NEC encoder
+    os_spsc_t rx_ring;                                  // ir_rx task -> app_main, lock-free across cores
+    StaticQueue_t receive_queue;
+    uint8_t receive_queue_storage[sizeof(rmt_rx_done_event_data_t)];
+    StaticTask_t rx_task;
+    StackType_t rx_task_stack[EXAMPLE_IR_RX_TASK_STACK / sizeof(StackType_t)];
+    StaticSemaphore_t power_lock;                       // ir_power: app_main and the ir_rx task
+} ir_frame_arena_t;
+
+static ir_frame_arena_t s_ir_arena;
 
-static void invert_rmt_levels(const rmt_symbol_word_t *input, 
-                              rmt_symbol_word_t *output, 
-                              size_t symbol_num)
-{
-    for (size_t i = 0; i < symbol_num; i++) {
-        output[i].level0 = !input[i].level0;
-        output[i].level1 = !input[i].level1;
-        output[i].duration0 = input[i].duration0;
-        output[i].duration1 = input[i].duration1;
-    }
-}
+/**
+ * @brief RMT handles switched on and off by ir_power
+ */
+typedef struct {
+    rmt_channel_handle_t rx_channel;
+    rmt_channel_handle_t tx_channel;
+    rmt_encoder_handle_t nec_encoder;   // also owns the copy encoder used for raw frames
+    SemaphoreHandle_t power_lock;
+    esp_timer_handle_t linger_timer;    // ends the linger on time, app_main may sleep for seconds
+} ir_hw_t;
 
-static void normalize_rmt_durations(rmt_symbol_word_t *frame, size_t symbol_num)
-{
-    for (size_t i = 0; i < symbol_num; i++) {
-        uint32_t d0 = frame[i].duration0;
-        uint32_t d1 = frame[i].duration1;
-
-        // Try to match NEC known pulse durations first
-        if (abs((int)d0 - NEC_PAYLOAD_ZERO_DURATION_0) < 200 && abs((int)d1 - NEC_PAYLOAD_ZERO_DURATION_1) < 200) {
-            frame[i].duration0 = NEC_PAYLOAD_ZERO_DURATION_0;
-            frame[i].duration1 = NEC_PAYLOAD_ZERO_DURATION_1;
-        } else if (abs((int)d0 - NEC_PAYLOAD_ONE_DURATION_0) < 200 && abs((int)d1 - NEC_PAYLOAD_ONE_DURATION_1) < 300) {
-            frame[i].duration0 = NEC_PAYLOAD_ONE_DURATION_0;
-            frame[i].duration1 = NEC_PAYLOAD_ONE_DURATION_1;
-        } else if (abs((int)d0 - NEC_LEADING_CODE_DURATION_0) < 1000 && abs((int)d1 - NEC_LEADING_CODE_DURATION_1) < 1000) {
-            frame[i].duration0 = NEC_LEADING_CODE_DURATION_0;
-            frame[i].duration1 = NEC_LEADING_CODE_DURATION_1;
-        } else if (abs((int)d0 - NEC_REPEAT_CODE_DURATION_0) < 1000 && abs((int)d1 - NEC_REPEAT_CODE_DURATION_1) < 1000) {
-            frame[i].duration0 = NEC_REPEAT_CODE_DURATION_0;
-            frame[i].duration1 = NEC_REPEAT_CODE_DURATION_1;
-        } else {
-            // Fallback: crude k-means with 2 clusters (short, long) on the fly
-            static uint32_t short_avg = 560;
-            static uint32_t long_avg = 1690;
-
-            // Normalize duration0
-            if (abs((int)d0 - (int)short_avg) < abs((int)d0 - (int)long_avg)) {
-                frame[i].duration0 = short_avg;
-            } else {
-                frame[i].duration0 = long_avg;
-            }
+static ir_hw_t s_ir_hw;
+
+static const rmt_transmit_config_t s_transmit_config = {
+    .loop_count = 0, // no loop
+};
 
-            // Normalize duration1
-            if (abs((int)d1 - (int)short_avg) < abs((int)d1 - (int)long_avg)) {
-                frame[i].duration1 = short_avg;
-            } else {
-                frame[i].duration1 = long_avg;
-            }
-        }
-    }
-}
 
 static void normalize_rmt_frame(const rmt_symbol_word_t *input_frame, 
                                 rmt_symbol_word_t *output_frame,
                                 size_t symbol_num)
 {
-    invert_rmt_levels(input_frame, output_frame, symbol_num);
-    normalize_rmt_durations(output_frame, symbol_num);
+    ir_symbols_normalize_frame(input_frame, output_frame, symbol_num);
+}
+
+
+/**
+ * @brief Check whether a frame was decoded as NEC, the only protocol normalize_rmt_frame() and the replay leader fit
+ */
+static bool is_nec_frame(const ir_scan_code_t *scan_code)
+{
+    return scan_code && scan_code->protocol == IR_PROTO_NEC;
 }
 
+/**
+ * @brief Check whether a decoded frame can be stored as a scan code and re-encoded on replay
+ */
+static bool can_store_scan_code(const ir_scan_code_t *scan_code)
+{
+    return is_nec_frame(scan_code) && !(scan_code->flags & IR_SCAN_FLAG_REPEAT);
+}
 
 /**
  * @brief Store the rmt frame
  * 
  * @param rmt_nec_symbols 
  * @param symbol_num 
+ * @param scan_code Decoded scan code, stored instead of the symbols when it can be re-encoded (may be NULL);
+ *                  other NEC frames get the NEC leader on replay, the rest keep their captured durations
  */
-static void store_rmt_frame(rmt_symbol_word_t *rmt_nec_symbols, size_t symbol_num)
+static void store_rmt_frame(rmt_symbol_word_t *rmt_nec_symbols, size_t symbol_num, const ir_scan_code_t *scan_code)
 {
     //TODO: Remove the static counter when button is implemented
     static uint8_t cnt = 0;
@@ -242,6 +196,15 @@ static void store_rmt_frame(rmt_symbol_word_t *rmt_nec_symbols, size_t symbol_nu
         return;
     }
 
+    if (can_store_scan_code(scan_code))
+    {
+        ir_cmd.crc32 = os_crc32_copy(&ir_cmd.scan_code, scan_code, sizeof(*scan_code), OS_CRC32_INIT);
+        ir_cmd.symbol_num = 0;
+        ir_cmd.nec_symbols = false;
+        cnt++;
+        return;
+    }
+
     // TODO: Add concurrency safety in the form of a circular buffer
     if (symbol_num > MAX_FRAME_SIZE)
     {
@@ -250,24 +213,134 @@ static void store_rmt_frame(rmt_symbol_word_t *rmt_nec_symbols, size_t symbol_nu
     }
     
 
-    memcpy(ir_cmd.rmt_frame_data, rmt_nec_symbols, symbol_num * sizeof(rmt_symbol_word_t));
+    ir_cmd.crc32 = os_crc32_copy(ir_cmd.rmt_frame_data, rmt_nec_symbols, symbol_num * sizeof(rmt_symbol_word_t), OS_CRC32_INIT);
     ir_cmd.symbol_num = symbol_num;
+    ir_cmd.nec_symbols = is_nec_frame(scan_code);
 
 
     cnt++;
 }
 
-static void save_rmt_cmd(rmt_symbol_word_t *raw_symbols, size_t symbol_num)
+static void save_rmt_cmd(rmt_symbol_word_t *raw_symbols, size_t symbol_num, const ir_scan_code_t *scan_code)
+{
+    if (can_store_scan_code(scan_code)) {
+        store_rmt_frame(NULL, 0, scan_code);
+        return;
+    }
+    if (symbol_num > MAX_FRAME_SIZE) {
+        ESP_LOGE(TAG, "Failure to store frame, symbol num (%d) > MAX_FRAME_SIZE (%d)", symbol_num, MAX_FRAME_SIZE);
+        return;
+    }
+    if (!is_nec_frame(scan_code)) {
+        // other protocols and unknown remotes do not fit the NEC duration classes: only flip the levels for TX
+        ir_symbols_invert(raw_symbols, s_ir_arena.normalized, symbol_num);
+        store_rmt_frame(s_ir_arena.normalized, symbol_num, scan_code);
+        return;
+    }
+    normalize_rmt_frame(raw_symbols, s_ir_arena.normalized, symbol_num);
+    store_rmt_frame(s_ir_arena.normalized, symbol_num, scan_code);
+}
+
+static os_err_t example_ir_power_enable(ir_power_ch_t ch, void *ctx)
+{
+    ir_hw_t *hw = (ir_hw_t *)ctx;
+    if (ch == IR_PWR_RX) {
+        return rmt_enable(hw->rx_channel) == ESP_OK ? OS_OK : OS_EFAIL;
+    }
+    // a disabled channel may have stopped mid-frame: start encoding from a clean state
+    if (rmt_enable(hw->tx_channel) != ESP_OK || rmt_encoder_reset(hw->nec_encoder) != ESP_OK) {
+        return OS_EFAIL;
+    }
+    return OS_OK;
+}
+
+static os_err_t example_ir_power_disable(ir_power_ch_t ch, void *ctx)
 {
-    rmt_symbol_word_t normalized[MAX_FRAME_SIZE] = {0};
-    normalize_rmt_frame(raw_symbols, normalized, symbol_num);
-    store_rmt_frame(normalized, symbol_num);
+    ir_hw_t *hw = (ir_hw_t *)ctx;
+    return rmt_disable(ch == IR_PWR_RX ? hw->rx_channel : hw->tx_channel) == ESP_OK ? OS_OK : OS_EFAIL;
 }
 
+static uint64_t example_ir_power_now_us(void *ctx)
+{
+    (void)ctx;
+    return (uint64_t)esp_timer_get_time();
+}
 
-void app_main(void)
+static void example_ir_power_lock(void *ctx)
+{
+    xSemaphoreTake(((ir_hw_t *)ctx)->power_lock, portMAX_DELAY);
+}
+
+static void example_ir_power_unlock(void *ctx)
+{
+    xSemaphoreGive(((ir_hw_t *)ctx)->power_lock);
+}
+
+/**
+ * @brief Call ir_power_tick() once the linger of a just released channel is over
+ */
+static void example_ir_linger_arm(void)
+{
+    // already running when another task armed it first: its callback re-arms while a channel lingers
+    (void)esp_timer_stop(s_ir_hw.linger_timer);
+    (void)esp_timer_start_once(s_ir_hw.linger_timer, (uint64_t)EXAMPLE_IR_TX_LINGER_MS * 1000 + 1000);
+}
+
+static void example_ir_linger_timeout(void *arg)
+{
+    (void)arg;
+    // no schedules in this example: a deadline back means a channel is still lingering
+    if (ir_power_tick(0) != SCHED_NO_DEADLINE) {
+        example_ir_linger_arm();
+    }
+}
+
+/**
+ * @brief Send one frame with the TX channel enabled only around it
+ *
+ * Returns once the frame is out, so the payload may be reused and the channel can be switched off.
+ */
+static esp_err_t example_ir_send(rmt_encoder_handle_t encoder, const void *payload, size_t payload_bytes)
+{
+    if (ir_power_acquire(IR_PWR_TX) != OS_OK) {
+        return ESP_FAIL;
+    }
+    esp_err_t err = rmt_transmit(s_ir_hw.tx_channel, encoder, payload, payload_bytes, &s_transmit_config);
+    if (err == ESP_OK) {
+        ir_power_mark_edge(IR_PWR_TX);
+        err = rmt_tx_wait_all_done(s_ir_hw.tx_channel, -1);
+    }
+    ir_power_release(IR_PWR_TX);
+    example_ir_linger_arm();
+    return err;
+}
+
+/**
+ * @brief Arm the next capture: straight into the free ring record, or the overflow buffer while app_main is behind
+ *
+ * @return The claimed ring record, NULL if this capture will be dropped
+ */
+static ir_rx_frame_t *ir_rx_arm(rmt_channel_handle_t rx_channel, const rmt_receive_config_t *receive_config)
 {
-    ESP_LOGI(TAG, "create RMT RX channel");
+    ir_rx_frame_t *frame = os_spsc_claim(&s_ir_arena.rx_ring);
+    void *target = frame ? (void *)frame->symbols : (void *)s_ir_arena.rx_overflow;
+    ESP_ERROR_CHECK(rmt_receive(rx_channel, target, sizeof(s_ir_arena.rx_overflow), receive_config));
+    return frame;
+}
+
+/**
+ * @brief Capture and decode on EXAMPLE_IR_RX_CORE, decoded frames go to app_main over the ring
+ *
+ * The RX channel is created here so that its interrupt is allocated on this core as well. It stays enabled
+ * (one IR_PWR_RX hold), since nothing in this example starts or stops a learning session.
+ *
+ * @param arg app_main task handle, notified for every published frame
+ */
+static void ir_rx_task(void *arg)
+{
+    TaskHandle_t app_task = (TaskHandle_t)arg;
+
+    ESP_LOGI(TAG, "create RMT RX channel on core %d", xPortGetCoreID());
     rmt_rx_channel_config_t rx_channel_cfg = {
         .clk_src = RMT_CLK_SRC_DEFAULT,
         .resolution_hz = EXAMPLE_IR_RESOLUTION_HZ,
@@ -276,9 +349,11 @@ void app_main(void)
     };
     rmt_channel_handle_t rx_channel = NULL;
     ESP_ERROR_CHECK(rmt_new_rx_channel(&rx_channel_cfg, &rx_channel));
+    s_ir_hw.rx_channel = rx_channel;
 
     ESP_LOGI(TAG, "register RX done callback");
-    QueueHandle_t receive_queue = xQueueCreate(1, sizeof(rmt_rx_done_event_data_t));
+    QueueHandle_t receive_queue = xQueueCreateStatic(1, sizeof(rmt_rx_done_event_data_t),
+                                                     s_ir_arena.receive_queue_storage, &s_ir_arena.receive_queue);
     assert(receive_queue);
     rmt_rx_event_callbacks_t cbs = {
         .on_recv_done = example_rmt_rx_done_callback,
@@ -290,6 +365,148 @@ void app_main(void)
         .signal_range_min_ns = 1250,     // the shortest duration for NEC signal is 560us, 1250ns < 560us, valid signal won't be treated as noise
         .signal_range_max_ns = 12000000, // the longest duration for NEC signal is 9000us, 12000000ns > 9000us, the receive won't stop early
     };
+    rmt_rx_done_event_data_t rx_data;
+    // no learn/stop trigger in this example: RX is held for good and re-armed after every capture
+    ESP_ERROR_CHECK(ir_power_acquire(IR_PWR_RX) == OS_OK ? ESP_OK : ESP_FAIL);
+    // ready to receive (MAX_FRAME_SIZE = 64 symbols is sufficient for a standard NEC frame)
+    ir_rx_frame_t *frame = ir_rx_arm(rx_channel, &receive_config);
+    ir_power_mark_edge(IR_PWR_RX);
+    xTaskNotifyGive(app_task);
+    while (1) {
+        // wait for RX done signal
+        xQueueReceive(receive_queue, &rx_data, portMAX_DELAY);
+        int64_t t0 = esp_timer_get_time();
+        if (ir_screen_frame(rx_data.received_symbols, rx_data.num_symbols) != IR_SCREEN_PASS) {
+            // noise: not published, so the next capture reuses the record and app_main is not woken
+            frame = ir_rx_arm(rx_channel, &receive_config);
+            int64_t busy_us = esp_timer_get_time() - t0;
+            s_pipe.rx_busy_us += busy_us;
+            s_pipe.reject_busy_us += busy_us;
+            continue;
+        }
+        if (frame) {
+            // decode in place and publish; app_main stores and prints it on the other core
+            frame->symbol_num = rx_data.num_symbols;
+            frame->decoder = ir_decoder_decode(frame->symbols, frame->symbol_num, &frame->scan_code);
+            frame->captured_us = t0;
+            os_spsc_publish(&s_ir_arena.rx_ring);
+            xTaskNotifyGive(app_task);
+        } else {
+            s_pipe.dropped++;
+        }
+        // start receive again
+        frame = ir_rx_arm(rx_channel, &receive_config);
+        s_pipe.rx_busy_us += esp_timer_get_time() - t0;
+    }
+}
+
+/**
+ * @brief Log the share of each core spent in its pipeline stage since the last report, and the ring state
+ */
+static void example_log_pipeline(int64_t *since_us)
+{
+    static uint64_t last_rx_busy_us, last_app_busy_us;
+    int64_t now = esp_timer_get_time();
+    uint64_t window_us = (uint64_t)(now - *since_us);
+    uint64_t rx_busy_us = s_pipe.rx_busy_us;
+    uint64_t app_busy_us = s_pipe.app_busy_us;
+    os_spsc_stats_t ring;
+    os_spsc_get_stats(&s_ir_arena.rx_ring, &ring);
+
+    printf("PIPE core%d ir_rx %" PRIu32 ".%02" PRIu32 "%% core%d app %" PRIu32 ".%02" PRIu32 "%% "
+           "frames=%" PRIu32 " dropped=%" PRIu32 " ring_hwm=%" PRIu32 "/%d queue_us mean=%" PRIu32 " max=%" PRIu32 "\r\n",
+           (int)EXAMPLE_IR_RX_CORE,
+           (uint32_t)((rx_busy_us - last_rx_busy_us) * 100 / window_us),
+           (uint32_t)((rx_busy_us - last_rx_busy_us) * 10000 / window_us % 100),
+           xPortGetCoreID(),
+           (uint32_t)((app_busy_us - last_app_busy_us) * 100 / window_us),
+           (uint32_t)((app_busy_us - last_app_busy_us) * 10000 / window_us % 100),
+           s_pipe.frames, s_pipe.dropped, ring.high_water, EXAMPLE_IR_RX_RING_DEPTH,
+           s_pipe.frames ? (uint32_t)(s_pipe.queue_us_sum / s_pipe.frames) : 0, s_pipe.queue_us_max);
+
+    last_rx_busy_us = rx_busy_us;
+    last_app_busy_us = app_busy_us;
+    *since_us = now;
+}
+
+/**
+ * @brief Log what the noise screen kept away from the ring, and what a rejected capture costs against a kept one
+ */
+static void example_log_screen(void)
+{
+    ir_screen_stats_t st;
+    ir_screen_get_stats(&st);
+    uint32_t passed = st.verdicts[IR_SCREEN_PASS];
+    uint32_t rejected = st.frames - passed;
+    // a kept frame costs its decode and hand-off on the RX core, plus store and print on app_main
+    uint32_t pass_us = (passed ? (uint32_t)((s_pipe.rx_busy_us - s_pipe.reject_busy_us) / passed) : 0) +
+                       (s_pipe.frames ? (uint32_t)(s_pipe.app_busy_us / s_pipe.frames) : 0);
+    printf("SCREEN pass=%" PRIu32 " reject=%" PRIu32 " (short=%" PRIu32 " leader=%" PRIu32 " glitch=%" PRIu32
+           " spread=%" PRIu32 ") symbols=%" PRIu64 " us mean reject=%" PRIu32 " pass=%" PRIu32 "\r\n",
+           passed, rejected, st.verdicts[IR_SCREEN_SHORT], st.verdicts[IR_SCREEN_LEADER],
+           st.verdicts[IR_SCREEN_GLITCH], st.verdicts[IR_SCREEN_SPREAD], st.rejected_symbols,
+           rejected ? (uint32_t)(s_pipe.reject_busy_us / rejected) : 0, pass_us);
+}
+
+/**
+ * @brief Log how long each RMT channel was enabled and how long a send waited for its first edge
+ */
+static void example_log_power(void)
+{
+    ir_power_stats_t st;
+    ir_power_get_stats(&st);
+    const ir_power_ch_stats_t *tx = &st.ch[IR_PWR_TX];
+    const ir_power_ch_stats_t *rx = &st.ch[IR_PWR_RX];
+    uint64_t up_us = st.up_us ? st.up_us : 1;
+    printf("POWER tx on %" PRIu32 ".%02" PRIu32 "%% rx on %" PRIu32 "%% tx enables=%" PRIu32 " (%" PRIu32 " us max) "
+           "edge cold=%" PRIu32 " mean=%" PRIu32 " max=%" PRIu32 " us warm=%" PRIu32 " mean=%" PRIu32 " max=%" PRIu32 " us\r\n",
+           (uint32_t)(tx->on_us * 100 / up_us), (uint32_t)(tx->on_us * 10000 / up_us % 100),
+           (uint32_t)(rx->on_us * 100 / up_us), tx->enables, tx->enable_us_max,
+           tx->cold_edges, tx->cold_edges ? (uint32_t)(tx->cold_edge_us_sum / tx->cold_edges) : 0, tx->cold_edge_us_max,
+           tx->warm_edges, tx->warm_edges ? (uint32_t)(tx->warm_edge_us_sum / tx->warm_edges) : 0, tx->warm_edge_us_max);
+}
+
+
+void app_main(void)
+{
+#if EXAMPLE_IR_KERNEL_BENCH
+    ir_kernel_bench_run();
+#endif
+
+    ESP_ERROR_CHECK(ir_decoder_register_defaults());
+
+    // the RMT channels are enabled only while a frame is sent or a receive is armed
+    s_ir_hw.power_lock = xSemaphoreCreateMutexStatic(&s_ir_arena.power_lock);
+    assert(s_ir_hw.power_lock);
+    const ir_power_config_t power_cfg = {
+        .hw = {
+            .enable = example_ir_power_enable,
+            .disable = example_ir_power_disable,
+            .now_us = example_ir_power_now_us,
+            .lock = example_ir_power_lock,
+            .unlock = example_ir_power_unlock,
+            .ctx = &s_ir_hw,
+        },
+        .linger_ms = EXAMPLE_IR_TX_LINGER_MS,
+    };
+    ESP_ERROR_CHECK(ir_power_init(&power_cfg) == OS_OK ? ESP_OK : ESP_FAIL);
+    const esp_timer_create_args_t linger_timer_args = {
+        .callback = example_ir_linger_timeout,
+        .name = "ir_linger",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&linger_timer_args, &s_ir_hw.linger_timer));
+
+    ESP_LOGI(TAG, "start IR RX task on core %d", EXAMPLE_IR_RX_CORE);
+    ESP_ERROR_CHECK(os_spsc_init(&s_ir_arena.rx_ring, s_ir_arena.rx_frames, sizeof(ir_rx_frame_t),
+                                 EXAMPLE_IR_RX_RING_DEPTH) == OS_OK ? ESP_OK : ESP_ERR_INVALID_ARG);
+    TaskHandle_t rx_task = xTaskCreateStaticPinnedToCore(ir_rx_task, "ir_rx", EXAMPLE_IR_RX_TASK_STACK,
+                                                         xTaskGetCurrentTaskHandle(), EXAMPLE_IR_RX_TASK_PRIO,
+                                                         s_ir_arena.rx_task_stack, &s_ir_arena.rx_task,
+                                                         EXAMPLE_IR_RX_CORE);
+    assert(rx_task);
+    ESP_ERROR_CHECK(mem_budget_track_task("ir_rx", EXAMPLE_IR_RX_TASK_STACK) == OS_OK ? ESP_OK : ESP_FAIL);
+    // wait until the first receive is armed, so the frame sent below can be captured
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
     ESP_LOGI(TAG, "create RMT TX channel");
     rmt_tx_channel_config_t tx_channel_cfg = {
@@ -310,11 +527,6 @@ void app_main(void)
     };
     ESP_ERROR_CHECK(rmt_apply_carrier(tx_channel, &carrier_cfg));
 
-    // this example won't send NEC frames in a loop
-    rmt_transmit_config_t transmit_config = {
-        .loop_count = 0, // no loop
-    };
-
     ESP_LOGI(TAG, "install IR NEC encoder");
     ir_nec_encoder_config_t nec_encoder_cfg = {
         .resolution = EXAMPLE_IR_RESOLUTION_HZ,
@@ -322,65 +534,106 @@ void app_main(void)
     rmt_encoder_handle_t nec_encoder = NULL;
     ESP_ERROR_CHECK(rmt_new_ir_nec_encoder(&nec_encoder_cfg, &nec_encoder));
 
-    rmt_encoder_handle_t copy_encoder;
-    rmt_copy_encoder_config_t copy_enc_config = {};
-    ESP_ERROR_CHECK(rmt_new_copy_encoder(&copy_enc_config, &copy_encoder));
+    // raw frames reuse the NEC encoder's copy encoder (same TX channel, one transaction at a time)
+    rmt_encoder_handle_t copy_encoder = NULL;
+    ESP_ERROR_CHECK(rmt_get_copy_enc(nec_encoder, &copy_encoder));
 
-
-    ESP_LOGI(TAG, "enable RMT TX and RX channels");
-    ESP_ERROR_CHECK(rmt_enable(tx_channel));
-    ESP_ERROR_CHECK(rmt_enable(rx_channel));
-
-    // save the received RMT symbols
-    rmt_symbol_word_t raw_symbols[64]; // 64 symbols should be sufficient for a standard NEC frame
-    rmt_rx_done_event_data_t rx_data;
-    // ready to receive
-    ESP_ERROR_CHECK(rmt_receive(rx_channel, raw_symbols, sizeof(raw_symbols), &receive_config));
+    // the TX channel is enabled by ir_power for each send
+    s_ir_hw.tx_channel = tx_channel;
+    s_ir_hw.nec_encoder = nec_encoder;
 
     const ir_nec_scan_code_t scan_code = {
             .address = 0xFE01,
             .command = 0x748B,
     };
-    ESP_ERROR_CHECK(rmt_transmit(tx_channel, nec_encoder, &scan_code, sizeof(scan_code), &transmit_config));
+    ESP_ERROR_CHECK(example_ir_send(nec_encoder, &scan_code, sizeof(scan_code)));
+
+    ESP_ERROR_CHECK(mem_budget_track_task("main", CONFIG_ESP_MAIN_TASK_STACK_SIZE) == OS_OK ? ESP_OK : ESP_FAIL);
+    mem_budget_log_report();
+    uint32_t idle_timeouts = 0;
+    int64_t report_since_us = esp_timer_get_time();
     while (1) {
-        // wait for RX done signal
-        if (xQueueReceive(receive_queue, &rx_data, pdMS_TO_TICKS(1000)) == pdPASS) {
-            // parse the receive symbols and print the result
-            save_rmt_cmd(rx_data.received_symbols, rx_data.num_symbols);
-            example_parse_nec_frame(rx_data.received_symbols, rx_data.num_symbols);
-            // start receive again
-            ESP_ERROR_CHECK(rmt_receive(rx_channel, raw_symbols, sizeof(raw_symbols), &receive_config));
-        } else {
+        // wait for the RX task to hand over decoded frames
+        uint32_t woken = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+        ir_rx_frame_t *frame = os_spsc_peek(&s_ir_arena.rx_ring);
+        if (frame) {
+            do {
+                // store the frame and print the result, then hand the record back to the RX task
+                int64_t t0 = esp_timer_get_time();
+                uint32_t queue_us = (uint32_t)(t0 - frame->captured_us);
+                s_pipe.frames++;
+                s_pipe.queue_us_sum += queue_us;
+                if (queue_us > s_pipe.queue_us_max) {
+                    s_pipe.queue_us_max = queue_us;
+                }
+                save_rmt_cmd(frame->symbols, frame->symbol_num, frame->decoder ? &frame->scan_code : NULL);
+                example_parse_ir_frame(frame->symbols, frame->symbol_num, frame->decoder, &frame->scan_code);
+                os_spsc_release(&s_ir_arena.rx_ring);
+                s_pipe.app_busy_us += esp_timer_get_time() - t0;
+            } while ((frame = os_spsc_peek(&s_ir_arena.rx_ring)) != NULL);
+        } else if (!woken) {
+            if (++idle_timeouts % EXAMPLE_MEM_REPORT_TIMEOUTS == 0) {
+                mem_budget_log_report();
+                example_log_pipeline(&report_since_us);
+                example_log_screen();
+                example_log_power();
+            }
             //timeout, transmit predefined IR NEC packets
             // const ir_nec_scan_code_t scan_code = {
             //     .address = 0xFE01,
             //     .command = 0x748B,
             // };
-            // ESP_ERROR_CHECK(rmt_transmit(tx_channel, nec_encoder, &scan_code, sizeof(scan_code), &transmit_config));
+            // ESP_ERROR_CHECK(example_ir_send(nec_encoder, &scan_code, sizeof(scan_code)));
             // continue;
 
-            if (ir_cmd.symbol_num == 0)
+            if (ir_cmd.scan_code.protocol == IR_PROTO_NEC)
             {
+                if (os_crc32_update(OS_CRC32_INIT, &ir_cmd.scan_code, sizeof(ir_cmd.scan_code)) != ir_cmd.crc32)
+                {
+                    ESP_LOGE(TAG, "Stored scan code failed CRC check, not replaying");
+                    continue;
+                }
+                ir_nec_scan_code_t *nec_code = &s_ir_arena.tx_scan_code;
+                nec_code->address = (uint16_t)ir_cmd.scan_code.address;
+                nec_code->command = (uint16_t)ir_cmd.scan_code.command;
+                ESP_LOGI(TAG, "Replaying stored NEC scan code %04X:%04X", nec_code->address, nec_code->command);
+                esp_err_t tx_err = example_ir_send(nec_encoder, nec_code, sizeof(*nec_code));
+                if (tx_err != ESP_OK)
+                {
+                    ESP_LOGE(TAG,"TX Failed with %d", tx_err);
+                }
                 continue;
             }
 
-            /* Buffer data */
-            rmt_frame_obj_t cmd;
-            memcpy(&cmd.rmt_frame_data, ir_cmd.rmt_frame_data, ir_cmd.symbol_num * sizeof(rmt_symbol_word_t));
-            cmd.symbol_num = ir_cmd.symbol_num;
+            if (ir_cmd.symbol_num == 0)
+            {
+                continue;
+            }
 
-            /* Replace the first element with the configured leading pulse */
-            cmd.rmt_frame_data[0] = (rmt_symbol_word_t) {
-                .level0 = 1,
-                .duration0 = 9000ULL * EXAMPLE_IR_RESOLUTION_HZ / 1000000,
-                .level1 = 0,
-                .duration1 = 4500ULL * EXAMPLE_IR_RESOLUTION_HZ / 1000000,
-            };
+            /* Buffer data, verifying the stored frame in the same pass */
+            rmt_frame_obj_t *cmd = &s_ir_arena.tx_frame;
+            uint32_t crc = os_crc32_copy(cmd->rmt_frame_data, ir_cmd.rmt_frame_data, ir_cmd.symbol_num * sizeof(rmt_symbol_word_t), OS_CRC32_INIT);
+            if (crc != ir_cmd.crc32)
+            {
+                ESP_LOGE(TAG, "Stored frame failed CRC check (%08" PRIx32 " != %08" PRIx32 "), not replaying", crc, ir_cmd.crc32);
+                continue;
+            }
+            cmd->symbol_num = ir_cmd.symbol_num;
+
+            /* Replace the first element of a NEC frame with the configured leading pulse */
+            if (ir_cmd.nec_symbols) {
+                cmd->rmt_frame_data[0] = (rmt_symbol_word_t) {
+                    .level0 = 1,
+                    .duration0 = 9000ULL * EXAMPLE_IR_RESOLUTION_HZ / 1000000,
+                    .level1 = 0,
+                    .duration1 = 4500ULL * EXAMPLE_IR_RESOLUTION_HZ / 1000000,
+                };
+            }
 
-            ESP_LOGI(TAG, "Replaying stored NEC frame with %d symbols", cmd.symbol_num);
+            ESP_LOGI(TAG, "Replaying stored %s frame with %d symbols", ir_cmd.nec_symbols ? "NEC" : "raw", cmd->symbol_num);
 
-            /* rmt_transmit is blocking */
-            esp_err_t tx_err = rmt_transmit(tx_channel, copy_encoder, cmd.rmt_frame_data, cmd.symbol_num * sizeof(rmt_symbol_word_t), &transmit_config);
+            /* example_ir_send returns once the frame is out, so the arena frame is free again */
+            esp_err_t tx_err = example_ir_send(copy_encoder, cmd->rmt_frame_data, cmd->symbol_num * sizeof(rmt_symbol_word_t));
             if (tx_err != ESP_OK)
             {
                 ESP_LOGE(TAG,"TX Failed with %d", tx_err);
@@ -0,0 +1,73 @@
+#include <string.h>
+#include "ir_decoder.h"
+#include "ir_screen.h"
+
+static ir_screen_stats_t s_screen_stats;
+
+/**
+ * @brief Duration histogram of the payload: glitches, in-band units and overlong gaps
+ *
+ * The leader (first symbol) and the trailing space (0 or the idle cut) are not payload. The outlier
+ * budget is known up front, so noise is usually rejected a few symbols in.
+ */
+static ir_screen_verdict_t ir_screen_histogram(const rmt_symbol_word_t *symbols, size_t symbol_num)
+{
+    uint32_t budget = symbol_num > 1 ? (uint32_t)(2 * symbol_num - 3) / IR_SCREEN_OUTLIER_DIV : 0;
+    uint32_t glitches = 0;
+    uint32_t overlong = 0;
+    for (size_t i = 1; i < symbol_num; i++) {
+        uint32_t mark = symbols[i].duration0;
+        uint32_t space = (i + 1 < symbol_num) ? symbols[i].duration1 : IR_SCREEN_GLITCH_US;
+        glitches += (mark < IR_SCREEN_GLITCH_US) + (space < IR_SCREEN_GLITCH_US);
+        overlong += (mark > IR_SCREEN_UNIT_MAX_US) + (space > IR_SCREEN_UNIT_MAX_US);
+        if (glitches > budget) {
+            return IR_SCREEN_GLITCH;
+        }
+        if (overlong > budget) {
+            return IR_SCREEN_SPREAD;
+        }
+    }
+    return IR_SCREEN_PASS;
+}
+
+ir_screen_verdict_t ir_screen_frame(const rmt_symbol_word_t *symbols, size_t symbol_num)
+{
+    ir_screen_verdict_t verdict;
+    if (!symbols || symbol_num < IR_SCREEN_MIN_SYMBOLS) {
+        verdict = IR_SCREEN_SHORT;
+    } else if (!ir_decoder_plausible(symbols, symbol_num)) {
+        verdict = IR_SCREEN_LEADER;
+    } else {
+        verdict = ir_screen_histogram(symbols, symbol_num);
+    }
+    s_screen_stats.frames++;
+    s_screen_stats.verdicts[verdict]++;
+    if (verdict != IR_SCREEN_PASS) {
+        s_screen_stats.rejected_symbols += symbol_num;
+    }
+    return verdict;
+}
+
+void ir_screen_get_stats(ir_screen_stats_t *stats)
+{
+    if (stats) {
+        *stats = s_screen_stats;
+    }
+}
+
+void ir_screen_reset_stats(void)
+{
+    memset(&s_screen_stats, 0, sizeof(s_screen_stats));
+}
+
+const char *ir_screen_verdict_name(ir_screen_verdict_t verdict)
+{
+    static const char *const names[IR_SCREEN_VERDICT_MAX] = {
+        [IR_SCREEN_PASS] = "pass",
+        [IR_SCREEN_SHORT] = "short",
+        [IR_SCREEN_LEADER] = "leader",
+        [IR_SCREEN_GLITCH] = "glitch",
+        [IR_SCREEN_SPREAD] = "spread",
+    };
+    return (verdict < IR_SCREEN_VERDICT_MAX) ? names[verdict] : "?";
+}
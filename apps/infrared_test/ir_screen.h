@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hal/rmt_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Shortest frame worth decoding, in symbols (NEC repeat: leader plus stop bit)
+ */
+#ifndef IR_SCREEN_MIN_SYMBOLS
+#define IR_SCREEN_MIN_SYMBOLS   2
+#endif
+
+/**
+ * @brief Payload durations below this are glitches, in us
+ *
+ * The shortest protocol unit is the RC6 half bit (444us), still above this with IR_DECODE_MARGIN of jitter.
+ */
+#ifndef IR_SCREEN_GLITCH_US
+#define IR_SCREEN_GLITCH_US     120
+#endif
+
+/**
+ * @brief Payload durations above this are longer than any protocol unit, in us
+ *
+ * The longest unit is the NEC logic 1 space (1690us); leaders and the trailing gap are not payload.
+ */
+#ifndef IR_SCREEN_UNIT_MAX_US
+#define IR_SCREEN_UNIT_MAX_US   4000
+#endif
+
+/**
+ * @brief A frame is noise once more than 1/IR_SCREEN_OUTLIER_DIV of its payload durations are glitches or overlong
+ */
+#ifndef IR_SCREEN_OUTLIER_DIV
+#define IR_SCREEN_OUTLIER_DIV   8
+#endif
+
+/**
+ * @brief Screen verdicts, IR_SCREEN_PASS or the first check the capture failed
+ */
+typedef enum {
+    IR_SCREEN_PASS = 0,
+    IR_SCREEN_SHORT,    /*!< Fewer than IR_SCREEN_MIN_SYMBOLS symbols */
+    IR_SCREEN_LEADER,   /*!< No registered protocol has this leader at this symbol count */
+    IR_SCREEN_GLITCH,   /*!< Too many payload durations below IR_SCREEN_GLITCH_US */
+    IR_SCREEN_SPREAD,   /*!< Too many payload durations above IR_SCREEN_UNIT_MAX_US */
+    IR_SCREEN_VERDICT_MAX,
+} ir_screen_verdict_t;
+
+/**
+ * @brief Screen counters
+ */
+typedef struct {
+    uint32_t frames;                           /*!< Captures passed to ir_screen_frame() */
+    uint32_t verdicts[IR_SCREEN_VERDICT_MAX];  /*!< Per verdict, verdicts[IR_SCREEN_PASS] are the accepted frames */
+    uint64_t rejected_symbols;                 /*!< Symbols of rejected captures, never decoded, normalized or stored */
+} ir_screen_stats_t;
+
+/**
+ * @brief Cheap plausibility check of a raw capture, ahead of decode, normalization and storage
+ *
+ * One pass over the durations, no decoder is invoked. Only rejects what cannot be an IR frame:
+ * the leader and count check uses the registered decoders, so unknown remotes that fit the
+ * pulse distance fallback still pass.
+ *
+ * @param[in] symbols Raw RX symbols, levels are ignored
+ * @param[in] symbol_num Number of symbols
+ * @return IR_SCREEN_PASS, or why the capture is noise
+ */
+ir_screen_verdict_t ir_screen_frame(const rmt_symbol_word_t *symbols, size_t symbol_num);
+
+/**
+ * @brief Get a copy of the screen counters
+ */
+void ir_screen_get_stats(ir_screen_stats_t *stats);
+
+/**
+ * @brief Clear the screen counters
+ */
+void ir_screen_reset_stats(void);
+
+/**
+ * @brief Printable verdict name
+ */
+const char *ir_screen_verdict_name(ir_screen_verdict_t verdict);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,166 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include "ir_nec_timing.h"
+#include "ir_symbol_kernels.h"
+
+/**
+ * @brief Packed acceptance window for a (duration0, duration1) pair
+ *
+ * |d - spec| < tol is rewritten as spec - tol < d < spec + tol, so both durations of a
+ * symbol are range-checked with two 32-bit subtractions instead of four abs() calls.
+ */
+typedef struct {
+    uint32_t lo;   // packed inclusive lower bounds
+    uint32_t hi;   // packed inclusive upper bounds
+    uint32_t snap; // packed durations written on match
+} ir_snap_window_t;
+
+#define IR_SNAP_WINDOW(spec0, tol0, spec1, tol1) {                       \
+    .lo   = IR_SYMBOL_PACK((spec0) - (tol0) + 1, (spec1) - (tol1) + 1),  \
+    .hi   = IR_SYMBOL_PACK((spec0) + (tol0) - 1, (spec1) + (tol1) - 1),  \
+    .snap = IR_SYMBOL_PACK((spec0), (spec1)),                            \
+}
+
+/**
+ * @brief Snap tolerances, in us (exclusive), overridable at build time for tools/ir_fuzz
+ */
+#ifndef IR_NORMALIZE_TOL_PAYLOAD
+#define IR_NORMALIZE_TOL_PAYLOAD    200  // payload marks and zero spaces
+#endif
+#ifndef IR_NORMALIZE_TOL_ONE_SPACE
+#define IR_NORMALIZE_TOL_ONE_SPACE  300  // 1690us space of a one bit
+#endif
+#ifndef IR_NORMALIZE_TOL_LEADER
+#define IR_NORMALIZE_TOL_LEADER     1000 // leading and repeat codes
+#endif
+
+/**
+ * @brief Reject tolerance overrides that would carry or borrow across the packed lanes of a window
+ */
+#define IR_SNAP_LANE_CHECK(spec, tol)                                                          \
+    _Static_assert((tol) < (spec), #tol " must be below " #spec ": the window lower bound underflows");  \
+    _Static_assert((spec) + (tol) < 0x8000, #spec " + " #tol " must fit the 15-bit duration lane")
+
+IR_SNAP_LANE_CHECK(NEC_PAYLOAD_ZERO_DURATION_0, IR_NORMALIZE_TOL_PAYLOAD);
+IR_SNAP_LANE_CHECK(NEC_PAYLOAD_ZERO_DURATION_1, IR_NORMALIZE_TOL_PAYLOAD);
+IR_SNAP_LANE_CHECK(NEC_PAYLOAD_ONE_DURATION_0, IR_NORMALIZE_TOL_PAYLOAD);
+IR_SNAP_LANE_CHECK(NEC_PAYLOAD_ONE_DURATION_1, IR_NORMALIZE_TOL_ONE_SPACE);
+IR_SNAP_LANE_CHECK(NEC_LEADING_CODE_DURATION_0, IR_NORMALIZE_TOL_LEADER);
+IR_SNAP_LANE_CHECK(NEC_LEADING_CODE_DURATION_1, IR_NORMALIZE_TOL_LEADER);
+IR_SNAP_LANE_CHECK(NEC_REPEAT_CODE_DURATION_0, IR_NORMALIZE_TOL_LEADER);
+IR_SNAP_LANE_CHECK(NEC_REPEAT_CODE_DURATION_1, IR_NORMALIZE_TOL_LEADER);
+
+// Same order and tolerances as the original per-field comparisons
+static const ir_snap_window_t s_nec_windows[] = {
+    IR_SNAP_WINDOW(NEC_PAYLOAD_ZERO_DURATION_0, IR_NORMALIZE_TOL_PAYLOAD, NEC_PAYLOAD_ZERO_DURATION_1, IR_NORMALIZE_TOL_PAYLOAD),
+    IR_SNAP_WINDOW(NEC_PAYLOAD_ONE_DURATION_0,  IR_NORMALIZE_TOL_PAYLOAD, NEC_PAYLOAD_ONE_DURATION_1,  IR_NORMALIZE_TOL_ONE_SPACE),
+    IR_SNAP_WINDOW(NEC_LEADING_CODE_DURATION_0, IR_NORMALIZE_TOL_LEADER,  NEC_LEADING_CODE_DURATION_1, IR_NORMALIZE_TOL_LEADER),
+    IR_SNAP_WINDOW(NEC_REPEAT_CODE_DURATION_0,  IR_NORMALIZE_TOL_LEADER,  NEC_REPEAT_CODE_DURATION_1,  IR_NORMALIZE_TOL_LEADER),
+};
+
+/**
+ * @brief Fallback short/long classes, a duration snaps to whichever is closer
+ */
+#define IR_CLASS_SHORT      560
+#define IR_CLASS_LONG       1690
+#define IR_CLASS_THRESHOLD  ((IR_CLASS_SHORT + IR_CLASS_LONG + 1) / 2) // ties go to long
+
+/**
+ * @brief Check both durations of a level-stripped symbol against a window
+ *
+ * Setting bit 15 of each lane before subtracting keeps borrows from crossing lanes,
+ * bit 15 of each lane in the result then holds the per-lane comparison.
+ */
+static inline bool ir_window_match(uint32_t durations, const ir_snap_window_t *win)
+{
+    uint32_t ge_lo = (durations | IR_SYMBOL_LEVEL_MASK) - win->lo;
+    uint32_t le_hi = (win->hi | IR_SYMBOL_LEVEL_MASK) - durations;
+    return (ge_lo & le_hi & IR_SYMBOL_LEVEL_MASK) == IR_SYMBOL_LEVEL_MASK;
+}
+
+/**
+ * @brief Snap each duration lane to the short or long class without branching
+ */
+static inline uint32_t ir_snap_classes(uint32_t durations)
+{
+    const uint32_t short_packed = IR_SYMBOL_PACK(IR_CLASS_SHORT, IR_CLASS_SHORT);
+    const uint32_t long_packed = IR_SYMBOL_PACK(IR_CLASS_LONG, IR_CLASS_LONG);
+    uint32_t ge = ((durations | IR_SYMBOL_LEVEL_MASK) - IR_SYMBOL_PACK(IR_CLASS_THRESHOLD, IR_CLASS_THRESHOLD))
+                  & IR_SYMBOL_LEVEL_MASK;
+    uint32_t lane_mask = (ge >> 15) * 0x7FFFu;
+    return short_packed ^ ((short_packed ^ long_packed) & lane_mask);
+}
+
+static inline uint32_t ir_snap_word(uint32_t word)
+{
+    uint32_t durations = word & IR_SYMBOL_DURATION_MASK;
+    uint32_t levels = word & IR_SYMBOL_LEVEL_MASK;
+    for (size_t w = 0; w < sizeof(s_nec_windows) / sizeof(s_nec_windows[0]); w++) {
+        if (ir_window_match(durations, &s_nec_windows[w])) {
+            return levels | s_nec_windows[w].snap;
+        }
+    }
+    return levels | ir_snap_classes(durations);
+}
+
+void ir_symbols_invert(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num)
+{
+    for (size_t i = 0; i < symbol_num; i++) {
+        output[i].val = input[i].val ^ IR_SYMBOL_LEVEL_MASK;
+    }
+}
+
+void ir_symbols_normalize(rmt_symbol_word_t *frame, size_t symbol_num)
+{
+    for (size_t i = 0; i < symbol_num; i++) {
+        frame[i].val = ir_snap_word(frame[i].val);
+    }
+}
+
+void ir_symbols_normalize_frame(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num)
+{
+    for (size_t i = 0; i < symbol_num; i++) {
+        output[i].val = ir_snap_word(input[i].val ^ IR_SYMBOL_LEVEL_MASK);
+    }
+}
+
+void ir_symbols_invert_ref(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num)
+{
+    for (size_t i = 0; i < symbol_num; i++) {
+        output[i].level0 = !input[i].level0;
+        output[i].level1 = !input[i].level1;
+        output[i].duration0 = input[i].duration0;
+        output[i].duration1 = input[i].duration1;
+    }
+}
+
+void ir_symbols_normalize_ref(rmt_symbol_word_t *frame, size_t symbol_num)
+{
+    for (size_t i = 0; i < symbol_num; i++) {
+        uint32_t d0 = frame[i].duration0;
+        uint32_t d1 = frame[i].duration1;
+
+        // Try to match NEC known pulse durations first
+        if (abs((int)d0 - NEC_PAYLOAD_ZERO_DURATION_0) < IR_NORMALIZE_TOL_PAYLOAD &&
+            abs((int)d1 - NEC_PAYLOAD_ZERO_DURATION_1) < IR_NORMALIZE_TOL_PAYLOAD) {
+            frame[i].duration0 = NEC_PAYLOAD_ZERO_DURATION_0;
+            frame[i].duration1 = NEC_PAYLOAD_ZERO_DURATION_1;
+        } else if (abs((int)d0 - NEC_PAYLOAD_ONE_DURATION_0) < IR_NORMALIZE_TOL_PAYLOAD &&
+                   abs((int)d1 - NEC_PAYLOAD_ONE_DURATION_1) < IR_NORMALIZE_TOL_ONE_SPACE) {
+            frame[i].duration0 = NEC_PAYLOAD_ONE_DURATION_0;
+            frame[i].duration1 = NEC_PAYLOAD_ONE_DURATION_1;
+        } else if (abs((int)d0 - NEC_LEADING_CODE_DURATION_0) < IR_NORMALIZE_TOL_LEADER &&
+                   abs((int)d1 - NEC_LEADING_CODE_DURATION_1) < IR_NORMALIZE_TOL_LEADER) {
+            frame[i].duration0 = NEC_LEADING_CODE_DURATION_0;
+            frame[i].duration1 = NEC_LEADING_CODE_DURATION_1;
+        } else if (abs((int)d0 - NEC_REPEAT_CODE_DURATION_0) < IR_NORMALIZE_TOL_LEADER &&
+                   abs((int)d1 - NEC_REPEAT_CODE_DURATION_1) < IR_NORMALIZE_TOL_LEADER) {
+            frame[i].duration0 = NEC_REPEAT_CODE_DURATION_0;
+            frame[i].duration1 = NEC_REPEAT_CODE_DURATION_1;
+        } else {
+            // Fallback: nearest of the short/long classes
+            frame[i].duration0 = (abs((int)d0 - IR_CLASS_SHORT) < abs((int)d0 - IR_CLASS_LONG)) ? IR_CLASS_SHORT : IR_CLASS_LONG;
+            frame[i].duration1 = (abs((int)d1 - IR_CLASS_SHORT) < abs((int)d1 - IR_CLASS_LONG)) ? IR_CLASS_SHORT : IR_CLASS_LONG;
+        }
+    }
+}
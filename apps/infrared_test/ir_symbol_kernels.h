@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hal/rmt_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Bit masks over the raw 32-bit view (rmt_symbol_word_t.val) of a symbol
+ *
+ * Layout: [15:0] = duration0(15) | level0(1), [31:16] = duration1(15) | level1(1)
+ */
+#define IR_SYMBOL_LEVEL_MASK     0x80008000u
+#define IR_SYMBOL_DURATION_MASK  0x7FFF7FFFu
+
+/**
+ * @brief Pack two durations into the raw symbol layout (levels cleared)
+ */
+#define IR_SYMBOL_PACK(d0, d1)   ((uint32_t)(d0) | ((uint32_t)(d1) << 16))
+
+/**
+ * @brief Flip level0 and level1 of every symbol, durations are copied untouched
+ *
+ * @note input and output may alias
+ */
+void ir_symbols_invert(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num);
+
+/**
+ * @brief Snap captured durations to the nearest known NEC timing, in place
+ *
+ * Symbols matching a NEC zero/one/leading/repeat pair are replaced by the spec pair,
+ * anything else has each duration snapped to the short (560us) or long (1690us) class.
+ * Levels are preserved.
+ */
+void ir_symbols_normalize(rmt_symbol_word_t *frame, size_t symbol_num);
+
+/**
+ * @brief Invert levels and normalize durations in a single pass
+ */
+void ir_symbols_normalize_frame(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num);
+
+/**
+ * @brief Field-by-field reference kernels, kept for benchmarking and equivalence checks
+ */
+void ir_symbols_invert_ref(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num);
+void ir_symbols_normalize_ref(rmt_symbol_word_t *frame, size_t symbol_num);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,6 +1,7 @@
-/* mocks.c — Sprint 0 wiring mocks (no real HW, no real bus)
+/* mocks.c — Sprint 0 wiring mocks (no real HW)
  *
- * Goal: let app_main/orchestrator skeleton compile + run, and emit fake events.
+ * Goal: let app_main/orchestrator skeleton compile + run, and emit fake events
+ * through the real event bus.
  */
 
 #include <string.h>
@@ -9,6 +10,18 @@
 #include "freertos/task.h"
 
 #include "retrofit_os_types.h"   /* EVT_* / payload structs / os_evt_t */
+#include "scheduler.h"
+#include "orchestrator.h"
+#include "evt_bus_core.h"
+#include "evt_bus_port_freertos.h"
+#include "evt_journal.h"
+#include "mem_budget.h"
+#include "storage_cache.h"
+#include "slot_prefetch.h"
+#include "ir_power.h"
+#include "os_crc32.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
 #include "mocks.h"
 
 static const char *TAG = "MOCKS";
@@ -27,34 +40,126 @@ static mock_ble_t   g_ble;
 static mock_wifi_t  g_wifi;
 static mock_power_t g_pwr;
 
+/* Simulated init latency of the real modules, only with MOCK_SIMULATE_INIT_COST */
+#define MOCK_WIFI_INIT_MS    300u
+#define MOCK_BLE_INIT_MS     200u
+#define MOCK_STORAGE_INIT_MS 150u
+#define MOCK_IR_INIT_MS       50u
+
+static void mock_simulate_init_cost(uint32_t ms)
+{
+#if MOCK_SIMULATE_INIT_COST
+  vTaskDelay(pdMS_TO_TICKS(ms));
+#else
+  (void)ms;
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+/* Publish through the real event bus (dispatcher task delivers to subscribers) */
 /* -------------------------------------------------------------------------- */
-/* Fake “event bus deliver” for Sprint 0.
- * Replace with real event_bus_publish() later.
- * For now we just log the event and (optionally) call orchestrator hook.
- * -------------------------------------------------------------------------- */
+
+#define MOCK_EVT_BUS_TASK_PRIO     5u
+#define MOCK_EVT_BUS_TASK_STACK    4096u
+#define MOCK_EVT_BUS_HEALTH_MS     10000u
+#define MOCK_EVT_BUS_CB_BUDGET_US  1000u
+#define MOCK_EVT_BUS_CORE          OS_CORE_APP  /* next to the comms stacks; IR keeps the other core */
+
+/* Journal of every dispatched event; dumped once as hex lines for evt_replay:
+ *   grep -o 'EVJ [0-9a-f]*' log.txt | cut -c5- | xxd -r -p > dump.evj */
+#define MOCK_EVT_JOURNAL_BYTES     4096u
+#define MOCK_EVT_JOURNAL_DUMP_STEP 300u
+#define MOCK_EVT_JOURNAL_LINE      32u
+
+/* Longest sleep of the main loop, in steps: picks up deadlines that moved
+ * while it slept (table edits and cache writes from other tasks) */
+#define MOCK_STEP_MAX_SLEEP        60u
+
+static uint8_t           g_evt_journal_buf[MOCK_EVT_JOURNAL_BYTES];
+static SemaphoreHandle_t g_evt_journal_lock;
+static StaticSemaphore_t g_evt_journal_lock_buf;
 
 static void mock_publish(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len)
 {
-  os_evt_t evt = {
-    .id = id,
-    .src = src,
-    .ts_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS),
-    .len = len,
-  };
-
-  if (len > OS_EVT_INLINE_MAX) {
-    ESP_LOGE(TAG, "publish drop: len=%u > OS_EVT_INLINE_MAX=%u", (unsigned)len, (unsigned)OS_EVT_INLINE_MAX);
+  os_err_t err = evt_bus_publish(src, id, payload, len);
+  if (err != OS_OK) {
+    ESP_LOGE(TAG, "publish drop: id=%u len=%u err=%d", (unsigned)id, (unsigned)len, (int)err);
     return;
   }
-  if (payload && len){
-    memcpy(evt.payload, payload, len);
+  ESP_LOGI(TAG, "EVT id=%u src=%u len=%u", (unsigned)id, (unsigned)src, (unsigned)len);
+}
+
+static void mock_health_cb(const os_evt_t *evt, void *user_ctx)
+{
+  (void)user_ctx;
+  if (evt->id == EVT_WATCHDOG_WARNING) {
+    evt_watchdog_warning_t w;
+    memcpy(&w, evt->payload, sizeof(w));
+    ESP_LOGW(TAG, "slow callback: module=%u evt=%u took %u us (budget %u us)",
+             (unsigned)w.module, (unsigned)w.evt_id, (unsigned)w.elapsed_us, (unsigned)w.budget_us);
+    return;
   }
+  evt_health_tick_t t;
+  memcpy(&t, evt->payload, sizeof(t));
+  ESP_LOGI(TAG, "bus health: dispatched=%u dropped=%u q_hwm=%u q=%u lat_max=%u us slowest=%u (%u us)",
+           (unsigned)t.dispatched, (unsigned)t.dropped, (unsigned)t.q_high_water, (unsigned)t.q_depth,
+           (unsigned)t.lat_max_us, (unsigned)t.slow_module, (unsigned)t.slow_cb_us);
+
+  evt_journal_stats_t js;
+  evt_journal_get_stats(&js);
+  ESP_LOGI(TAG, "evt journal: %u events, %u kept in %u bytes, %u dropped, %u.%02u bytes/event",
+           (unsigned)js.records, (unsigned)js.kept, (unsigned)js.bytes_used, (unsigned)js.dropped,
+           js.records ? (unsigned)(js.bytes_total / js.records) : 0u,
+           js.records ? (unsigned)((js.bytes_total * 100u / js.records) % 100u) : 0u);
+
+  slot_prefetch_stats_t ps;
+  slot_prefetch_get_stats(&ps);
+  ESP_LOGI(TAG, "slot prefetch: hits=%u misses=%u invalidated=%u wasted=%u crc_err=%u saved=%u us miss_max=%u us",
+           (unsigned)ps.hits, (unsigned)ps.misses, (unsigned)ps.invalidated, (unsigned)ps.wasted,
+           (unsigned)ps.crc_errors, (unsigned)ps.saved_us_sum, (unsigned)ps.miss_us_max);
+
+  ir_power_stats_t irs;
+  ir_power_get_stats(&irs);
+  const ir_power_ch_stats_t *tx = &irs.ch[IR_PWR_TX];
+  ESP_LOGI(TAG, "ir power: tx on %u ms / rx on %u ms of %u ms, tx enables=%u cold=%u prewarm hit=%u wasted=%u "
+           "edge cold_max=%u us warm_max=%u us",
+           (unsigned)(tx->on_us / 1000u), (unsigned)(irs.ch[IR_PWR_RX].on_us / 1000u), (unsigned)(irs.up_us / 1000u),
+           (unsigned)tx->enables, (unsigned)tx->cold, (unsigned)irs.prewarm_hits, (unsigned)irs.prewarm_wasted,
+           (unsigned)tx->cold_edge_us_max, (unsigned)tx->warm_edge_us_max);
 
-  ESP_LOGI(TAG, "EVT id=%u src=%u len=%u", (unsigned)evt.id, (unsigned)evt.src, (unsigned)evt.len);
+  mem_budget_log_report();
+}
+
+static void mock_evt_journal_lock(void *ctx)
+{
+  (void)ctx;
+  xSemaphoreTake(g_evt_journal_lock, portMAX_DELAY);
+}
 
-  /* TODO Sprint 0: if you have an orchestrator_process(evt) stub, call it here:
-   * mock_orch_process(&evt);
-   */
+static void mock_evt_journal_unlock(void *ctx)
+{
+  (void)ctx;
+  xSemaphoreGive(g_evt_journal_lock);
+}
+
+static os_err_t mock_evt_journal_write_hex(const void *data, uint32_t len, void *ctx)
+{
+  (void)ctx;
+  static const char hex[] = "0123456789abcdef";
+  const uint8_t *p = (const uint8_t *)data;
+  char line[MOCK_EVT_JOURNAL_LINE * 2u + 1u];
+  while (len) {
+    uint32_t n = (len < MOCK_EVT_JOURNAL_LINE) ? len : MOCK_EVT_JOURNAL_LINE;
+    for (uint32_t i = 0; i < n; i++) {
+      line[2u * i] = hex[p[i] >> 4];
+      line[2u * i + 1u] = hex[p[i] & 0xFu];
+    }
+    line[2u * n] = '\0';
+    ESP_LOGI(TAG, "EVJ %s", line);
+    p += n;
+    len -= n;
+  }
+  return OS_OK;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -71,6 +176,7 @@ os_err_t mock_auth_init(void)
 os_err_t mock_ble_init(void)
 {
   memset(&g_ble, 0, sizeof(g_ble));
+  mock_simulate_init_cost(MOCK_BLE_INIT_MS);
   ESP_LOGI(TAG, "mock_ble_init");
   return OS_OK;
 }
@@ -78,6 +184,7 @@ os_err_t mock_ble_init(void)
 os_err_t mock_wifi_init(void)
 {
   memset(&g_wifi, 0, sizeof(g_wifi));
+  mock_simulate_init_cost(MOCK_WIFI_INIT_MS);
   ESP_LOGI(TAG, "mock_wifi_init");
   return OS_OK;
 }
@@ -89,25 +196,477 @@ os_err_t mock_power_init(void)
   return OS_OK;
 }
 
-os_err_t mock_ir_init(void)      { ESP_LOGI(TAG, "mock_ir_init"); return OS_OK; }
-os_err_t mock_sched_init(void)   { ESP_LOGI(TAG, "mock_sched_init"); return OS_OK; }
-os_err_t mock_storage_init(void) { ESP_LOGI(TAG, "mock_storage_init"); return OS_OK; }
+/* Scheduler: real engine, mock clock (one step = one second) and mock persistence */
+#define MOCK_SCHED_DEMO_ID     42u
+#define MOCK_SCHED_DEMO_PERIOD 11u
+#define MOCK_SCHED_DEMO_SLOT   1u
+
+static SemaphoreHandle_t g_sched_lock;
+static StaticSemaphore_t g_sched_lock_buf;
+
+/* sched_process() runs on the main task, slot_prefetch/ir_power read the table from the bus dispatcher */
+static void mock_sched_lock(void *ctx)
+{
+  (void)ctx;
+  xSemaphoreTake(g_sched_lock, portMAX_DELAY);
+}
+
+static void mock_sched_unlock(void *ctx)
+{
+  (void)ctx;
+  xSemaphoreGive(g_sched_lock);
+}
+
+static void mock_sched_due(const sched_entry_t *entry, uint32_t deadline, void *user_ctx)
+{
+  (void)deadline;
+  (void)user_ctx;
+  evt_schedule_due_t p = { .schedule_id = entry->id };
+  mock_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, &p, sizeof(p));
+}
+
+/* last_run goes through the write-back cache; the journal keeps it durable */
+static os_err_t mock_sched_persist(const sched_entry_t *entry, void *user_ctx)
+{
+  (void)user_ctx;
+  ESP_LOGI(TAG, "persist schedule id=%u last_run=%u", (unsigned)entry->id, (unsigned)entry->last_run);
+  return scache_put(SCACHE_KEY(SCACHE_NS_SCHED, entry->id), &entry->last_run, sizeof(entry->last_run),
+                    SCACHE_F_JOURNAL);
+}
+
+os_err_t mock_sched_init(void)
+{
+  g_sched_lock = xSemaphoreCreateMutexStatic(&g_sched_lock_buf);
+  if (!g_sched_lock) {
+    return OS_ENOMEM;
+  }
+  const sched_config_t cfg = {
+    .on_due = mock_sched_due,
+    .persist_last_run = mock_sched_persist,
+    .lock = mock_sched_lock,
+    .unlock = mock_sched_unlock,
+  };
+  os_err_t err = sched_init(&cfg);
+  if (err != OS_OK) {
+    return err;
+  }
+  sched_entry_t demo = {
+    .id = MOCK_SCHED_DEMO_ID,
+    .first_run = MOCK_SCHED_DEMO_PERIOD,
+    .period_s = MOCK_SCHED_DEMO_PERIOD,
+    .slot = MOCK_SCHED_DEMO_SLOT,
+  };
+  uint16_t len = 0;
+  (void)scache_get(SCACHE_KEY(SCACHE_NS_SCHED, demo.id), &demo.last_run, sizeof(demo.last_run), &len);
+  ESP_LOGI(TAG, "mock_sched_init (last_run=%u)", (unsigned)demo.last_run);
+  return sched_add(&demo);
+}
+
+/* IR: slots in RAM, rendered ahead of their schedule by slot_prefetch; the
+ * due handler claims the frame where the real service calls rmt_transmit().
+ * ir_power gates the (mock) RMT channels and pre-warms TX for the next due. */
+#define MOCK_IR_SLOTS        4u
+#define MOCK_IR_SLOT_SYMBOLS 34u         /* NEC frame: leader, 32 bits, stop */
+/* rmt_symbol_word_t: duration0 bits 0-14, level0 bit 15, duration1 bits 16-30, level1 bit 31 */
+#define MOCK_IR_SYMBOL(l0, d0, l1, d1) \
+  ((uint32_t)(d0) | ((uint32_t)(l0) << 15) | ((uint32_t)(d1) << 16) | ((uint32_t)(l1) << 31))
+#define MOCK_IR_LEADER       MOCK_IR_SYMBOL(1u, 9000u, 0u, 4500u)  /* NEC leader at 1 MHz */
+
+typedef struct {
+  uint32_t symbols[MOCK_IR_SLOT_SYMBOLS];
+  uint32_t crc32;
+} mock_ir_slot_t;
+
+static mock_ir_slot_t    g_ir_slots[MOCK_IR_SLOTS];
+static SemaphoreHandle_t g_ir_lock;
+static StaticSemaphore_t g_ir_lock_buf;
+
+static os_err_t mock_ir_load(uint16_t slot, void *buf, uint16_t cap, uint16_t *len, uint32_t *crc32, void *ctx)
+{
+  (void)ctx;
+  if (slot >= MOCK_IR_SLOTS || cap < sizeof(g_ir_slots[slot].symbols)) {
+    return OS_EINVAL;
+  }
+  memcpy(buf, g_ir_slots[slot].symbols, sizeof(g_ir_slots[slot].symbols));
+  *len = sizeof(g_ir_slots[slot].symbols);
+  *crc32 = g_ir_slots[slot].crc32;
+  return OS_OK;
+}
+
+static os_err_t mock_ir_render(uint16_t slot, const void *data, uint16_t len,
+                               uint32_t *symbols, uint16_t cap, uint16_t *num, void *ctx)
+{
+  (void)slot;
+  (void)ctx;
+  uint16_t n = (uint16_t)(len / sizeof(uint32_t));
+  if (n == 0u || n > cap) {
+    return OS_EINVAL;
+  }
+  memcpy(symbols, data, (size_t)n * sizeof(uint32_t));
+  symbols[0] = MOCK_IR_LEADER;
+  *num = n;
+  return OS_OK;
+}
+
+static void mock_ir_lock(void *ctx)
+{
+  (void)ctx;
+  xSemaphoreTake(g_ir_lock, portMAX_DELAY);
+}
+
+static void mock_ir_unlock(void *ctx)
+{
+  (void)ctx;
+  xSemaphoreGive(g_ir_lock);
+}
+
+static uint32_t mock_ir_now_us(void *ctx)
+{
+  (void)ctx;
+  return (uint32_t)esp_timer_get_time();
+}
+
+static os_err_t mock_ir_enable(ir_power_ch_t ch, void *ctx)
+{
+  (void)ctx;
+  ESP_LOGD(TAG, "ir %s channel on", ch == IR_PWR_TX ? "tx" : "rx");
+  return OS_OK;
+}
+
+static os_err_t mock_ir_disable(ir_power_ch_t ch, void *ctx)
+{
+  (void)ctx;
+  ESP_LOGD(TAG, "ir %s channel off", ch == IR_PWR_TX ? "tx" : "rx");
+  return OS_OK;
+}
+
+static uint64_t mock_ir_power_now_us(void *ctx)
+{
+  (void)ctx;
+  return (uint64_t)esp_timer_get_time();
+}
+
+static void mock_ir_on_evt(const os_evt_t *evt, void *user_ctx)
+{
+  (void)user_ctx;
+  if (evt->id != EVT_SCHEDULE_DUE) {
+    (void)slot_prefetch_process(evt);
+    (void)ir_power_process(evt);
+    return;
+  }
+  evt_schedule_due_t due;
+  memcpy(&due, evt->payload, sizeof(due));
+  const uint32_t *symbols = NULL;
+  uint16_t num = 0;
+  uint32_t t0 = (uint32_t)esp_timer_get_time();
+  os_err_t err = slot_prefetch_acquire(due.schedule_id, &symbols, &num);
+  uint32_t dt = (uint32_t)esp_timer_get_time() - t0;
+  if (err != OS_OK) {
+    ESP_LOGE(TAG, "schedule %u: no frame (err=%d)", (unsigned)due.schedule_id, (int)err);
+    return;
+  }
+  ESP_LOGI(TAG, "schedule %u: %u symbols TX-ready in %u us", (unsigned)due.schedule_id, (unsigned)num,
+           (unsigned)dt);
+  if (ir_power_acquire(IR_PWR_TX) == OS_OK) {
+    ir_power_mark_edge(IR_PWR_TX);  /* rmt_transmit() would start here */
+    ir_power_release(IR_PWR_TX);
+  }
+  slot_prefetch_release();
+}
+
+os_err_t mock_ir_init(void)
+{
+  mock_simulate_init_cost(MOCK_IR_INIT_MS);
+  for (uint16_t i = 0; i < MOCK_IR_SLOTS; i++) {
+    for (uint16_t k = 0; k < MOCK_IR_SLOT_SYMBOLS; k++) {
+      g_ir_slots[i].symbols[k] = 0x02308230u + i + k;  /* placeholder bits */
+    }
+    g_ir_slots[i].crc32 = os_crc32_update(OS_CRC32_INIT, g_ir_slots[i].symbols, sizeof(g_ir_slots[i].symbols));
+  }
+  g_ir_lock = xSemaphoreCreateMutexStatic(&g_ir_lock_buf);
+  if (!g_ir_lock) {
+    return OS_ENOMEM;
+  }
+  const slot_prefetch_config_t cfg = {
+    .source = {
+      .load = mock_ir_load,
+      .render = mock_ir_render,
+      .lock = mock_ir_lock,
+      .unlock = mock_ir_unlock,
+      .now_us = mock_ir_now_us,
+    },
+  };
+  os_err_t err = slot_prefetch_init(&cfg);
+  if (err != OS_OK) {
+    return err;
+  }
+  const ir_power_config_t pcfg = {
+    .hw = {
+      .enable = mock_ir_enable,
+      .disable = mock_ir_disable,
+      .now_us = mock_ir_power_now_us,
+      .lock = mock_ir_lock,
+      .unlock = mock_ir_unlock,
+    },
+  };
+  err = ir_power_init(&pcfg);
+  if (err != OS_OK) {
+    return err;
+  }
+  ir_power_set_orch(orch_get_state(), orch_get_caps());
+  static const os_evt_id_t evts[] = {
+    EVT_SCHEDULE_DUE, EVT_SCHEDULE_TABLE_UPDATED, EVT_IR_SLOT_WRITTEN, EVT_TIME_JUMPED, EVT_FACTORY_RESET_DONE,
+    EVT_POWER_MODE_CHANGED,
+  };
+  for (size_t i = 0; i < sizeof(evts) / sizeof(evts[0]); i++) {
+    if (evt_bus_subscribe(evts[i], OS_MOD_IR, mock_ir_on_evt, NULL) == EVT_BUS_HANDLE_INVALID) {
+      return OS_EFULL;
+    }
+  }
+  ESP_LOGI(TAG, "mock_ir_init");
+  return OS_OK;
+}
+
+/* Storage: write-back cache over a RAM "flash" that logs every write */
+#define MOCK_FLASH_RECORDS     16u
+#define MOCK_JOURNAL_RECORDS   8u
+#define MOCK_CACHE_FLUSH_S     30u  /* demo: steps are seconds */
+
+typedef struct {
+  scache_key_t key;
+  uint16_t     len;
+  uint8_t      used;
+  uint8_t      value[SCACHE_MAX_VALUE];
+} mock_flash_rec_t;
+
+static mock_flash_rec_t     g_flash[MOCK_FLASH_RECORDS];
+static scache_journal_rec_t g_journal[MOCK_JOURNAL_RECORDS];
+static uint16_t             g_journal_len;
+static SemaphoreHandle_t    g_storage_lock;
+static StaticSemaphore_t    g_storage_lock_buf;
+
+static os_err_t mock_flash_read(scache_key_t key, void *buf, uint16_t cap, uint16_t *len, void *ctx)
+{
+  (void)ctx;
+  for (uint16_t i = 0; i < MOCK_FLASH_RECORDS; i++) {
+    if (g_flash[i].used && g_flash[i].key == key) {
+      if (g_flash[i].len > cap) {
+        return OS_EINVAL;
+      }
+      memcpy(buf, g_flash[i].value, g_flash[i].len);
+      *len = g_flash[i].len;
+      return OS_OK;
+    }
+  }
+  return OS_EINVAL;
+}
+
+static os_err_t mock_flash_write(scache_key_t key, const void *buf, uint16_t len, void *ctx)
+{
+  (void)ctx;
+  mock_flash_rec_t *free_rec = NULL;
+  for (uint16_t i = 0; i < MOCK_FLASH_RECORDS; i++) {
+    if (g_flash[i].used && g_flash[i].key == key) {
+      free_rec = &g_flash[i];
+      break;
+    }
+    if (!g_flash[i].used && !free_rec) {
+      free_rec = &g_flash[i];
+    }
+  }
+  if (!free_rec) {
+    return OS_EFULL;
+  }
+  free_rec->used = 1u;
+  free_rec->key = key;
+  free_rec->len = len;
+  memcpy(free_rec->value, buf, len);
+  ESP_LOGI(TAG, "flash write key=0x%08x len=%u", (unsigned)key, (unsigned)len);
+  return OS_OK;
+}
+
+static os_err_t mock_flash_commit(void *ctx)
+{
+  (void)ctx;
+  ESP_LOGI(TAG, "flash commit");
+  return OS_OK;
+}
+
+static os_err_t mock_journal_append(const scache_journal_rec_t *rec, void *ctx)
+{
+  (void)ctx;
+  if (g_journal_len >= MOCK_JOURNAL_RECORDS) {
+    return OS_EFULL;
+  }
+  g_journal[g_journal_len++] = *rec;
+  return OS_OK;
+}
+
+static os_err_t mock_journal_replay(scache_replay_cb_t cb, void *cb_ctx, void *ctx)
+{
+  (void)ctx;
+  for (uint16_t i = 0; i < g_journal_len; i++) {
+    cb(&g_journal[i], cb_ctx);
+  }
+  return OS_OK;
+}
+
+static os_err_t mock_journal_reset(void *ctx)
+{
+  (void)ctx;
+  g_journal_len = 0u;
+  return OS_OK;
+}
+
+static void mock_storage_lock(void *ctx)
+{
+  (void)ctx;
+  xSemaphoreTake(g_storage_lock, portMAX_DELAY);
+}
+
+static void mock_storage_unlock(void *ctx)
+{
+  (void)ctx;
+  xSemaphoreGive(g_storage_lock);
+}
+
+static uint32_t mock_storage_now_us(void *ctx)
+{
+  (void)ctx;
+  return (uint32_t)esp_timer_get_time();
+}
+
+static void mock_storage_on_evt(const os_evt_t *evt, void *user_ctx)
+{
+  (void)user_ctx;
+  (void)scache_process(evt);
+}
+
+os_err_t mock_storage_init(void)
+{
+  mock_simulate_init_cost(MOCK_STORAGE_INIT_MS);
+  g_storage_lock = xSemaphoreCreateMutexStatic(&g_storage_lock_buf);
+  if (!g_storage_lock) {
+    return OS_ENOMEM;
+  }
+  const scache_config_t cfg = {
+    .backend = {
+      .read = mock_flash_read,
+      .write = mock_flash_write,
+      .commit = mock_flash_commit,
+      .journal_append = mock_journal_append,
+      .journal_replay = mock_journal_replay,
+      .journal_reset = mock_journal_reset,
+      .lock = mock_storage_lock,
+      .unlock = mock_storage_unlock,
+      .now_us = mock_storage_now_us,
+    },
+    .flush_interval_s = MOCK_CACHE_FLUSH_S,
+  };
+  os_err_t err = scache_init(&cfg);
+  if (err != OS_OK) {
+    return err;
+  }
+  /* Flush before sleep and OTA, drop the cache on factory reset */
+  evt_bus_subscribe(EVT_POWER_MODE_CHANGED, OS_MOD_STORAGE, mock_storage_on_evt, NULL);
+  evt_bus_subscribe(EVT_OTA_START, OS_MOD_STORAGE, mock_storage_on_evt, NULL);
+  evt_bus_subscribe(EVT_FACTORY_RESET_DONE, OS_MOD_STORAGE, mock_storage_on_evt, NULL);
+  ESP_LOGI(TAG, "mock_storage_init");
+  return OS_OK;
+}
+
 os_err_t mock_clock_init(void)   { ESP_LOGI(TAG, "mock_clock_init"); return OS_OK; }
 os_err_t mock_cmd_init(void)     { ESP_LOGI(TAG, "mock_cmd_init"); return OS_OK; }
-os_err_t mock_orch_init(void)    { ESP_LOGI(TAG, "mock_orch_init"); return OS_OK; }
+static void mock_orch_state_changed(orch_state_t from, orch_state_t to, void *user_ctx)
+{
+  (void)user_ctx;
+  ESP_LOGI(TAG, "orch %s -> %s", orch_state_name(from), orch_state_name(to));
+  ir_power_set_orch(to, orch_get_caps());
+}
+
+/* Bus gate: events the current state lacks the capability for never reach subscribers */
+static bool mock_orch_gate(const os_evt_t *evt, void *gate_ctx)
+{
+  (void)gate_ctx;
+  return orch_process(evt) != OS_EPERM;
+}
+
+os_err_t mock_orch_init(void)
+{
+  const orch_config_t cfg = {
+    .publish = mock_publish,
+    .on_state_changed = mock_orch_state_changed,
+  };
+  ESP_LOGI(TAG, "mock_orch_init");
+  os_err_t err = orch_init(&cfg);
+  if (err != OS_OK) {
+    return err;
+  }
+  /* The orchestrator sees every event ahead of its subscribers and withholds gated ones */
+  evt_bus_set_gate(mock_orch_gate, NULL);
+  return OS_OK;
+}
+
 os_err_t mock_errmgr_init(void)  { ESP_LOGI(TAG, "mock_errmgr_init"); return OS_OK; }
-os_err_t mock_event_bus_init(void) { ESP_LOGI(TAG, "mock_event_bus_init"); return OS_OK; }
+
+os_err_t mock_event_bus_init(void)
+{
+  const evt_bus_config_t cfg = { .cb_budget_us = MOCK_EVT_BUS_CB_BUDGET_US };
+  os_err_t err = evt_bus_freertos_init(&cfg);
+  if (err != OS_OK) {
+    return err;
+  }
+  evt_bus_subscribe(EVT_WATCHDOG_WARNING, OS_MOD_MONITOR, mock_health_cb, NULL);
+  evt_bus_subscribe(EVT_HEALTH_TICK, OS_MOD_MONITOR, mock_health_cb, NULL);
+
+  g_evt_journal_lock = xSemaphoreCreateMutexStatic(&g_evt_journal_lock_buf);
+  const evt_journal_config_t jcfg = {
+    .buf = g_evt_journal_buf,
+    .cap = sizeof(g_evt_journal_buf),
+    .lock = mock_evt_journal_lock,
+    .unlock = mock_evt_journal_unlock,
+  };
+  if (!g_evt_journal_lock || evt_journal_init(&jcfg) != OS_OK) {
+    return OS_ENOMEM;
+  }
+  evt_bus_set_trace(evt_journal_trace, NULL);
+  ESP_LOGI(TAG, "mock_event_bus_init");
+  (void)mem_budget_track_task("evt_bus", MOCK_EVT_BUS_TASK_STACK);
+  return evt_bus_freertos_start_dispatch_task(MOCK_EVT_BUS_TASK_PRIO, MOCK_EVT_BUS_TASK_STACK,
+                                              MOCK_EVT_BUS_HEALTH_MS, MOCK_EVT_BUS_CORE);
+}
 
 /* -------------------------------------------------------------------------- */
 /* Mock “tick/process” to generate realistic events                            */
 /* Call this from your main loop initially.                                   */
 /* -------------------------------------------------------------------------- */
 
-void mock_system_step(uint32_t step)
+static uint32_t mock_min_deadline(uint32_t a, uint32_t b)
+{
+  return (a < b) ? a : b;
+}
+
+/* First step after this one that publishes mock traffic or dumps the journal */
+static uint32_t mock_next_traffic_step(uint32_t step)
+{
+  static const uint32_t periods[] = { 5u, 7u, 23u };
+  uint32_t next = (step < MOCK_EVT_JOURNAL_DUMP_STEP) ? MOCK_EVT_JOURNAL_DUMP_STEP : SCHED_NO_DEADLINE;
+  for (size_t i = 0; i < sizeof(periods) / sizeof(periods[0]); i++) {
+    next = mock_min_deadline(next, (step / periods[i] + 1u) * periods[i]);
+  }
+  return next;
+}
+
+uint32_t mock_system_step(uint32_t step)
 {
   if (step == 0) {
-    mock_publish(OS_MOD_ORCH, EVT_HEALTH_TICK, NULL, 0);
-    return;
+    (void)evt_bus_emit_health_tick();
+    return 1u;
+  }
+
+  if (step == MOCK_EVT_JOURNAL_DUMP_STEP) {
+    ESP_LOGI(TAG, "evt journal dump (%u bytes)", (unsigned)evt_journal_export_size());
+    (void)evt_journal_export(mock_evt_journal_write_hex, NULL);
   }
 
   if ((step % 5u) == 0u) {
@@ -118,12 +677,30 @@ void mock_system_step(uint32_t step)
 
   if ((step % 7u) == 0u) {
     g_auth.authed ^= 1u;
-    /* define an auth payload later; for now send no payload */
-    mock_publish(OS_MOD_AUTH, EVT_AUTH_STATE_CHANGED, NULL, 0);
+    evt_auth_state_changed_t p = { .authed = g_auth.authed };
+    mock_publish(OS_MOD_AUTH, EVT_AUTH_STATE_CHANGED, &p, sizeof(p));
+  }
+
+  if ((step % 23u) == 0u) {
+    g_pwr.pwr = (g_pwr.pwr == PWR_ACTIVE) ? PWR_IDLE : PWR_ACTIVE;
+    evt_power_mode_changed_t p = { .mode = g_pwr.pwr };
+    mock_publish(OS_MOD_POWER, EVT_POWER_MODE_CHANGED, &p, sizeof(p));
   }
 
-  if ((step % 11u) == 0u) {
-    evt_schedule_due_t p = { .schedule_id = 42u };
-    mock_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, &p, sizeof(p));
+  /* Scheduler only runs when its next deadline is reached (no table polling) */
+  uint32_t next = sched_next_deadline();
+  if (step >= next) {
+    next = sched_process(step);
   }
+  /* Render the next due slot ahead of time (a peek when nothing is near) */
+  next = mock_min_deadline(next, slot_prefetch_tick(step));
+  /* Power the TX channel up ahead of it, and switch idle channels off */
+  next = mock_min_deadline(next, ir_power_tick(step));
+
+  /* Batched storage flush once the oldest dirty record is old enough */
+  next = mock_min_deadline(next, scache_tick(step));
+
+  next = mock_min_deadline(next, mock_next_traffic_step(step));
+  next = mock_min_deadline(next, step + MOCK_STEP_MAX_SLEEP);
+  return (next > step) ? next : step + 1u;
 }
@@ -10,6 +10,14 @@ extern "C" {
 
 /* Mock component initialization for now, real functions will have the same names minus the "mock_" prefix */
 
+/* 1: wifi, ble, storage and ir init sleep for a fixed, made-up time (radio bring-up,
+ * index rebuild, RMT setup) so the startup report has something to overlap. The
+ * report's durations and critical path are then simulated, not measured.
+ * 0: the mocks return at once and the report times the mocks alone. */
+#ifndef MOCK_SIMULATE_INIT_COST
+#define MOCK_SIMULATE_INIT_COST 1
+#endif
+
 /* Infrastructure */
 os_err_t mock_event_bus_init(void);
 os_err_t mock_storage_init(void);
@@ -33,7 +41,9 @@ os_err_t mock_ir_init(void);
 os_err_t mock_cmd_init(void);
 
 
-void mock_system_step(uint32_t step);
+/* One step of the demo clock (1 step = 1 s); returns the step to sleep until:
+ * the earliest scheduler, prefetch, ir_power, cache flush or mock traffic deadline */
+uint32_t mock_system_step(uint32_t step);
 
 #ifdef __cplusplus
 }
@@ -2,51 +2,75 @@
 #include <stdint.h>
 
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_log.h"
 
 #include "mocks.h"
 #include "retrofit_os_types.h" 
+#include "sys_init.h"
+#include "mem_budget.h"
+#include "sdkconfig.h"
 
 
 //TODO: Include a generic types header that enumerates system events, types, etc.
 
-#define SYSTEM_DEMO_TICK_DELAY_MS 1000
+#define SYSTEM_DEMO_TICK_DELAY_MS 1000  // one mock_system_step() step
 
 static const char *TAG = "SYS_DEMO_MAIN";
 
-/* System Demo mocks */
+/* System Demo mocks: module graph, started by sys_init (independent inits overlap) */
+#define DEP(m) SYS_INIT_DEP(OS_MOD_##m)
+
+static const sys_init_module_t s_modules[] = {
+    { OS_MOD_EVT_BUS, "event_bus", mock_event_bus_init, 0 },
+    { OS_MOD_STORAGE, "storage",   mock_storage_init,   DEP(EVT_BUS) },
+    { OS_MOD_CLOCK,   "clock",     mock_clock_init,     DEP(EVT_BUS) },
+    { OS_MOD_ERRMGR,  "errmgr",    mock_errmgr_init,    DEP(EVT_BUS) },
+    { OS_MOD_ORCH,    "orch",      mock_orch_init,      DEP(EVT_BUS) },
+    { OS_MOD_AUTH,    "auth",      mock_auth_init,      DEP(EVT_BUS) | DEP(STORAGE) },
+    { OS_MOD_BLE,     "ble",       mock_ble_init,       DEP(EVT_BUS) },
+    { OS_MOD_WIFI,    "wifi",      mock_wifi_init,      DEP(EVT_BUS) | DEP(STORAGE) },
+    { OS_MOD_POWER,   "power",     mock_power_init,     DEP(EVT_BUS) },  /* optional */
+    { OS_MOD_SCHED,   "sched",     mock_sched_init,     DEP(STORAGE) | DEP(CLOCK) },
+    { OS_MOD_IR,      "ir",        mock_ir_init,        DEP(STORAGE) | DEP(POWER) | DEP(ORCH) },
+    { OS_MOD_CMD,     "cmd",       mock_cmd_init,       DEP(ORCH) },
+};
+
 static void system_demo_init(void)
 {
     // Initialization code for the system demo application
-    ESP_LOGI(TAG, "System demo initialized.");
-
-    // Initialize components 
-    mock_event_bus_init();
-    mock_storage_init();
-    mock_clock_init();
-    mock_errmgr_init();
-    mock_orch_init();
-    mock_auth_init();
-    mock_ble_init();
-    mock_wifi_init();
-    mock_power_init();  /* optional */
-    mock_sched_init();
-    mock_ir_init();
-    mock_cmd_init();
+    const sys_init_cfg_t cfg = {
+        .workers = 0,               /* one per core */
+        .priority = 5,
+        .ready_module = OS_MOD_IR,  /* "ready to send IR" milestone */
+    };
+    sys_init_report_t report;
+    size_t count = sizeof(s_modules) / sizeof(s_modules[0]);
 
+    // Initialize components
+    if (sys_init_run(s_modules, count, &cfg, &report) != OS_OK) {
+        ESP_LOGE(TAG, "System demo init failed (mask=0x%08x).", (unsigned)report.failed);
+    }
+    sys_init_log_report(s_modules, count, &report);
+#if MOCK_SIMULATE_INIT_COST
+    ESP_LOGW(TAG, "Init times above are simulated: wifi/ble/storage/ir sleep a fixed time (MOCK_SIMULATE_INIT_COST=1)");
+#endif
+    (void)mem_budget_track_task("main", CONFIG_ESP_MAIN_TASK_STACK_SIZE);
+    mem_budget_log_report();
+    ESP_LOGI(TAG, "System demo initialized.");
 }
 
 static void system_demo_run(void)
 {
     // Main loop code for the system demo application
-    // This may include handling events, processing data, etc.
+    // Sleeps until the next deadline instead of waking every step
+    uint32_t step = 0;
+    TickType_t last_wake = xTaskGetTickCount();
     while (1) {
-        // Example: Print a message every second
-        static uint32_t counter = 0;
-        ESP_LOGI(TAG, "System demo is running...");
-        mock_system_step(counter);
-        counter++;
-        vTaskDelay(pdMS_TO_TICKS(SYSTEM_DEMO_TICK_DELAY_MS));
+        ESP_LOGI(TAG, "System demo is running (step %u)", (unsigned)step);
+        uint32_t next = mock_system_step(step);
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS((next - step) * SYSTEM_DEMO_TICK_DELAY_MS));
+        step = next;
     }
 }
 
@@ -0,0 +1,463 @@
+/* evt_bus_core.c — platform-agnostic event bus core (no RTOS, no heap)
+ *
+ * Tables are touched under the port lock; dispatch copies the subscriber
+ * list of an event under the lock and runs callbacks without it, so a
+ * callback may (un)subscribe or publish.
+ */
+
+#include <string.h>
+#include "evt_bus_core.h"
+
+_Static_assert(sizeof(evt_watchdog_warning_t) <= OS_EVT_INLINE_MAX, "evt_watchdog_warning_t must fit inline");
+_Static_assert(sizeof(evt_health_tick_t) <= OS_EVT_INLINE_MAX, "evt_health_tick_t must fit inline");
+_Static_assert(EVT_BUS_MAX_HANDLES < 0xFFFFu, "slot + 1 must fit the handle");
+
+typedef struct {
+  os_evt_cb_t cb;
+  void       *user_ctx;
+  uint16_t    gen;
+  uint8_t     active;
+  uint8_t     warned;     /* watchdog warning raised in this health window */
+  os_evt_id_t evt_id;
+  os_mod_id_t owner;
+  uint32_t    budget_us;
+  uint32_t    calls;
+  uint32_t    overruns;
+  uint32_t    max_us;
+  uint32_t    total_us;
+} evt_bus_slot_t;
+
+/* Health window, reset by every EVT_HEALTH_TICK */
+typedef struct {
+  uint32_t    dispatched;
+  uint32_t    dropped;
+  uint16_t    q_high_water;
+  os_mod_id_t slow_module;
+  uint32_t    slow_cb_us;
+  uint32_t    lat_max_us;
+} evt_bus_window_t;
+
+typedef struct {
+  evt_bus_port_t     port;
+  uint32_t           budget_us;
+  evt_bus_slot_t     slots[EVT_BUS_MAX_HANDLES];
+  evt_bus_handle_t   subs[EVT__MAX][EVT_BUS_MAX_SUBS_PER_EVT];
+  evt_bus_lat_hist_t lat[EVT__MAX];
+  evt_bus_stats_t    stats;
+  evt_bus_window_t   win;
+  evt_bus_trace_fn_t trace;
+  void              *trace_ctx;
+  evt_bus_gate_fn_t  gate;
+  void              *gate_ctx;
+  uint8_t            ready;
+} evt_bus_ctx_t;
+
+static evt_bus_ctx_t s_bus;
+
+/* -------------------------------------------------------------------------- */
+/* Helpers                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static inline evt_bus_handle_t evt_bus_make_handle(uint16_t slot, uint16_t gen)
+{
+  return ((evt_bus_handle_t)gen << 16) | (evt_bus_handle_t)(slot + 1u);
+}
+
+/* Slot of a live handle, NULL if stale or invalid */
+static evt_bus_slot_t *evt_bus_resolve(evt_bus_handle_t h)
+{
+  uint32_t idx = (h & 0xFFFFu);
+  if (idx == 0u || idx > EVT_BUS_MAX_HANDLES) {
+    return NULL;
+  }
+  evt_bus_slot_t *s = &s_bus.slots[idx - 1u];
+  return (s->active && s->gen == (uint16_t)(h >> 16)) ? s : NULL;
+}
+
+static inline uint32_t evt_bus_now_us(void)
+{
+  return s_bus.port.now_us(s_bus.port.ctx);
+}
+
+static inline uint8_t evt_bus_lat_bucket(uint32_t us)
+{
+  uint8_t b = us ? (uint8_t)(32 - __builtin_clz(us)) : 0u;
+  return (b < EVT_BUS_LAT_BUCKETS) ? b : (uint8_t)(EVT_BUS_LAT_BUCKETS - 1u);
+}
+
+static inline uint16_t evt_bus_sat16(uint32_t v)
+{
+  return (v > 0xFFFFu) ? 0xFFFFu : (uint16_t)v;
+}
+
+static void evt_bus_record_latency(os_evt_id_t id, uint32_t lat_us)
+{
+  evt_bus_lat_hist_t *h = &s_bus.lat[id];
+  uint8_t b = evt_bus_lat_bucket(lat_us);
+  h->count++;
+  if (h->hist[b] != 0xFFFFu) {
+    h->hist[b]++;
+  }
+  if (lat_us > h->max_us) {
+    h->max_us = lat_us;
+  }
+  if (lat_us > s_bus.win.lat_max_us) {
+    s_bus.win.lat_max_us = lat_us;
+  }
+}
+
+static os_err_t evt_bus_enqueue(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len, bool from_isr)
+{
+  if (!s_bus.ready || id == EVT_NONE || id >= EVT__MAX || len > OS_EVT_INLINE_MAX || (len && !payload)) {
+    return OS_EINVAL;
+  }
+  evt_bus_item_t item;
+  item.pub_us = evt_bus_now_us();
+  item.evt.id = id;
+  item.evt.src = src;
+  item.evt.ts_ms = s_bus.port.now_ms ? s_bus.port.now_ms(s_bus.port.ctx) : 0u;
+  item.evt.len = len;
+  if (len) {
+    memcpy(item.evt.payload, payload, len);
+  }
+
+  uint16_t depth = 0;
+  if (!s_bus.port.enqueue(&item, from_isr, &depth, s_bus.port.ctx)) {
+    s_bus.stats.dropped++;
+    s_bus.win.dropped++;
+    return OS_EFULL;
+  }
+  s_bus.stats.published++;
+  if (depth > s_bus.stats.q_high_water) {
+    s_bus.stats.q_high_water = depth;
+  }
+  if (depth > s_bus.win.q_high_water) {
+    s_bus.win.q_high_water = depth;
+  }
+  return OS_OK;
+}
+
+/* Time one callback, account it to its slot and flag budget overruns */
+static void evt_bus_run_callback(evt_bus_slot_t *s, const os_evt_t *evt)
+{
+  uint32_t t0 = evt_bus_now_us();
+  s->cb(evt, s->user_ctx);
+  uint32_t dt = evt_bus_now_us() - t0;
+
+  s->calls++;
+  s->total_us += dt;
+  if (dt > s->max_us) {
+    s->max_us = dt;
+  }
+  if (dt > s_bus.win.slow_cb_us) {
+    s_bus.win.slow_cb_us = dt;
+    s_bus.win.slow_module = s->owner;
+  }
+  if (!s->budget_us || dt <= s->budget_us) {
+    return;
+  }
+  s->overruns++;
+  s_bus.stats.overruns++;
+
+  /* One warning per subscriber per health window; never for the health
+   * events themselves, so a slow health listener cannot feed back. */
+  if (s->warned || evt->id == EVT_WATCHDOG_WARNING || evt->id == EVT_HEALTH_TICK) {
+    return;
+  }
+  s->warned = 1u;
+  evt_watchdog_warning_t w = {
+    .module = s->owner,
+    .evt_id = evt->id,
+    .elapsed_us = dt,
+    .budget_us = s->budget_us,
+  };
+  if (evt_bus_enqueue(OS_MOD_EVT_BUS, EVT_WATCHDOG_WARNING, &w, sizeof(w), false) == OS_OK) {
+    s_bus.stats.watchdog_warnings++;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+os_err_t evt_bus_init(const evt_bus_port_t *port, const evt_bus_config_t *cfg)
+{
+  if (!port || !port->enqueue || !port->dequeue || !port->depth || !port->lock || !port->unlock || !port->now_us) {
+    return OS_EINVAL;
+  }
+  memset(&s_bus, 0, sizeof(s_bus));
+  s_bus.port = *port;
+  s_bus.budget_us = (cfg && cfg->cb_budget_us) ? cfg->cb_budget_us : EVT_BUS_DEFAULT_BUDGET_US;
+  for (uint16_t i = 0; i < EVT_BUS_MAX_HANDLES; i++) {
+    s_bus.slots[i].gen = 1u;
+  }
+  s_bus.ready = 1u;
+  return OS_OK;
+}
+
+evt_bus_handle_t evt_bus_subscribe(os_evt_id_t id, os_mod_id_t owner, os_evt_cb_t cb, void *user_ctx)
+{
+  if (!s_bus.ready || !cb || id == EVT_NONE || id >= EVT__MAX) {
+    return EVT_BUS_HANDLE_INVALID;
+  }
+  evt_bus_handle_t h = EVT_BUS_HANDLE_INVALID;
+  int free_pos = -1;
+  bool dup = false;
+
+  s_bus.port.lock(s_bus.port.ctx);
+
+  /* Repair the list first, reject duplicates */
+  evt_bus_handle_t *list = s_bus.subs[id];
+  for (uint16_t i = 0; i < EVT_BUS_MAX_SUBS_PER_EVT && !dup; i++) {
+    evt_bus_slot_t *s = evt_bus_resolve(list[i]);
+    if (!s) {
+      list[i] = EVT_BUS_HANDLE_INVALID;
+      if (free_pos < 0) {
+        free_pos = i;
+      }
+    } else if (s->cb == cb && s->user_ctx == user_ctx) {
+      dup = true;
+    }
+  }
+  for (uint16_t i = 0; i < EVT_BUS_MAX_HANDLES && !dup && free_pos >= 0; i++) {
+    evt_bus_slot_t *s = &s_bus.slots[i];
+    if (s->active) {
+      continue;
+    }
+    uint16_t gen = s->gen;
+    memset(s, 0, sizeof(*s));
+    s->gen = gen;
+    s->active = 1u;
+    s->cb = cb;
+    s->user_ctx = user_ctx;
+    s->evt_id = id;
+    s->owner = owner;
+    s->budget_us = s_bus.budget_us;
+    h = evt_bus_make_handle(i, gen);
+    list[free_pos] = h;
+    break;
+  }
+
+  s_bus.port.unlock(s_bus.port.ctx);
+  return h;
+}
+
+void evt_bus_unsubscribe(evt_bus_handle_t handle)
+{
+  if (!s_bus.ready) {
+    return;
+  }
+  s_bus.port.lock(s_bus.port.ctx);
+  evt_bus_slot_t *s = evt_bus_resolve(handle);
+  if (s) {
+    s->active = 0u;
+    s->gen = (uint16_t)(s->gen + 1u) ? (uint16_t)(s->gen + 1u) : 1u;
+  }
+  s_bus.port.unlock(s_bus.port.ctx);
+}
+
+os_err_t evt_bus_set_budget(evt_bus_handle_t handle, uint32_t budget_us)
+{
+  os_err_t err = OS_EINVAL;
+  s_bus.port.lock(s_bus.port.ctx);
+  evt_bus_slot_t *s = evt_bus_resolve(handle);
+  if (s) {
+    s->budget_us = budget_us;
+    err = OS_OK;
+  }
+  s_bus.port.unlock(s_bus.port.ctx);
+  return err;
+}
+
+void evt_bus_set_trace(evt_bus_trace_fn_t fn, void *trace_ctx)
+{
+  if (!s_bus.ready) {
+    return;
+  }
+  s_bus.port.lock(s_bus.port.ctx);
+  s_bus.trace = fn;
+  s_bus.trace_ctx = trace_ctx;
+  s_bus.port.unlock(s_bus.port.ctx);
+}
+
+void evt_bus_set_gate(evt_bus_gate_fn_t fn, void *gate_ctx)
+{
+  if (!s_bus.ready) {
+    return;
+  }
+  s_bus.port.lock(s_bus.port.ctx);
+  s_bus.gate = fn;
+  s_bus.gate_ctx = gate_ctx;
+  s_bus.port.unlock(s_bus.port.ctx);
+}
+
+os_err_t evt_bus_publish(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len)
+{
+  return evt_bus_enqueue(src, id, payload, len, false);
+}
+
+os_err_t evt_bus_publish_from_isr(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len)
+{
+  return evt_bus_enqueue(src, id, payload, len, true);
+}
+
+void evt_bus_dispatch_item(const evt_bus_item_t *item)
+{
+  const os_evt_t *evt = &item->evt;
+  if (!s_bus.ready || evt->id >= EVT__MAX) {
+    return;
+  }
+  evt_bus_record_latency(evt->id, evt_bus_now_us() - item->pub_us);
+  s_bus.stats.dispatched++;
+  s_bus.win.dispatched++;
+
+  /* Snapshot the hooks and live handles, self-heal stale ones */
+  evt_bus_handle_t snap[EVT_BUS_MAX_SUBS_PER_EVT];
+  uint16_t n = 0;
+  s_bus.port.lock(s_bus.port.ctx);
+  evt_bus_trace_fn_t trace = s_bus.trace;
+  void *trace_ctx = s_bus.trace_ctx;
+  evt_bus_gate_fn_t gate = s_bus.gate;
+  void *gate_ctx = s_bus.gate_ctx;
+  evt_bus_handle_t *list = s_bus.subs[evt->id];
+  for (uint16_t i = 0; i < EVT_BUS_MAX_SUBS_PER_EVT; i++) {
+    if (list[i] == EVT_BUS_HANDLE_INVALID) {
+      continue;
+    }
+    if (evt_bus_resolve(list[i])) {
+      snap[n++] = list[i];
+    } else {
+      list[i] = EVT_BUS_HANDLE_INVALID;
+    }
+  }
+  s_bus.port.unlock(s_bus.port.ctx);
+
+  if (trace) {
+    trace(evt, trace_ctx);
+  }
+  if (gate && !gate(evt, gate_ctx)) {
+    s_bus.stats.gated++;
+    return;
+  }
+  for (uint16_t i = 0; i < n; i++) {
+    /* Re-validate: an earlier callback may have unsubscribed this one */
+    evt_bus_slot_t *s = evt_bus_resolve(snap[i]);
+    if (s) {
+      evt_bus_run_callback(s, evt);
+    }
+  }
+}
+
+bool evt_bus_dispatch_one(void)
+{
+  evt_bus_item_t item;
+  if (!s_bus.ready || !s_bus.port.dequeue(&item, s_bus.port.ctx)) {
+    return false;
+  }
+  evt_bus_dispatch_item(&item);
+  return true;
+}
+
+void evt_bus_dispatch_all(void)
+{
+  while (evt_bus_dispatch_one()) {
+  }
+}
+
+os_err_t evt_bus_emit_health_tick(void)
+{
+  if (!s_bus.ready) {
+    return OS_ESTATE;
+  }
+  uint16_t depth = s_bus.port.depth(s_bus.port.ctx);
+  evt_health_tick_t t = {
+    .dispatched = evt_bus_sat16(s_bus.win.dispatched),
+    .dropped = evt_bus_sat16(s_bus.win.dropped),
+    .q_high_water = (s_bus.win.q_high_water > 0xFFu) ? 0xFFu : (uint8_t)s_bus.win.q_high_water,
+    .q_depth = (depth > 0xFFu) ? 0xFFu : (uint8_t)depth,
+    .slow_module = s_bus.win.slow_module,
+    .slow_cb_us = s_bus.win.slow_cb_us,
+    .lat_max_us = s_bus.win.lat_max_us,
+  };
+  memset(&s_bus.win, 0, sizeof(s_bus.win));
+
+  s_bus.port.lock(s_bus.port.ctx);
+  for (uint16_t i = 0; i < EVT_BUS_MAX_HANDLES; i++) {
+    s_bus.slots[i].warned = 0u;
+  }
+  s_bus.port.unlock(s_bus.port.ctx);
+
+  return evt_bus_publish(OS_MOD_EVT_BUS, EVT_HEALTH_TICK, &t, sizeof(t));
+}
+
+void evt_bus_get_stats(evt_bus_stats_t *out)
+{
+  if (!out) {
+    return;
+  }
+  *out = s_bus.stats;
+  out->q_depth = s_bus.ready ? s_bus.port.depth(s_bus.port.ctx) : 0u;
+}
+
+os_err_t evt_bus_get_latency(os_evt_id_t id, evt_bus_lat_hist_t *out)
+{
+  if (id >= EVT__MAX || !out) {
+    return OS_EINVAL;
+  }
+  *out = s_bus.lat[id];
+  return OS_OK;
+}
+
+os_err_t evt_bus_get_sub_stats(evt_bus_handle_t handle, evt_bus_sub_stats_t *out)
+{
+  const evt_bus_slot_t *s = evt_bus_resolve(handle);
+  if (!s || !out) {
+    return OS_EINVAL;
+  }
+  *out = (evt_bus_sub_stats_t) {
+    .evt_id = s->evt_id,
+    .owner = s->owner,
+    .budget_us = s->budget_us,
+    .calls = s->calls,
+    .overruns = s->overruns,
+    .max_us = s->max_us,
+    .total_us = s->total_us,
+  };
+  return OS_OK;
+}
+
+void evt_bus_reset_stats(void)
+{
+  memset(&s_bus.stats, 0, sizeof(s_bus.stats));
+  memset(&s_bus.win, 0, sizeof(s_bus.win));
+  memset(s_bus.lat, 0, sizeof(s_bus.lat));
+  for (uint16_t i = 0; i < EVT_BUS_MAX_HANDLES; i++) {
+    evt_bus_slot_t *s = &s_bus.slots[i];
+    s->calls = s->overruns = s->max_us = s->total_us = 0u;
+    s->warned = 0u;
+  }
+}
+
+uint32_t evt_bus_lat_percentile_us(const evt_bus_lat_hist_t *hist, uint8_t pct)
+{
+  if (!hist || pct > 100u) {
+    return 0u;
+  }
+  uint32_t total = 0;
+  for (uint8_t b = 0; b < EVT_BUS_LAT_BUCKETS; b++) {
+    total += hist->hist[b];
+  }
+  if (!total) {
+    return 0u;
+  }
+  uint32_t target = (total * pct + 99u) / 100u;
+  uint32_t acc = 0;
+  for (uint8_t b = 0; b < EVT_BUS_LAT_BUCKETS - 1u; b++) {
+    acc += hist->hist[b];
+    if (acc >= target) {
+      uint32_t upper = b ? ((1u << b) - 1u) : 0u;
+      return (upper < hist->max_us) ? upper : hist->max_us;
+    }
+  }
+  return hist->max_us;
+}
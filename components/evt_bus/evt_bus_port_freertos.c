@@ -0,0 +1,153 @@
+/* evt_bus_port_freertos.c — FreeRTOS queue, lock, clock and dispatcher task */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "evt_bus_port_freertos.h"
+
+typedef struct {
+  QueueHandle_t     queue;
+  SemaphoreHandle_t lock;
+  StaticQueue_t     queue_buf;
+  StaticSemaphore_t lock_buf;
+  uint8_t           storage[EVT_BUS_QUEUE_DEPTH * sizeof(evt_bus_item_t)];
+  uint32_t          health_period_ms;
+  TaskHandle_t      task;
+  StaticTask_t      task_buf;
+  StackType_t       stack[EVT_BUS_DISPATCH_STACK];
+} evt_bus_freertos_t;
+
+static evt_bus_freertos_t s_port;
+
+/* -------------------------------------------------------------------------- */
+/* Port ops                                                                   */
+/* -------------------------------------------------------------------------- */
+
+static bool port_enqueue(const evt_bus_item_t *item, bool from_isr, uint16_t *depth, void *ctx)
+{
+  (void)ctx;
+  if (from_isr) {
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(s_port.queue, item, &woken) != pdPASS) {
+      return false;
+    }
+    *depth = (uint16_t)uxQueueMessagesWaitingFromISR(s_port.queue);
+    portYIELD_FROM_ISR(woken);
+    return true;
+  }
+  if (xQueueSend(s_port.queue, item, 0) != pdPASS) {
+    return false;
+  }
+  *depth = (uint16_t)uxQueueMessagesWaiting(s_port.queue);
+  return true;
+}
+
+static bool port_dequeue(evt_bus_item_t *item, void *ctx)
+{
+  (void)ctx;
+  return xQueueReceive(s_port.queue, item, 0) == pdPASS;
+}
+
+static uint16_t port_depth(void *ctx)
+{
+  (void)ctx;
+  return (uint16_t)uxQueueMessagesWaiting(s_port.queue);
+}
+
+static void port_lock(void *ctx)
+{
+  (void)ctx;
+  xSemaphoreTake(s_port.lock, portMAX_DELAY);
+}
+
+static void port_unlock(void *ctx)
+{
+  (void)ctx;
+  xSemaphoreGive(s_port.lock);
+}
+
+static uint32_t port_now_us(void *ctx)
+{
+  (void)ctx;
+  return (uint32_t)esp_timer_get_time();
+}
+
+static uint32_t port_now_ms(void *ctx)
+{
+  (void)ctx;
+  /* from the 64-bit timer: wraps after ~49.7 days, not with the us clock */
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Dispatcher                                                                 */
+/* -------------------------------------------------------------------------- */
+
+static void evt_bus_dispatch_task(void *arg)
+{
+  (void)arg;
+  const uint32_t period_ms = s_port.health_period_ms;
+  TickType_t next_tick = xTaskGetTickCount() + pdMS_TO_TICKS(period_ms);
+
+  for (;;) {
+    TickType_t wait = portMAX_DELAY;
+    if (period_ms) {
+      TickType_t now = xTaskGetTickCount();
+      wait = ((int32_t)(next_tick - now) > 0) ? (next_tick - now) : 0;
+    }
+    evt_bus_item_t item;
+    if (xQueueReceive(s_port.queue, &item, wait) == pdPASS) {
+      evt_bus_dispatch_item(&item);
+    }
+    if (period_ms && (int32_t)(xTaskGetTickCount() - next_tick) >= 0) {
+      next_tick += pdMS_TO_TICKS(period_ms);
+      (void)evt_bus_emit_health_tick();
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+os_err_t evt_bus_freertos_init(const evt_bus_config_t *cfg)
+{
+  if (!s_port.queue) {
+    s_port.queue = xQueueCreateStatic(EVT_BUS_QUEUE_DEPTH, sizeof(evt_bus_item_t), s_port.storage, &s_port.queue_buf);
+    s_port.lock = xSemaphoreCreateMutexStatic(&s_port.lock_buf);
+  }
+  if (!s_port.queue || !s_port.lock) {
+    return OS_ENOMEM;
+  }
+  const evt_bus_port_t port = {
+    .enqueue = port_enqueue,
+    .dequeue = port_dequeue,
+    .depth = port_depth,
+    .lock = port_lock,
+    .unlock = port_unlock,
+    .now_us = port_now_us,
+    .now_ms = port_now_ms,
+  };
+  return evt_bus_init(&port, cfg);
+}
+
+os_err_t evt_bus_freertos_start_dispatch_task(UBaseType_t prio, uint32_t stack_bytes,
+                                              uint32_t health_period_ms, BaseType_t core_id)
+{
+  if (!s_port.queue) {
+    return OS_ESTATE;
+  }
+  if (s_port.task) {
+    return OS_EBUSY;
+  }
+  if (stack_bytes > EVT_BUS_DISPATCH_STACK) {
+    return OS_EINVAL;
+  }
+  s_port.health_period_ms = health_period_ms;
+  s_port.task = xTaskCreateStaticPinnedToCore(evt_bus_dispatch_task, "evt_bus",
+                                              stack_bytes ? stack_bytes : EVT_BUS_DISPATCH_STACK, NULL, prio,
+                                              s_port.stack, &s_port.task_buf, core_id);
+  return s_port.task ? OS_OK : OS_EFAIL;
+}
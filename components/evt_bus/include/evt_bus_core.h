@@ -0,0 +1,147 @@
+#ifndef EVT_BUS_CORE_H
+#define EVT_BUS_CORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Event bus core (platform-agnostic, no heap)
+ *
+ * - Publish = enqueue through the port; callbacks only run in dispatch
+ * - Handles are { slot, generation }: O(1) unsubscribe, lists self-heal
+ * - Built-in observability: publish->dispatch latency histogram per event,
+ *   queue high-water mark, per-subscriber callback time against a budget
+ *
+ * POLICY:
+ * - Overflow: DROP_NEW + counter
+ * - A callback over its budget raises EVT_WATCHDOG_WARNING (once per
+ *   subscriber per health tick) naming the owning module
+ * - Counters written from publish (task/ISR) are best-effort, not locked
+ * - A gate that refuses an event withholds it from all subscribers; the
+ *   trace hook still sees it (the journal records what was refused)
+ * ========================================================================== */
+
+#ifndef EVT_BUS_MAX_HANDLES
+#define EVT_BUS_MAX_HANDLES 48u
+#endif
+
+#ifndef EVT_BUS_MAX_SUBS_PER_EVT
+#define EVT_BUS_MAX_SUBS_PER_EVT 6u
+#endif
+
+/* log2 latency buckets: [0] = 0 us, [k] = [2^(k-1), 2^k) us, last is open-ended */
+#ifndef EVT_BUS_LAT_BUCKETS
+#define EVT_BUS_LAT_BUCKETS 16u
+#endif
+
+#ifndef EVT_BUS_DEFAULT_BUDGET_US
+#define EVT_BUS_DEFAULT_BUDGET_US 2000u
+#endif
+
+typedef uint32_t evt_bus_handle_t;  /* [15:0] slot + 1, [31:16] generation */
+
+#define EVT_BUS_HANDLE_INVALID 0u
+
+/* Queue element: the envelope plus the publish timestamp of the port clock */
+typedef struct {
+  os_evt_t evt;
+  uint32_t pub_us;
+} evt_bus_item_t;
+
+/* Platform binding */
+typedef struct {
+  /* Copy item in; false if full. *depth = queue depth after the enqueue */
+  bool     (*enqueue)(const evt_bus_item_t *item, bool from_isr, uint16_t *depth, void *ctx);
+  /* Non-blocking; false if empty (used by evt_bus_dispatch_one/all) */
+  bool     (*dequeue)(evt_bus_item_t *item, void *ctx);
+  uint16_t (*depth)(void *ctx);
+  /* Protects the handle/subscription tables; never held across callbacks */
+  void     (*lock)(void *ctx);
+  void     (*unlock)(void *ctx);
+  /* Free-running microsecond clock, ISR-safe, wrap allowed; latency measurement only */
+  uint32_t (*now_us)(void *ctx);
+  /* Milliseconds since boot for os_evt_t.ts_ms, ISR-safe; optional (NULL = ts_ms 0, unknown) */
+  uint32_t (*now_ms)(void *ctx);
+  void      *ctx;
+} evt_bus_port_t;
+
+/* Sees every dispatched event once, before its subscribers (journal, tracing) */
+typedef void (*evt_bus_trace_fn_t)(const os_evt_t *evt, void *trace_ctx);
+
+/* Runs after the trace hook; false withholds the event from every subscriber */
+typedef bool (*evt_bus_gate_fn_t)(const os_evt_t *evt, void *gate_ctx);
+
+typedef struct {
+  uint32_t cb_budget_us;  /* default per-subscriber budget; 0 = EVT_BUS_DEFAULT_BUDGET_US */
+} evt_bus_config_t;
+
+typedef struct {
+  uint32_t published;
+  uint32_t dispatched;
+  uint32_t dropped;            /* DROP_NEW rejections */
+  uint32_t watchdog_warnings;  /* EVT_WATCHDOG_WARNING raised */
+  uint32_t overruns;           /* callbacks over budget (raised or not) */
+  uint32_t gated;              /* dispatched but withheld by the gate */
+  uint16_t q_high_water;
+  uint16_t q_depth;
+} evt_bus_stats_t;
+
+typedef struct {
+  uint32_t count;
+  uint32_t max_us;
+  uint16_t hist[EVT_BUS_LAT_BUCKETS];  /* saturating */
+} evt_bus_lat_hist_t;
+
+typedef struct {
+  os_evt_id_t evt_id;
+  os_mod_id_t owner;
+  uint32_t    budget_us;
+  uint32_t    calls;
+  uint32_t    overruns;
+  uint32_t    max_us;
+  uint32_t    total_us;
+} evt_bus_sub_stats_t;
+
+os_err_t evt_bus_init(const evt_bus_port_t *port, const evt_bus_config_t *cfg);
+
+/* owner is the module named in EVT_WATCHDOG_WARNING when the callback is slow */
+evt_bus_handle_t evt_bus_subscribe(os_evt_id_t id, os_mod_id_t owner, os_evt_cb_t cb, void *user_ctx);
+void             evt_bus_unsubscribe(evt_bus_handle_t handle);
+os_err_t         evt_bus_set_budget(evt_bus_handle_t handle, uint32_t budget_us);
+
+/* One trace hook; NULL removes it. Runs on the dispatch context, untimed. */
+void evt_bus_set_trace(evt_bus_trace_fn_t fn, void *trace_ctx);
+
+/* One gate (the orchestrator's verdict); NULL removes it. Dispatch context, untimed. */
+void evt_bus_set_gate(evt_bus_gate_fn_t fn, void *gate_ctx);
+
+/* Copy-in publish (len <= OS_EVT_INLINE_MAX). OS_EFULL if the queue is full. */
+os_err_t evt_bus_publish(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len);
+os_err_t evt_bus_publish_from_isr(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len);
+
+/* Dispatch entry points: ports blocking on their own queue use dispatch_item() */
+void evt_bus_dispatch_item(const evt_bus_item_t *item);
+bool evt_bus_dispatch_one(void);
+void evt_bus_dispatch_all(void);
+
+/* Publish EVT_HEALTH_TICK (evt_health_tick_t) for the window since the last tick */
+os_err_t evt_bus_emit_health_tick(void);
+
+void     evt_bus_get_stats(evt_bus_stats_t *out);
+os_err_t evt_bus_get_latency(os_evt_id_t id, evt_bus_lat_hist_t *out);
+os_err_t evt_bus_get_sub_stats(evt_bus_handle_t handle, evt_bus_sub_stats_t *out);
+void     evt_bus_reset_stats(void);
+
+/* Upper bound (us) of the bucket holding the pct-th percentile, capped at max_us */
+uint32_t evt_bus_lat_percentile_us(const evt_bus_lat_hist_t *hist, uint8_t pct);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVT_BUS_CORE_H */
@@ -0,0 +1,40 @@
+#ifndef EVT_BUS_PORT_FREERTOS_H
+#define EVT_BUS_PORT_FREERTOS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "evt_bus_core.h"
+
+/* ==========================================================================
+ * FreeRTOS binding for the event bus core
+ *
+ * - Static queue of evt_bus_item_t, mutex and dispatcher task (no heap)
+ * - Dispatcher task blocks on the queue and emits EVT_HEALTH_TICK every
+ *   health period (0 = no periodic tick)
+ * - Timestamps come from esp_timer (ISR-safe)
+ * ========================================================================== */
+
+#ifndef EVT_BUS_QUEUE_DEPTH
+#define EVT_BUS_QUEUE_DEPTH 32u
+#endif
+
+/* Dispatcher stack reserved at build time (bytes) */
+#ifndef EVT_BUS_DISPATCH_STACK
+#define EVT_BUS_DISPATCH_STACK 4096u
+#endif
+
+os_err_t evt_bus_freertos_init(const evt_bus_config_t *cfg);
+
+/* stack_bytes <= EVT_BUS_DISPATCH_STACK (OS_EINVAL otherwise); 0 = all of it */
+os_err_t evt_bus_freertos_start_dispatch_task(UBaseType_t prio, uint32_t stack_bytes,
+                                              uint32_t health_period_ms, BaseType_t core_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVT_BUS_PORT_FREERTOS_H */
@@ -0,0 +1,302 @@
+/* evt_journal.c — compact binary journal of dispatched events (no heap)
+ *
+ * The ring only ever holds whole records: an append that does not fit drops
+ * records from the tail first, folding their deltas into base_ts_ms so the
+ * oldest kept record still decodes to its absolute timestamp.
+ */
+
+#include <string.h>
+#include "evt_journal.h"
+
+_Static_assert(EVT__MAX < 0xFFu, "event ids must fit one byte, 0xFF marks erased flash");
+_Static_assert(OS_MOD_MAX <= EVT_JOURNAL_SRC_MASK + 1u, "module ids must fit the src field");
+_Static_assert(OS_EVT_INLINE_MAX <= 0xFFu, "payload length must fit one byte");
+_Static_assert(sizeof(evt_journal_hdr_t) == 24u, "dump header layout is ABI");
+
+typedef struct {
+  evt_journal_config_t cfg;
+  uint32_t             head;        /* next write offset */
+  uint32_t             tail;        /* oldest record */
+  uint32_t             base_ts_ms;  /* timestamp before the oldest record */
+  uint32_t             last_ts_ms;  /* timestamp of the newest record */
+  evt_journal_stats_t  stats;
+  uint8_t              ready;
+} evt_journal_ctx_t;
+
+static evt_journal_ctx_t s_j;
+
+/* -------------------------------------------------------------------------- */
+/* Helpers                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static inline void evtj_lock(void)
+{
+  if (s_j.cfg.lock) {
+    s_j.cfg.lock(s_j.cfg.ctx);
+  }
+}
+
+static inline void evtj_unlock(void)
+{
+  if (s_j.cfg.unlock) {
+    s_j.cfg.unlock(s_j.cfg.ctx);
+  }
+}
+
+static uint32_t evtj_encode(const os_evt_t *evt, uint32_t prev_ts_ms, uint8_t *out)
+{
+  uint32_t n = 0;
+  out[n++] = (uint8_t)evt->id;
+  out[n++] = (uint8_t)(evt->src | (evt->len ? EVT_JOURNAL_F_PAYLOAD : 0u));
+
+  /* Zigzag keeps a clock wrap or a reordered timestamp small */
+  uint32_t d = evt->ts_ms - prev_ts_ms;
+  uint32_t zz = (d << 1) ^ (uint32_t)((int32_t)d >> 31);
+  while (zz >= 0x80u) {
+    out[n++] = (uint8_t)(zz | 0x80u);
+    zz >>= 7;
+  }
+  out[n++] = (uint8_t)zz;
+
+  if (evt->len) {
+    out[n++] = (uint8_t)evt->len;
+    memcpy(&out[n], evt->payload, evt->len);
+    n += evt->len;
+  }
+  return n;
+}
+
+/* Decode one record from avail bytes; *ts_ms advances by its delta. out may be NULL. */
+static os_err_t evtj_decode(const uint8_t *p, uint32_t avail, uint32_t *ts_ms, os_evt_t *out, uint32_t *size)
+{
+  if (avail < 3u || p[0] == EVT_NONE || p[0] >= EVT__MAX) {
+    return OS_ECRC;
+  }
+  uint32_t n = 2u;
+  uint32_t zz = 0;
+  for (uint32_t shift = 0;; shift += 7u) {
+    if (n >= avail || shift > 28u) {
+      return OS_ECRC;
+    }
+    uint8_t b = p[n++];
+    zz |= (uint32_t)(b & 0x7Fu) << shift;
+    if (!(b & 0x80u)) {
+      break;
+    }
+  }
+  uint16_t len = 0;
+  if (p[1] & EVT_JOURNAL_F_PAYLOAD) {
+    if (n >= avail) {
+      return OS_ECRC;
+    }
+    len = p[n++];
+    if (len == 0u || len > OS_EVT_INLINE_MAX || avail - n < len) {
+      return OS_ECRC;
+    }
+  }
+
+  *ts_ms += (zz >> 1) ^ (0u - (zz & 1u));
+  if (out) {
+    out->id = p[0];
+    out->src = p[1] & EVT_JOURNAL_SRC_MASK;
+    out->ts_ms = *ts_ms;
+    out->len = len;
+    memcpy(out->payload, &p[n], len);
+  }
+  *size = n + len;
+  return OS_OK;
+}
+
+static void evtj_ring_read(uint32_t off, uint8_t *dst, uint32_t n)
+{
+  uint32_t first = s_j.cfg.cap - off;
+  if (first > n) {
+    first = n;
+  }
+  memcpy(dst, &s_j.cfg.buf[off], first);
+  memcpy(dst + first, s_j.cfg.buf, n - first);
+}
+
+static void evtj_ring_write(const uint8_t *src, uint32_t n)
+{
+  uint32_t first = s_j.cfg.cap - s_j.head;
+  if (first > n) {
+    first = n;
+  }
+  memcpy(&s_j.cfg.buf[s_j.head], src, first);
+  memcpy(s_j.cfg.buf, src + first, n - first);
+  s_j.head = (s_j.head + n) % s_j.cfg.cap;
+}
+
+static void evtj_reset_ring(void)
+{
+  s_j.head = s_j.tail = 0u;
+  s_j.stats.bytes_used = 0u;
+  s_j.stats.kept = 0u;
+  s_j.base_ts_ms = s_j.last_ts_ms;
+}
+
+static void evtj_drop_oldest(void)
+{
+  uint8_t rec[EVT_JOURNAL_REC_MAX];
+  uint32_t n = (s_j.stats.bytes_used < sizeof(rec)) ? s_j.stats.bytes_used : (uint32_t)sizeof(rec);
+  uint32_t size = 0;
+
+  evtj_ring_read(s_j.tail, rec, n);
+  if (evtj_decode(rec, n, &s_j.base_ts_ms, NULL, &size) != OS_OK) {
+    /* Only records we encoded are in the ring; never expected */
+    s_j.stats.dropped += s_j.stats.kept;
+    evtj_reset_ring();
+    return;
+  }
+  s_j.tail = (s_j.tail + size) % s_j.cfg.cap;
+  s_j.stats.bytes_used -= size;
+  s_j.stats.kept--;
+  s_j.stats.dropped++;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+os_err_t evt_journal_init(const evt_journal_config_t *cfg)
+{
+  if (!cfg || !cfg->buf || cfg->cap < EVT_JOURNAL_REC_MAX || (!cfg->lock != !cfg->unlock)) {
+    return OS_EINVAL;
+  }
+  memset(&s_j, 0, sizeof(s_j));
+  s_j.cfg = *cfg;
+  s_j.ready = 1u;
+  return OS_OK;
+}
+
+os_err_t evt_journal_append(const os_evt_t *evt)
+{
+  if (!s_j.ready) {
+    return OS_ESTATE;
+  }
+  if (!evt || evt->id == EVT_NONE || evt->id >= EVT__MAX || evt->src > EVT_JOURNAL_SRC_MASK ||
+      evt->len > OS_EVT_INLINE_MAX) {
+    s_j.stats.rejected++;
+    return OS_EINVAL;
+  }
+
+  evtj_lock();
+  uint8_t rec[EVT_JOURNAL_REC_MAX];
+  uint32_t n = evtj_encode(evt, s_j.last_ts_ms, rec);
+  while (s_j.cfg.cap - s_j.stats.bytes_used < n) {
+    evtj_drop_oldest();
+  }
+  evtj_ring_write(rec, n);
+  s_j.last_ts_ms = evt->ts_ms;
+  s_j.stats.bytes_used += n;
+  s_j.stats.bytes_total += n;
+  s_j.stats.kept++;
+  s_j.stats.records++;
+  evtj_unlock();
+  return OS_OK;
+}
+
+void evt_journal_trace(const os_evt_t *evt, void *trace_ctx)
+{
+  (void)trace_ctx;
+  (void)evt_journal_append(evt);
+}
+
+uint32_t evt_journal_export_size(void)
+{
+  return (uint32_t)sizeof(evt_journal_hdr_t) + s_j.stats.bytes_used;
+}
+
+os_err_t evt_journal_export(evt_journal_write_fn_t write, void *ctx)
+{
+  if (!write) {
+    return OS_EINVAL;
+  }
+  if (!s_j.ready) {
+    return OS_ESTATE;
+  }
+
+  evtj_lock();
+  const evt_journal_hdr_t hdr = {
+    .magic = EVT_JOURNAL_MAGIC,
+    .version = EVT_JOURNAL_VERSION,
+    .hdr_len = (uint16_t)sizeof(evt_journal_hdr_t),
+    .base_ts_ms = s_j.base_ts_ms,
+    .bytes = s_j.stats.bytes_used,
+    .records = s_j.stats.kept,
+    .dropped = s_j.stats.dropped,
+  };
+  uint32_t first = s_j.cfg.cap - s_j.tail;
+  if (first > hdr.bytes) {
+    first = hdr.bytes;
+  }
+  os_err_t err = write(&hdr, sizeof(hdr), ctx);
+  if (err == OS_OK && first) {
+    err = write(&s_j.cfg.buf[s_j.tail], first, ctx);
+  }
+  if (err == OS_OK && hdr.bytes > first) {
+    err = write(s_j.cfg.buf, hdr.bytes - first, ctx);
+  }
+  evtj_unlock();
+  return err;
+}
+
+void evt_journal_clear(void)
+{
+  evtj_lock();
+  evtj_reset_ring();
+  memset(&s_j.stats, 0, sizeof(s_j.stats));
+  evtj_unlock();
+}
+
+void evt_journal_get_stats(evt_journal_stats_t *out)
+{
+  if (!out) {
+    return;
+  }
+  evtj_lock();
+  *out = s_j.stats;
+  evtj_unlock();
+}
+
+/* -------------------------------------------------------------------------- */
+/* Decoding                                                                   */
+/* -------------------------------------------------------------------------- */
+
+os_err_t evt_journal_parse(const void *dump, uint32_t len, evt_journal_hdr_t *hdr, const uint8_t **records)
+{
+  if (!dump || !hdr || len < sizeof(*hdr)) {
+    return OS_EINVAL;
+  }
+  memcpy(hdr, dump, sizeof(*hdr));
+  if (hdr->magic != EVT_JOURNAL_MAGIC || hdr->version != EVT_JOURNAL_VERSION ||
+      hdr->hdr_len < sizeof(*hdr) || hdr->hdr_len > len || hdr->bytes > len - hdr->hdr_len) {
+    return OS_ECRC;
+  }
+  if (records) {
+    *records = (const uint8_t *)dump + hdr->hdr_len;
+  }
+  return OS_OK;
+}
+
+void evt_journal_reader_init(evt_journal_reader_t *rd, const evt_journal_hdr_t *hdr, const uint8_t *records)
+{
+  rd->p = records;
+  rd->len = hdr->bytes;
+  rd->pos = 0u;
+  rd->ts_ms = hdr->base_ts_ms;
+}
+
+os_err_t evt_journal_next(evt_journal_reader_t *rd, os_evt_t *out)
+{
+  if (rd->pos >= rd->len) {
+    return OS_ESTATE;
+  }
+  uint32_t size = 0;
+  os_err_t err = evtj_decode(&rd->p[rd->pos], rd->len - rd->pos, &rd->ts_ms, out, &size);
+  if (err == OS_OK) {
+    rd->pos += size;
+  }
+  return err;
+}
@@ -0,0 +1,107 @@
+#ifndef EVT_JOURNAL_H
+#define EVT_JOURNAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Binary event journal (platform-agnostic, no heap)
+ *
+ * Records every dispatched os_evt_t into a caller-owned RAM ring in a
+ * compact form, for export (flash, UART, file) and offline replay
+ * (tools/evt_replay).
+ *
+ * Record layout (bytes):
+ *   [0]   id                 1..EVT__MAX-1 (0x00 / 0xFF never valid)
+ *   [1]   src | 0x80 if a payload follows
+ *   [2..] ts delta           zigzag varint of (ts_ms - previous ts_ms), 1..5
+ *   [..]  len, payload[len]  only if len > 0
+ *
+ * POLICY:
+ * - Full ring: the oldest records are dropped (counted); the dump header
+ *   carries the timestamp the oldest kept record is relative to
+ * - Cost per event: one encode into a stack buffer + at most two copies;
+ *   at most EVT_JOURNAL_REC_MAX bytes
+ * - evt_journal_export() holds the lock while writing: call it from the
+ *   dispatch context or with a RAM/fast writer
+ * ========================================================================== */
+
+#define EVT_JOURNAL_MAGIC   0x314A5645u  /* "EVJ1" */
+#define EVT_JOURNAL_VERSION 1u
+
+#define EVT_JOURNAL_F_PAYLOAD 0x80u
+#define EVT_JOURNAL_SRC_MASK  0x3Fu
+
+#define EVT_JOURNAL_REC_MAX (2u + 5u + 1u + OS_EVT_INLINE_MAX)
+
+/* Dump header (little-endian), followed by `bytes` of records, oldest first */
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t hdr_len;      /* sizeof(evt_journal_hdr_t) */
+  uint32_t base_ts_ms;   /* the first record's delta is relative to this */
+  uint32_t bytes;
+  uint32_t records;
+  uint32_t dropped;      /* records overwritten before this dump */
+} evt_journal_hdr_t;
+
+/* Export sink: OS_OK or the error is returned by evt_journal_export() */
+typedef os_err_t (*evt_journal_write_fn_t)(const void *data, uint32_t len, void *ctx);
+
+typedef struct {
+  uint8_t  *buf;        /* ring storage, caller-owned (static) */
+  uint32_t  cap;        /* >= EVT_JOURNAL_REC_MAX */
+  void    (*lock)(void *ctx);    /* optional: export from another task */
+  void    (*unlock)(void *ctx);
+  void     *ctx;
+} evt_journal_config_t;
+
+typedef struct {
+  uint32_t records;     /* appended since init/clear */
+  uint32_t kept;        /* records currently in the ring */
+  uint32_t dropped;     /* overwritten by newer records */
+  uint32_t rejected;    /* invalid events */
+  uint32_t bytes_used;
+  uint64_t bytes_total; /* encoded bytes appended; / records = bytes per event */
+} evt_journal_stats_t;
+
+os_err_t evt_journal_init(const evt_journal_config_t *cfg);
+os_err_t evt_journal_append(const os_evt_t *evt);
+
+/* evt_bus_trace_fn_t compatible */
+void evt_journal_trace(const os_evt_t *evt, void *trace_ctx);
+
+/* Header, then the records in at most two chunks */
+os_err_t evt_journal_export(evt_journal_write_fn_t write, void *ctx);
+uint32_t evt_journal_export_size(void);
+
+void evt_journal_clear(void);
+void evt_journal_get_stats(evt_journal_stats_t *out);
+
+/* ---- Decoding (device or host) ----------------------------------------- */
+
+typedef struct {
+  const uint8_t *p;
+  uint32_t       len;
+  uint32_t       pos;
+  uint32_t       ts_ms;
+} evt_journal_reader_t;
+
+/* Validates a dump; *records points at the first record */
+os_err_t evt_journal_parse(const void *dump, uint32_t len, evt_journal_hdr_t *hdr, const uint8_t **records);
+
+void evt_journal_reader_init(evt_journal_reader_t *rd, const evt_journal_hdr_t *hdr, const uint8_t *records);
+
+/* OS_OK with *out filled, OS_ESTATE at the end, OS_ECRC on a malformed record */
+os_err_t evt_journal_next(evt_journal_reader_t *rd, os_evt_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVT_JOURNAL_H */
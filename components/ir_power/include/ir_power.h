@@ -0,0 +1,124 @@
+#ifndef IR_POWER_H
+#define IR_POWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "retrofit_os_types.h"
+#include "orchestrator.h"
+#include "scheduler.h"
+
+/* ==========================================================================
+ * IR peripheral power gating with schedule pre-warm (platform-agnostic)
+ *
+ * FR-13: the RMT RX/TX channels are on only while something needs them.
+ * Switching a channel on costs rmt_enable() plus an encoder reset, so a
+ * cold send starts late; scheduled sends get their TX channel switched on
+ * prewarm_s ahead of the deadline instead.
+ *
+ * POLICY:
+ * - A channel is on while it has a reason: an acquire() hold, RX learning
+ *   (orchestrator in ORCH_ST_PROGRAMMING, mode not PWR_SLEEP) or a TX
+ *   pre-warm for the next due schedule (state has ORCH_CAP_SCHED_RUN)
+ * - Without a reason it lingers linger_ms in PWR_ACTIVE, then goes off at
+ *   the next tick/acquire/release; in PWR_IDLE and PWR_SLEEP it goes off
+ *   at once
+ * - One pre-warm at a time (the scheduler heap head, sched_peek_next); it
+ *   is used by the next TX acquire, or wasted when the head changes, time
+ *   jumps or it is not used within claim_s of its deadline
+ * - Wake-to-first-edge is timed from acquire() to ir_power_mark_edge(),
+ *   split by whether the acquire found the channel off (cold) or on
+ * - Hardware calls run under the optional lock; no heap
+ * ========================================================================== */
+
+#ifndef IR_POWER_PREWARM_S
+#define IR_POWER_PREWARM_S 1u
+#endif
+
+#ifndef IR_POWER_LINGER_MS
+#define IR_POWER_LINGER_MS 250u
+#endif
+
+#ifndef IR_POWER_CLAIM_S
+#define IR_POWER_CLAIM_S 5u
+#endif
+
+typedef enum {
+  IR_PWR_RX = 0,
+  IR_PWR_TX,
+  IR_PWR_CH__MAX
+} ir_power_ch_t;
+
+/* The RMT channels */
+typedef struct {
+  os_err_t (*enable)(ir_power_ch_t ch, void *ctx);   /* rmt_enable() and whatever a cold channel needs */
+  os_err_t (*disable)(ir_power_ch_t ch, void *ctx);
+  uint64_t (*now_us)(void *ctx);                     /* monotonic: on-time and latency */
+  void     (*lock)(void *ctx);                       /* optional: callers on several tasks */
+  void     (*unlock)(void *ctx);
+  void      *ctx;
+} ir_power_hw_t;
+
+typedef struct {
+  ir_power_hw_t hw;
+  uint32_t      prewarm_s;  /* 0 = IR_POWER_PREWARM_S */
+  uint32_t      linger_ms;  /* 0 = IR_POWER_LINGER_MS */
+  uint32_t      claim_s;    /* 0 = IR_POWER_CLAIM_S */
+} ir_power_config_t;
+
+typedef struct {
+  uint32_t enables;
+  uint32_t disables;
+  uint32_t enable_errors;
+  uint32_t enable_us_max;     /* cost of the enable callback */
+  uint64_t on_us;             /* time on, including the current period */
+  uint32_t acquires;
+  uint32_t cold;              /* acquire() that had to switch the channel on */
+  uint32_t cold_edges;        /* wake-to-first-edge after a cold acquire */
+  uint32_t cold_edge_us_max;
+  uint64_t cold_edge_us_sum;
+  uint32_t warm_edges;        /* ... with the channel already on */
+  uint32_t warm_edge_us_max;
+  uint64_t warm_edge_us_sum;
+} ir_power_ch_stats_t;
+
+typedef struct {
+  ir_power_ch_stats_t ch[IR_PWR_CH__MAX];
+  uint32_t prewarms;
+  uint32_t prewarm_hits;      /* TX acquire that found a pre-warmed channel */
+  uint32_t prewarm_wasted;
+  uint64_t up_us;             /* since init / reset_stats: on_us / up_us is the duty cycle */
+} ir_power_stats_t;
+
+os_err_t ir_power_init(const ir_power_config_t *cfg);
+
+/* Hold a channel on (switching it on if needed) until the matching release */
+os_err_t ir_power_acquire(ir_power_ch_t ch);
+/* First edge out (TX: rmt_transmit() started) or receiver armed (RX) */
+void     ir_power_mark_edge(ir_power_ch_t ch);
+void     ir_power_release(ir_power_ch_t ch);
+
+/* Orchestrator state change (orch_state_cb_t): RX learning, pre-warm allowed */
+void     ir_power_set_orch(orch_state_t state, orch_caps_t caps);
+
+/* Pre-warm the next due schedule and expire lingering channels. Call after
+ * sched_process() and at the returned time (epoch s, SCHED_NO_DEADLINE if
+ * nothing is pending). */
+uint32_t ir_power_tick(uint32_t now_s);
+
+bool     ir_power_is_on(ir_power_ch_t ch);
+
+/* os_process_fn_t compatible: power mode, time jump, factory reset */
+os_err_t ir_power_process(const os_evt_t *evt);
+
+void ir_power_get_stats(ir_power_stats_t *out);
+void ir_power_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IR_POWER_H */
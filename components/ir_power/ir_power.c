@@ -0,0 +1,400 @@
+/* ir_power.c — switch the RMT channels on only while they are needed
+ *
+ * Each channel keeps a set of reasons to be on (hold, learn, pre-warm).
+ * irp_update() compares it with the channel state after every input and
+ * switches the channel on at once, or off after the linger time. The
+ * scheduler heap head drives the one TX pre-warm.
+ */
+
+#include <string.h>
+#include "ir_power.h"
+
+#define IRP_WANT_HOLD    0x01u  /* acquire() without release() */
+#define IRP_WANT_LEARN   0x02u  /* RX: orchestrator is programming a slot */
+#define IRP_WANT_PREWARM 0x04u  /* TX: a scheduled send is close */
+
+typedef struct {
+  uint8_t  on;
+  uint8_t  holds;
+  uint8_t  cold;           /* the acquire waiting for its edge found the channel off */
+  uint8_t  edge_pending;
+  uint64_t on_since_us;    /* on_us is accounted up to here */
+  uint64_t off_at_us;      /* end of the linger, 0 = not lingering */
+  uint64_t req_us;         /* acquire() time, for wake-to-first-edge */
+} irp_ch_t;
+
+typedef struct {
+  ir_power_config_t cfg;
+  irp_ch_t          ch[IR_PWR_CH__MAX];
+  os_power_mode_t   mode;
+  uint8_t           learn;        /* from the orchestrator state */
+  uint8_t           prewarm_ok;   /* state may run schedules */
+  uint8_t           prewarm;      /* TX pre-warmed for prewarm_id / prewarm_deadline */
+  uint8_t           done;         /* done_id / done_deadline was pre-warmed already */
+  uint8_t           ready;
+  uint32_t          prewarm_id;
+  uint32_t          prewarm_deadline;
+  uint32_t          done_id;
+  uint32_t          done_deadline;
+  uint64_t          stats_since_us;
+  ir_power_stats_t  stats;
+} irp_ctx_t;
+
+static irp_ctx_t s_irp;
+
+/* -------------------------------------------------------------------------- */
+/* Helpers                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static inline void irp_lock(void)
+{
+  if (s_irp.cfg.hw.lock) {
+    s_irp.cfg.hw.lock(s_irp.cfg.hw.ctx);
+  }
+}
+
+static inline void irp_unlock(void)
+{
+  if (s_irp.cfg.hw.unlock) {
+    s_irp.cfg.hw.unlock(s_irp.cfg.hw.ctx);
+  }
+}
+
+static inline uint64_t irp_now_us(void)
+{
+  return s_irp.cfg.hw.now_us(s_irp.cfg.hw.ctx);
+}
+
+static uint8_t irp_want(ir_power_ch_t ch)
+{
+  uint8_t want = s_irp.ch[ch].holds ? IRP_WANT_HOLD : 0u;
+  if (ch == IR_PWR_RX && s_irp.learn && s_irp.mode != PWR_SLEEP) {
+    want |= IRP_WANT_LEARN;
+  }
+  if (ch == IR_PWR_TX && s_irp.prewarm) {
+    want |= IRP_WANT_PREWARM;
+  }
+  return want;
+}
+
+static os_err_t irp_switch_on(ir_power_ch_t ch)
+{
+  irp_ch_t *c = &s_irp.ch[ch];
+  ir_power_ch_stats_t *st = &s_irp.stats.ch[ch];
+  uint64_t t0 = irp_now_us();
+  os_err_t err = s_irp.cfg.hw.enable(ch, s_irp.cfg.hw.ctx);
+  uint64_t t1 = irp_now_us();
+  if (err != OS_OK) {
+    st->enable_errors++;
+    return err;
+  }
+  if (t1 - t0 > st->enable_us_max) {
+    st->enable_us_max = (uint32_t)(t1 - t0);
+  }
+  st->enables++;
+  c->on = 1u;
+  c->on_since_us = t1;
+  return OS_OK;
+}
+
+static void irp_switch_off(ir_power_ch_t ch, uint64_t now)
+{
+  irp_ch_t *c = &s_irp.ch[ch];
+  if (s_irp.cfg.hw.disable(ch, s_irp.cfg.hw.ctx) != OS_OK) {
+    return;  /* still on; the next update retries */
+  }
+  s_irp.stats.ch[ch].on_us += now - c->on_since_us;
+  s_irp.stats.ch[ch].disables++;
+  c->on = 0u;
+  c->off_at_us = 0u;
+}
+
+/* Bring a channel in line with its reasons to be on */
+static os_err_t irp_update(ir_power_ch_t ch, uint64_t now)
+{
+  irp_ch_t *c = &s_irp.ch[ch];
+  if (irp_want(ch)) {
+    c->off_at_us = 0u;
+    return c->on ? OS_OK : irp_switch_on(ch);
+  }
+  if (!c->on) {
+    return OS_OK;
+  }
+  if (s_irp.mode == PWR_ACTIVE) {
+    if (!c->off_at_us) {
+      c->off_at_us = now + (uint64_t)s_irp.cfg.linger_ms * 1000u;
+    }
+    if (now < c->off_at_us) {
+      return OS_OK;
+    }
+  }
+  irp_switch_off(ch, now);
+  return OS_OK;
+}
+
+static void irp_drop_prewarm(void)
+{
+  if (s_irp.prewarm) {
+    s_irp.prewarm = 0u;
+    s_irp.stats.prewarm_wasted++;
+  }
+}
+
+static void irp_update_all(void)
+{
+  uint64_t now = irp_now_us();
+  for (int ch = 0; ch < IR_PWR_CH__MAX; ch++) {
+    (void)irp_update((ir_power_ch_t)ch, now);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+os_err_t ir_power_init(const ir_power_config_t *cfg)
+{
+  if (!cfg || !cfg->hw.enable || !cfg->hw.disable || !cfg->hw.now_us) {
+    return OS_EINVAL;
+  }
+  if (!!cfg->hw.lock != !!cfg->hw.unlock) {
+    return OS_EINVAL;
+  }
+  memset(&s_irp, 0, sizeof(s_irp));
+  s_irp.cfg = *cfg;
+  if (!s_irp.cfg.prewarm_s) {
+    s_irp.cfg.prewarm_s = IR_POWER_PREWARM_S;
+  }
+  if (!s_irp.cfg.linger_ms) {
+    s_irp.cfg.linger_ms = IR_POWER_LINGER_MS;
+  }
+  if (!s_irp.cfg.claim_s) {
+    s_irp.cfg.claim_s = IR_POWER_CLAIM_S;
+  }
+  s_irp.mode = PWR_ACTIVE;
+  s_irp.prewarm_ok = 1u;
+  s_irp.stats_since_us = irp_now_us();
+  s_irp.ready = 1u;
+  return OS_OK;
+}
+
+os_err_t ir_power_acquire(ir_power_ch_t ch)
+{
+  if ((unsigned)ch >= IR_PWR_CH__MAX) {
+    return OS_EINVAL;
+  }
+  if (!s_irp.ready) {
+    return OS_ESTATE;
+  }
+  irp_lock();
+  irp_ch_t *c = &s_irp.ch[ch];
+  if (c->holds == UINT8_MAX) {
+    irp_unlock();
+    return OS_EBUSY;
+  }
+  uint64_t now = irp_now_us();
+  uint8_t cold = !c->on;
+  if (ch == IR_PWR_TX && s_irp.prewarm) {
+    /* The hold takes over from the pre-warm */
+    s_irp.prewarm = 0u;
+    s_irp.stats.prewarm_hits++;
+  }
+  c->holds++;
+  os_err_t err = irp_update(ch, now);
+  if (err != OS_OK) {
+    c->holds--;
+    irp_unlock();
+    return err;
+  }
+  s_irp.stats.ch[ch].acquires++;
+  if (cold) {
+    s_irp.stats.ch[ch].cold++;
+  }
+  c->cold = cold;
+  c->req_us = now;
+  c->edge_pending = 1u;
+  irp_unlock();
+  return OS_OK;
+}
+
+void ir_power_mark_edge(ir_power_ch_t ch)
+{
+  if ((unsigned)ch >= IR_PWR_CH__MAX || !s_irp.ready) {
+    return;
+  }
+  irp_lock();
+  irp_ch_t *c = &s_irp.ch[ch];
+  if (c->edge_pending) {
+    ir_power_ch_stats_t *st = &s_irp.stats.ch[ch];
+    uint32_t dt = (uint32_t)(irp_now_us() - c->req_us);
+    if (c->cold) {
+      st->cold_edges++;
+      st->cold_edge_us_sum += dt;
+      if (dt > st->cold_edge_us_max) {
+        st->cold_edge_us_max = dt;
+      }
+    } else {
+      st->warm_edges++;
+      st->warm_edge_us_sum += dt;
+      if (dt > st->warm_edge_us_max) {
+        st->warm_edge_us_max = dt;
+      }
+    }
+    c->edge_pending = 0u;
+  }
+  irp_unlock();
+}
+
+void ir_power_release(ir_power_ch_t ch)
+{
+  if ((unsigned)ch >= IR_PWR_CH__MAX || !s_irp.ready) {
+    return;
+  }
+  irp_lock();
+  irp_ch_t *c = &s_irp.ch[ch];
+  if (c->holds) {
+    c->holds--;
+    c->edge_pending = 0u;
+    (void)irp_update(ch, irp_now_us());
+  }
+  irp_unlock();
+}
+
+void ir_power_set_orch(orch_state_t state, orch_caps_t caps)
+{
+  if (!s_irp.ready) {
+    return;
+  }
+  irp_lock();
+  s_irp.learn = (state == ORCH_ST_PROGRAMMING);
+  s_irp.prewarm_ok = (caps & ORCH_CAP_SCHED_RUN) != 0u;
+  if (!s_irp.prewarm_ok) {
+    irp_drop_prewarm();
+  }
+  irp_update_all();
+  irp_unlock();
+}
+
+uint32_t ir_power_tick(uint32_t now_s)
+{
+  uint32_t next = SCHED_NO_DEADLINE;
+  sched_entry_t head;
+  uint32_t deadline;
+
+  if (!s_irp.ready) {
+    return next;
+  }
+  irp_lock();
+
+  /* Fired but never sent (gated out, event dropped) */
+  if (s_irp.prewarm && s_irp.prewarm_deadline <= now_s && now_s - s_irp.prewarm_deadline > s_irp.cfg.claim_s) {
+    irp_drop_prewarm();
+  }
+
+  if (s_irp.prewarm_ok && sched_peek_next(&head, &deadline) == OS_OK) {
+    if (s_irp.prewarm && s_irp.prewarm_deadline > now_s &&
+        (s_irp.prewarm_id != head.id || s_irp.prewarm_deadline != deadline)) {
+      /* The table changed under a pre-warm that is not due yet */
+      irp_drop_prewarm();
+    }
+    if (!s_irp.prewarm && !(s_irp.done && s_irp.done_id == head.id && s_irp.done_deadline == deadline)) {
+      if (deadline > now_s && deadline - now_s > s_irp.cfg.prewarm_s) {
+        next = deadline - s_irp.cfg.prewarm_s;
+      } else {
+        s_irp.prewarm = 1u;
+        s_irp.prewarm_id = head.id;
+        s_irp.prewarm_deadline = deadline;
+        s_irp.done = 1u;
+        s_irp.done_id = head.id;
+        s_irp.done_deadline = deadline;
+        s_irp.stats.prewarms++;
+      }
+    }
+  }
+  if (s_irp.prewarm) {
+    uint32_t expiry = (s_irp.prewarm_deadline > now_s ? s_irp.prewarm_deadline : now_s) + s_irp.cfg.claim_s + 1u;
+    if (expiry < next) {
+      next = expiry;
+    }
+  }
+
+  uint64_t now = irp_now_us();
+  for (int ch = 0; ch < IR_PWR_CH__MAX; ch++) {
+    irp_ch_t *c = &s_irp.ch[ch];
+    (void)irp_update((ir_power_ch_t)ch, now);
+    if (c->on && c->off_at_us) {
+      /* Lingering: come back once it is over */
+      uint32_t wake = now_s + (uint32_t)((c->off_at_us - now + 999999u) / 1000000u);
+      if (wake < next) {
+        next = wake;
+      }
+    }
+  }
+  irp_unlock();
+  return next;
+}
+
+bool ir_power_is_on(ir_power_ch_t ch)
+{
+  return (unsigned)ch < IR_PWR_CH__MAX && s_irp.ch[ch].on;
+}
+
+os_err_t ir_power_process(const os_evt_t *evt)
+{
+  if (!evt) {
+    return OS_EINVAL;
+  }
+  switch (evt->id) {
+  case EVT_POWER_MODE_CHANGED: {
+    evt_power_mode_changed_t p;
+    if (evt->len < sizeof(p)) {
+      return OS_EINVAL;
+    }
+    memcpy(&p, evt->payload, sizeof(p));
+    irp_lock();
+    s_irp.mode = p.mode;
+    irp_update_all();
+    irp_unlock();
+    return OS_OK;
+  }
+  case EVT_TIME_JUMPED:
+  case EVT_FACTORY_RESET_DONE:
+    irp_lock();
+    irp_drop_prewarm();
+    s_irp.done = 0u;
+    irp_update_all();
+    irp_unlock();
+    return OS_OK;
+  default:
+    return OS_OK;
+  }
+}
+
+void ir_power_get_stats(ir_power_stats_t *out)
+{
+  if (!out) {
+    return;
+  }
+  irp_lock();
+  uint64_t now = irp_now_us();
+  *out = s_irp.stats;
+  out->up_us = now - s_irp.stats_since_us;
+  for (int ch = 0; ch < IR_PWR_CH__MAX; ch++) {
+    if (s_irp.ch[ch].on) {
+      out->ch[ch].on_us += now - s_irp.ch[ch].on_since_us;
+    }
+  }
+  irp_unlock();
+}
+
+void ir_power_reset_stats(void)
+{
+  irp_lock();
+  uint64_t now = irp_now_us();
+  memset(&s_irp.stats, 0, sizeof(s_irp.stats));
+  s_irp.stats_since_us = now;
+  for (int ch = 0; ch < IR_PWR_CH__MAX; ch++) {
+    s_irp.ch[ch].on_since_us = now;
+  }
+  irp_unlock();
+}
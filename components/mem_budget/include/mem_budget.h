@@ -0,0 +1,56 @@
+#ifndef MEM_BUDGET_H
+#define MEM_BUDGET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Runtime memory budget report (FreeRTOS / ESP-IDF)
+ *
+ * Complements the build-time report of tools/mem_report (static RAM per
+ * module from the linker map): tracked tasks report their configured stack
+ * and the peak actually used, and the heap reports its low-water mark and
+ * largest free block so fragmentation shows up before it bites.
+ *
+ * POLICY:
+ * - Tasks are tracked by name (xTaskGetHandle) so owners need no hooks;
+ *   a task that has exited is reported as such
+ * - Report lines are prefixed "STACK" / "HEAP" so tools/mem_report can
+ *   merge a captured log with the linker map
+ * ========================================================================== */
+
+#ifndef MEM_BUDGET_MAX_TASKS
+#define MEM_BUDGET_MAX_TASKS 12u
+#endif
+
+typedef struct {
+  const char *name;
+  uint32_t    stack_bytes;   /* configured */
+  uint32_t    peak_bytes;    /* stack_bytes - high-water mark; 0 if not running */
+  uint8_t     running;
+} mem_budget_task_t;
+
+typedef struct {
+  uint32_t free_bytes;
+  uint32_t min_free_bytes;   /* low-water mark since boot */
+  uint32_t largest_block;    /* largest allocatable block (fragmentation) */
+} mem_budget_heap_t;
+
+/* name must stay valid (string literal); OS_EFULL past MEM_BUDGET_MAX_TASKS */
+os_err_t mem_budget_track_task(const char *name, uint32_t stack_bytes);
+
+/* Fills up to max entries, returns the number tracked */
+uint32_t mem_budget_get_tasks(mem_budget_task_t *out, uint32_t max);
+void     mem_budget_get_heap(mem_budget_heap_t *out);
+
+void mem_budget_log_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MEM_BUDGET_H */
@@ -0,0 +1,91 @@
+/* mem_budget.c — per-task peak stack and heap fragmentation report */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "mem_budget.h"
+
+static const char *TAG = "MEM_BUDGET";
+
+typedef struct {
+  const char *name;
+  uint32_t    stack_bytes;
+} mem_budget_entry_t;
+
+static mem_budget_entry_t s_tasks[MEM_BUDGET_MAX_TASKS];
+static uint32_t           s_task_count;
+static portMUX_TYPE       s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+os_err_t mem_budget_track_task(const char *name, uint32_t stack_bytes)
+{
+  if (!name || !stack_bytes) {
+    return OS_EINVAL;
+  }
+  os_err_t err = OS_EFULL;
+  portENTER_CRITICAL(&s_lock);
+  for (uint32_t i = 0; i < s_task_count; i++) {
+    if (strcmp(s_tasks[i].name, name) == 0) {
+      s_tasks[i].stack_bytes = stack_bytes;
+      err = OS_OK;
+      break;
+    }
+  }
+  if (err != OS_OK && s_task_count < MEM_BUDGET_MAX_TASKS) {
+    s_tasks[s_task_count++] = (mem_budget_entry_t) { .name = name, .stack_bytes = stack_bytes };
+    err = OS_OK;
+  }
+  portEXIT_CRITICAL(&s_lock);
+  return err;
+}
+
+uint32_t mem_budget_get_tasks(mem_budget_task_t *out, uint32_t max)
+{
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < s_task_count && out && n < max; i++, n++) {
+    mem_budget_task_t *t = &out[n];
+    t->name = s_tasks[i].name;
+    t->stack_bytes = s_tasks[i].stack_bytes;
+    t->peak_bytes = 0u;
+    t->running = 0u;
+
+    TaskHandle_t h = xTaskGetHandle(s_tasks[i].name);
+    if (h) {
+      /* ESP-IDF reports the high-water mark in bytes */
+      uint32_t unused = (uint32_t)uxTaskGetStackHighWaterMark(h);
+      t->peak_bytes = (unused < t->stack_bytes) ? t->stack_bytes - unused : 0u;
+      t->running = 1u;
+    }
+  }
+  return s_task_count;
+}
+
+void mem_budget_get_heap(mem_budget_heap_t *out)
+{
+  if (!out) {
+    return;
+  }
+  out->free_bytes = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  out->min_free_bytes = (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  out->largest_block = (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+}
+
+void mem_budget_log_report(void)
+{
+  mem_budget_task_t tasks[MEM_BUDGET_MAX_TASKS];
+  uint32_t n = mem_budget_get_tasks(tasks, MEM_BUDGET_MAX_TASKS);
+  for (uint32_t i = 0; i < n && i < MEM_BUDGET_MAX_TASKS; i++) {
+    if (!tasks[i].running) {
+      ESP_LOGI(TAG, "STACK %s size=%u exited", tasks[i].name, (unsigned)tasks[i].stack_bytes);
+      continue;
+    }
+    ESP_LOGI(TAG, "STACK %s size=%u peak=%u headroom=%u%s", tasks[i].name, (unsigned)tasks[i].stack_bytes,
+             (unsigned)tasks[i].peak_bytes, (unsigned)(tasks[i].stack_bytes - tasks[i].peak_bytes),
+             (tasks[i].peak_bytes * 8u > tasks[i].stack_bytes * 7u) ? " LOW" : "");
+  }
+  mem_budget_heap_t h;
+  mem_budget_get_heap(&h);
+  ESP_LOGI(TAG, "HEAP free=%u min_free=%u largest_block=%u", (unsigned)h.free_bytes,
+           (unsigned)h.min_free_bytes, (unsigned)h.largest_block);
+}
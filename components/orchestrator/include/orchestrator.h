@@ -0,0 +1,94 @@
+#ifndef ORCHESTRATOR_H
+#define ORCHESTRATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Orchestrator FSM (platform-agnostic)
+ *
+ * - Transitions: constant state x event table (static coverage check)
+ * - Gating: per-state capability bitmask; a command or event is accepted
+ *   iff (caps[state] & required) == required — one lookup, no branching
+ *   on state in handlers
+ * - Rejections are published as EVT_CMD_REJECTED (os_cmd_reject_reason_t)
+ * ========================================================================== */
+
+typedef enum {
+  ORCH_ST_UNAUTH = 0,
+  ORCH_ST_NORMAL,
+  ORCH_ST_PROGRAMMING,
+  ORCH_ST_UPDATING,
+  ORCH_ST__MAX
+} orch_state_t;
+
+/* Capabilities (bit per capability) */
+typedef uint16_t orch_caps_t;
+
+#define ORCH_CAP_STATUS        (1u << 0) /* read status */
+#define ORCH_CAP_AUTH          (1u << 1) /* submit credentials */
+#define ORCH_CAP_IR_SEND       (1u << 2) /* send a slot on demand */
+#define ORCH_CAP_PROGRAM       (1u << 3) /* enter programming / write or erase slots */
+#define ORCH_CAP_PROGRAM_ABORT (1u << 4) /* leave programming mode */
+#define ORCH_CAP_SCHED_EDIT    (1u << 5) /* modify the schedule table */
+#define ORCH_CAP_SCHED_RUN     (1u << 6) /* execute due schedules */
+#define ORCH_CAP_FACTORY_RESET (1u << 7)
+#define ORCH_CAP_OTA           (1u << 8) /* start a firmware update */
+
+/* Commands reaching the orchestrator through the CMD service */
+typedef enum {
+  ORCH_CMD_GET_STATUS = 0,
+  ORCH_CMD_AUTH,
+  ORCH_CMD_SEND_SLOT,
+  ORCH_CMD_PROGRAM_SLOT,
+  ORCH_CMD_ERASE_SLOT,
+  ORCH_CMD_ABORT_PROGRAM,
+  ORCH_CMD_SCHEDULE_UPDATE,
+  ORCH_CMD_FACTORY_RESET,
+  ORCH_CMD_OTA_START,
+  ORCH_CMD__MAX
+} orch_cmd_id_t;
+
+/* Publish hook (event bus or mock); the orchestrator publishes as OS_MOD_ORCH */
+typedef void (*orch_publish_fn_t)(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len);
+
+/* Optional state change notification */
+typedef void (*orch_state_cb_t)(orch_state_t from, orch_state_t to, void *user_ctx);
+
+typedef struct {
+  orch_publish_fn_t publish;
+  orch_state_cb_t   on_state_changed;
+  void             *user_ctx;
+} orch_config_t;
+
+typedef struct {
+  uint32_t events;      /* events processed */
+  uint32_t commands;    /* commands submitted */
+  uint32_t rejected;    /* events + commands rejected by capability gating */
+  uint32_t transitions;
+} orch_stats_t;
+
+os_err_t orch_init(const orch_config_t *cfg);
+
+/* os_process_fn_t compatible. Returns OS_EPERM if gated out in this state. */
+os_err_t orch_process(const os_evt_t *evt);
+
+/* Gate and apply a command. Returns OS_EPERM (and publishes EVT_CMD_REJECTED)
+ * if the current state lacks the required capability. */
+os_err_t orch_submit_cmd(orch_cmd_id_t cmd);
+
+orch_state_t orch_get_state(void);
+orch_caps_t  orch_get_caps(void);
+const char  *orch_state_name(orch_state_t st);
+
+void orch_get_stats(orch_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ORCHESTRATOR_H */
@@ -0,0 +1,279 @@
+/* orchestrator.c — table-driven system FSM with capability gating
+ *
+ * Everything the FSM knows lives in three constant tables:
+ * - ORCH_EVT_TABLE: per event, required capability + transition per state
+ * - ORCH_CMD_TABLE: per command, required capability + target state
+ * - s_state_caps:   per state, capability bitmask
+ */
+
+#include <string.h>
+#include "orchestrator.h"
+
+/* -------------------------------------------------------------------------- */
+/* Transition cell encoding (uint8_t)                                         */
+/*   [2:0] next state (ORCH_NEXT_SAME = no transition)                        */
+/*   [5:4] guard evaluated on the event payload                               */
+/* -------------------------------------------------------------------------- */
+
+#define ORCH_NEXT_SAME      0x7u
+#define ORCH_NEXT_MASK      0x7u
+#define ORCH_GUARD_SHIFT    4u
+
+enum {
+  G_NONE = 0,
+  G_AUTHED,      /* evt_auth_state_changed_t.authed != 0 */
+  G_UNAUTHED,    /* evt_auth_state_changed_t.authed == 0 */
+  G_IR_FAIL,     /* evt_ir_learn_result_t.result != IR_RES_OK */
+};
+
+#define STAY            ((uint8_t)ORCH_NEXT_SAME)
+#define TO(st)          ((uint8_t)(st))
+#define TO_IF(st, g)    ((uint8_t)((st) | ((g) << ORCH_GUARD_SHIFT)))
+
+#define UNAUTH          ORCH_ST_UNAUTH
+#define NORMAL          ORCH_ST_NORMAL
+#define PROGRAMMING     ORCH_ST_PROGRAMMING
+#define UPDATING        ORCH_ST_UPDATING
+
+/* -------------------------------------------------------------------------- */
+/* Event table: one row per os_event_id_t, in enum order                      */
+/* -------------------------------------------------------------------------- */
+
+/*  event                        required cap          UNAUTH                   NORMAL                      PROGRAMMING                  UPDATING */
+#define ORCH_EVT_TABLE(X) \
+  X(EVT_NONE,                    0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_AUTH_STATE_CHANGED,      0,                    TO_IF(NORMAL, G_AUTHED), TO_IF(UNAUTH, G_UNAUTHED),  TO_IF(UNAUTH, G_UNAUTHED),   STAY)          \
+  X(EVT_BLE_CONN_CHANGED,        0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_BLE_SEC_CHANGED,         0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_WIFI_STATE_CHANGED,      0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_MQTT_STATE_CHANGED,      0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_TIME_SYNCED,             0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_TIME_JUMPED,             0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_SCHEDULE_TABLE_UPDATED,  0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_SCHEDULE_DUE,            ORCH_CAP_SCHED_RUN,   STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_IR_LEARN_STARTED,        0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_IR_LEARN_RESULT,         0,                    STAY,                    STAY,                       TO_IF(NORMAL, G_IR_FAIL),    STAY)          \
+  X(EVT_IR_SLOT_WRITTEN,         0,                    STAY,                    STAY,                       TO(NORMAL),                  STAY)          \
+  X(EVT_IR_SEND_STARTED,         0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_IR_SEND_RESULT,          0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_STORAGE_CORRUPT,         0,                    STAY,                    STAY,                       TO(NORMAL),                  STAY)          \
+  X(EVT_STORAGE_FULL,            0,                    STAY,                    STAY,                       TO(NORMAL),                  STAY)          \
+  X(EVT_FACTORY_RESET_DONE,      0,                    STAY,                    TO(UNAUTH),                 TO(UNAUTH),                  STAY)          \
+  X(EVT_POWER_MODE_CHANGED,      0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_BATTERY_STATE,           0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_OTA_AVAILABLE,           0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_OTA_START,               ORCH_CAP_OTA,         STAY,                    TO(UPDATING),               STAY,                        STAY)          \
+  X(EVT_OTA_PROGRESS,            0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_OTA_DONE,                0,                    STAY,                    STAY,                       STAY,                        TO(NORMAL))    \
+  X(EVT_CMD_REJECTED,            0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_WATCHDOG_WARNING,        0,                    STAY,                    STAY,                       STAY,                        STAY)          \
+  X(EVT_HEALTH_TICK,             0,                    STAY,                    STAY,                       STAY,                        STAY)
+
+/* -------------------------------------------------------------------------- */
+/* Command table: one row per orch_cmd_id_t, in enum order                    */
+/* -------------------------------------------------------------------------- */
+
+/*  command                      required cap             target */
+#define ORCH_CMD_TABLE(X) \
+  X(ORCH_CMD_GET_STATUS,         ORCH_CAP_STATUS,         STAY)               \
+  X(ORCH_CMD_AUTH,               ORCH_CAP_AUTH,           STAY)               \
+  X(ORCH_CMD_SEND_SLOT,          ORCH_CAP_IR_SEND,        STAY)               \
+  X(ORCH_CMD_PROGRAM_SLOT,       ORCH_CAP_PROGRAM,        TO(PROGRAMMING))    \
+  X(ORCH_CMD_ERASE_SLOT,         ORCH_CAP_PROGRAM,        STAY)               \
+  X(ORCH_CMD_ABORT_PROGRAM,      ORCH_CAP_PROGRAM_ABORT,  TO(NORMAL))         \
+  X(ORCH_CMD_SCHEDULE_UPDATE,    ORCH_CAP_SCHED_EDIT,     STAY)               \
+  X(ORCH_CMD_FACTORY_RESET,      ORCH_CAP_FACTORY_RESET,  STAY)               \
+  X(ORCH_CMD_OTA_START,          ORCH_CAP_OTA,            STAY)
+
+/* -------------------------------------------------------------------------- */
+/* Static coverage checks: every event/command has exactly one row, in order  */
+/* -------------------------------------------------------------------------- */
+
+#define ORCH_EVT_POS(evt, cap, s0, s1, s2, s3)  ORCH_POS_##evt,
+#define ORCH_CMD_POS(cmd, cap, target)          ORCH_POS_##cmd,
+enum { ORCH_EVT_TABLE(ORCH_EVT_POS) ORCH_EVT_ROWS };
+enum { ORCH_CMD_TABLE(ORCH_CMD_POS) ORCH_CMD_ROWS };
+
+#define ORCH_EVT_ORDER(evt, cap, s0, s1, s2, s3) \
+  _Static_assert((int)ORCH_POS_##evt == (int)(evt), "ORCH_EVT_TABLE row out of order: " #evt);
+#define ORCH_CMD_ORDER(cmd, cap, target) \
+  _Static_assert((int)ORCH_POS_##cmd == (int)(cmd), "ORCH_CMD_TABLE row out of order: " #cmd);
+ORCH_EVT_TABLE(ORCH_EVT_ORDER)
+ORCH_CMD_TABLE(ORCH_CMD_ORDER)
+
+_Static_assert((int)ORCH_EVT_ROWS == (int)EVT__MAX, "ORCH_EVT_TABLE must cover every os_event_id_t");
+_Static_assert((int)ORCH_CMD_ROWS == (int)ORCH_CMD__MAX, "ORCH_CMD_TABLE must cover every orch_cmd_id_t");
+_Static_assert(ORCH_ST__MAX == 4, "ORCH_EVT_TABLE has one column per orch_state_t");
+_Static_assert(ORCH_ST__MAX <= ORCH_NEXT_SAME, "state must fit the transition cell");
+
+/* -------------------------------------------------------------------------- */
+/* Generated tables                                                           */
+/* -------------------------------------------------------------------------- */
+
+#define ORCH_EVT_COL0(evt, cap, s0, s1, s2, s3) s0,
+#define ORCH_EVT_COL1(evt, cap, s0, s1, s2, s3) s1,
+#define ORCH_EVT_COL2(evt, cap, s0, s1, s2, s3) s2,
+#define ORCH_EVT_COL3(evt, cap, s0, s1, s2, s3) s3,
+#define ORCH_EVT_CAP(evt, cap, s0, s1, s2, s3)  (orch_caps_t)(cap),
+#define ORCH_CMD_CAP(cmd, cap, target)          (orch_caps_t)(cap),
+#define ORCH_CMD_TARGET(cmd, cap, target)       target,
+
+static const uint8_t s_evt_next[ORCH_ST__MAX][EVT__MAX] = {
+  [ORCH_ST_UNAUTH]      = { ORCH_EVT_TABLE(ORCH_EVT_COL0) },
+  [ORCH_ST_NORMAL]      = { ORCH_EVT_TABLE(ORCH_EVT_COL1) },
+  [ORCH_ST_PROGRAMMING] = { ORCH_EVT_TABLE(ORCH_EVT_COL2) },
+  [ORCH_ST_UPDATING]    = { ORCH_EVT_TABLE(ORCH_EVT_COL3) },
+};
+
+static const orch_caps_t s_evt_caps[EVT__MAX] = { ORCH_EVT_TABLE(ORCH_EVT_CAP) };
+static const orch_caps_t s_cmd_caps[ORCH_CMD__MAX] = { ORCH_CMD_TABLE(ORCH_CMD_CAP) };
+static const uint8_t s_cmd_next[ORCH_CMD__MAX] = { ORCH_CMD_TABLE(ORCH_CMD_TARGET) };
+
+static const orch_caps_t s_state_caps[ORCH_ST__MAX] = {
+  [ORCH_ST_UNAUTH]      = ORCH_CAP_STATUS | ORCH_CAP_AUTH | ORCH_CAP_SCHED_RUN,
+  [ORCH_ST_NORMAL]      = ORCH_CAP_STATUS | ORCH_CAP_AUTH | ORCH_CAP_IR_SEND | ORCH_CAP_PROGRAM |
+                          ORCH_CAP_SCHED_EDIT | ORCH_CAP_SCHED_RUN | ORCH_CAP_FACTORY_RESET | ORCH_CAP_OTA,
+  [ORCH_ST_PROGRAMMING] = ORCH_CAP_STATUS | ORCH_CAP_PROGRAM | ORCH_CAP_PROGRAM_ABORT,
+  [ORCH_ST_UPDATING]    = ORCH_CAP_STATUS,
+};
+
+/* Why a capability is missing, per state */
+static const uint8_t s_reject_reason[ORCH_ST__MAX] = {
+  [ORCH_ST_UNAUTH]      = CMD_REJ_AUTH,
+  [ORCH_ST_NORMAL]      = CMD_REJ_STATE,
+  [ORCH_ST_PROGRAMMING] = CMD_REJ_BUSY,
+  [ORCH_ST_UPDATING]    = CMD_REJ_BUSY,
+};
+
+/* -------------------------------------------------------------------------- */
+/* Runtime                                                                    */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  orch_config_t cfg;
+  orch_state_t  state;
+  orch_stats_t  stats;
+} orch_ctx_t;
+
+static orch_ctx_t s_orch;
+
+static void orch_reject(void)
+{
+  evt_cmd_rejected_t p = { .reason = (os_cmd_reject_reason_t)s_reject_reason[s_orch.state] };
+  s_orch.stats.rejected++;
+  if (s_orch.cfg.publish) {
+    s_orch.cfg.publish(OS_MOD_ORCH, EVT_CMD_REJECTED, &p, sizeof(p));
+  }
+}
+
+static void orch_enter(uint8_t next)
+{
+  if (next == ORCH_NEXT_SAME || next == (uint8_t)s_orch.state) {
+    return;
+  }
+  orch_state_t from = s_orch.state;
+  s_orch.state = (orch_state_t)next;
+  s_orch.stats.transitions++;
+  if (s_orch.cfg.on_state_changed) {
+    s_orch.cfg.on_state_changed(from, s_orch.state, s_orch.cfg.user_ctx);
+  }
+}
+
+static int orch_guard_ok(uint8_t guard, const os_evt_t *evt)
+{
+  switch (guard) {
+    case G_AUTHED:
+    case G_UNAUTHED: {
+      if (evt->len < sizeof(evt_auth_state_changed_t)) {
+        return 0;
+      }
+      uint8_t authed = ((const evt_auth_state_changed_t *)evt->payload)->authed;
+      return (guard == G_AUTHED) ? (authed != 0u) : (authed == 0u);
+    }
+    case G_IR_FAIL: {
+      evt_ir_learn_result_t p;
+      if (evt->len < sizeof(p)) {
+        return 0;
+      }
+      memcpy(&p, evt->payload, sizeof(p));
+      return p.result != IR_RES_OK;
+    }
+    default:
+      return 1;
+  }
+}
+
+os_err_t orch_init(const orch_config_t *cfg)
+{
+  memset(&s_orch, 0, sizeof(s_orch));
+  if (cfg) {
+    s_orch.cfg = *cfg;
+  }
+  s_orch.state = ORCH_ST_UNAUTH;
+  return OS_OK;
+}
+
+os_err_t orch_process(const os_evt_t *evt)
+{
+  if (!evt || evt->id >= EVT__MAX) {
+    return OS_EINVAL;
+  }
+  s_orch.stats.events++;
+
+  orch_caps_t need = s_evt_caps[evt->id];
+  if ((s_state_caps[s_orch.state] & need) != need) {
+    orch_reject();
+    return OS_EPERM;
+  }
+
+  uint8_t cell = s_evt_next[s_orch.state][evt->id];
+  uint8_t guard = (uint8_t)(cell >> ORCH_GUARD_SHIFT);
+  if (guard == G_NONE || orch_guard_ok(guard, evt)) {
+    orch_enter(cell & ORCH_NEXT_MASK);
+  }
+  return OS_OK;
+}
+
+os_err_t orch_submit_cmd(orch_cmd_id_t cmd)
+{
+  if ((unsigned)cmd >= ORCH_CMD__MAX) {
+    return OS_EINVAL;
+  }
+  s_orch.stats.commands++;
+
+  orch_caps_t need = s_cmd_caps[cmd];
+  if ((s_state_caps[s_orch.state] & need) != need) {
+    orch_reject();
+    return OS_EPERM;
+  }
+  orch_enter(s_cmd_next[cmd]);
+  return OS_OK;
+}
+
+orch_state_t orch_get_state(void)
+{
+  return s_orch.state;
+}
+
+orch_caps_t orch_get_caps(void)
+{
+  return s_state_caps[s_orch.state];
+}
+
+const char *orch_state_name(orch_state_t st)
+{
+  static const char *const names[ORCH_ST__MAX] = {
+    [ORCH_ST_UNAUTH]      = "UNAUTH",
+    [ORCH_ST_NORMAL]      = "NORMAL",
+    [ORCH_ST_PROGRAMMING] = "PROGRAMMING",
+    [ORCH_ST_UPDATING]    = "UPDATING",
+  };
+  return ((unsigned)st < ORCH_ST__MAX) ? names[st] : "?";
+}
+
+void orch_get_stats(orch_stats_t *out)
+{
+  if (out) {
+    *out = s_orch.stats;
+  }
+}
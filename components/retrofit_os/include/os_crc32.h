@@ -0,0 +1,51 @@
+#ifndef OS_CRC32_H
+#define OS_CRC32_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* ==========================================================================
+ * CRC-32 (IEEE 802.3, reflected 0xEDB88320) — incremental, no heap
+ *
+ * Same value as zlib crc32() / esp_rom_crc32_le(): start from 0 and feed
+ * the result back in to continue, so a slot can be checksummed chunk by
+ * chunk while it is captured, copied or streamed.
+ *
+ * POLICY:
+ * - ESP targets use the ROM routine (OS_CRC32_USE_ROM=0 to force tables)
+ * - Elsewhere: slicing-by-4 tables (4 KiB const, in flash)
+ * - os_crc32_copy() folds the CRC into a copy the caller makes anyway,
+ *   so validation never needs a second pass over the data
+ * ========================================================================== */
+
+#ifndef OS_CRC32_USE_ROM
+#ifdef ESP_PLATFORM
+#define OS_CRC32_USE_ROM 1
+#else
+#define OS_CRC32_USE_ROM 0
+#endif
+#endif
+
+#define OS_CRC32_INIT 0u
+
+/* CRC of "123456789" */
+#define OS_CRC32_CHECK 0xCBF43926u
+
+uint32_t os_crc32_update(uint32_t crc, const void *data, size_t len);
+
+/* memcpy(dst, src, len) and return os_crc32_update(crc, src, len) */
+uint32_t os_crc32_copy(void *dst, const void *src, size_t len, uint32_t crc);
+
+/* Bytewise table reference and the portable slicing path (benchmarks, tests) */
+uint32_t os_crc32_update_bytewise(uint32_t crc, const void *data, size_t len);
+uint32_t os_crc32_update_sliced(uint32_t crc, const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OS_CRC32_H */
@@ -0,0 +1,85 @@
+#ifndef OS_SPSC_H
+#define OS_SPSC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Lock-free single-producer / single-consumer ring (C11 atomics, no heap)
+ *
+ * Hands fixed-size records from one task to another, typically across
+ * cores (IR capture on one core, the application on the other), without a
+ * lock or a critical section on either side.
+ *
+ * POLICY:
+ * - Exactly one producer task and one consumer task per ring; neither side
+ *   ever blocks or spins inside the ring (waking the consumer is the
+ *   caller's business, e.g. a task notification)
+ * - Capacity is a power of two; head and tail are free-running counters
+ * - Each index is published with release and read with acquire ordering;
+ *   each side caches the other's index and re-reads it only when the ring
+ *   looks full / empty, so steady traffic touches one shared line per call
+ * - Zero-copy: claim()/publish() and peek()/release() work in place;
+ *   push()/pop() are the copying form
+ * - A full ring rejects the record (OS_EFULL) and counts it; it never
+ *   overwrites unread data
+ * ========================================================================== */
+
+#ifndef OS_SPSC_LINE
+#define OS_SPSC_LINE 64u  /* keeps producer and consumer state on separate cache lines */
+#endif
+
+typedef struct {
+  /* Producer side */
+  _Alignas(OS_SPSC_LINE) _Atomic uint32_t head;
+  uint32_t         tail_cache;
+  uint32_t         pushed;
+  uint32_t         full;         /* claim() / push() calls that found the ring full */
+  /* Consumer side */
+  _Alignas(OS_SPSC_LINE) _Atomic uint32_t tail;
+  uint32_t         head_cache;
+  uint32_t         popped;
+  uint32_t         high_water;   /* depth seen each time the consumer re-reads head */
+  /* Read-only after init */
+  _Alignas(OS_SPSC_LINE) uint8_t *buf;
+  uint32_t         mask;
+  uint32_t         elem_size;
+} os_spsc_t;
+
+typedef struct {
+  uint32_t pushed;
+  uint32_t popped;
+  uint32_t full;
+  uint32_t high_water;
+  uint32_t depth;
+} os_spsc_stats_t;
+
+/* buf holds cap records of elem_size bytes; cap must be a power of two >= 2 */
+os_err_t os_spsc_init(os_spsc_t *q, void *buf, uint32_t elem_size, uint32_t cap);
+
+/* Producer: next free record (NULL if full), then publish it */
+void    *os_spsc_claim(os_spsc_t *q);
+void     os_spsc_publish(os_spsc_t *q);
+os_err_t os_spsc_push(os_spsc_t *q, const void *item);   /* OS_EFULL if full */
+
+/* Consumer: oldest record (NULL if empty), then release it */
+void    *os_spsc_peek(os_spsc_t *q);
+void     os_spsc_release(os_spsc_t *q);
+os_err_t os_spsc_pop(os_spsc_t *q, void *item);          /* OS_EINVAL if empty */
+
+/* Records queued right now; exact from either side, a snapshot elsewhere */
+uint32_t os_spsc_depth(const os_spsc_t *q);
+
+void os_spsc_get_stats(const os_spsc_t *q, os_spsc_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OS_SPSC_H */
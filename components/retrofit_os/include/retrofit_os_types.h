@@ -49,9 +49,29 @@ typedef enum {
   OS_MOD_OTA,
   OS_MOD_CMD,
   OS_MOD_MONITOR,
+  OS_MOD_EVT_BUS,
+  OS_MOD_ERRMGR,
   OS_MOD_MAX
 } os_module_id_t;
 
+/* ==========================================================================
+ * Task placement (dual-core ESP32-S3)
+ *
+ * POLICY:
+ * - Core 0 runs the Wi-Fi/BLE stacks, so comms and event dispatch stay there
+ * - IR capture and decode get the other core, away from radio bursts;
+ *   single-core targets put everything on core 0
+ * - Cross-core hand-off goes through os_spsc rings, not shared locks
+ * ========================================================================== */
+
+#ifndef OS_CORE_APP
+#define OS_CORE_APP 0
+#endif
+
+#ifndef OS_CORE_IR
+#define OS_CORE_IR ((portNUM_PROCESSORS > 1) ? 1 : 0)  /* expanded where FreeRTOS is included */
+#endif
+
 /* ==========================================================================
  * Global Event IDs (from EVT table)
  * NOTE: Once you ship logs/protocols, treat enum ordering as ABI-stable.
@@ -144,6 +164,8 @@ typedef struct {
  * Minimal payload structs (optional in Sprint 0; keep POD and <= INLINE_MAX)
  * ========================================================================== */
 
+typedef struct { uint8_t authed; } evt_auth_state_changed_t;
+
 typedef enum { OS_LINK_DOWN = 0, OS_LINK_UP = 1 } os_link_state_t;
 
 typedef struct { os_link_state_t state; } evt_ble_conn_changed_t;
@@ -174,6 +196,25 @@ typedef struct { os_power_mode_t mode; } evt_power_mode_changed_t;
 typedef enum { CMD_REJ_AUTH = 0, CMD_REJ_STATE = 1, CMD_REJ_PARAM = 2, CMD_REJ_BUSY = 3 } os_cmd_reject_reason_t;
 typedef struct { os_cmd_reject_reason_t reason; } evt_cmd_rejected_t;
 
+/* Raised by the event bus when a subscriber callback exceeds its budget */
+typedef struct {
+  os_mod_id_t module;      /* subscriber owner (OS_MOD_*) */
+  os_evt_id_t evt_id;      /* event being dispatched */
+  uint32_t    elapsed_us;
+  uint32_t    budget_us;
+} evt_watchdog_warning_t;
+
+/* Event bus health snapshot for the window since the previous tick */
+typedef struct {
+  uint16_t    dispatched;    /* saturating */
+  uint16_t    dropped;       /* saturating */
+  uint8_t     q_high_water;  /* saturating */
+  uint8_t     q_depth;       /* saturating */
+  os_mod_id_t slow_module;   /* owner of the slowest callback, OS_MOD_NONE if idle */
+  uint32_t    slow_cb_us;
+  uint32_t    lat_max_us;    /* worst publish->dispatch latency */
+} evt_health_tick_t;
+
 /* ==========================================================================
  * Optional contracts for “init/process” style modules
  * ========================================================================== */
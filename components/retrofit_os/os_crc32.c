@@ -0,0 +1,113 @@
+#include "os_crc32.h"
+#include <string.h>
+#include "os_crc32_table.h"
+
+#if OS_CRC32_USE_ROM
+#include "esp_rom_crc.h"
+#endif
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define CRC32_SLICE_LE 1
+#else
+#define CRC32_SLICE_LE 0
+#endif
+
+/* ---- Reference --------------------------------------------------------- */
+
+static inline uint32_t crc32_byte(uint32_t c, uint8_t b)
+{
+  return s_crc32_table[0][(c ^ b) & 0xFFu] ^ (c >> 8);
+}
+
+uint32_t os_crc32_update_bytewise(uint32_t crc, const void *data, size_t len)
+{
+  const uint8_t *p = (const uint8_t *)data;
+  uint32_t c = ~crc;
+  while (len--) {
+    c = crc32_byte(c, *p++);
+  }
+  return ~c;
+}
+
+/* ---- Slicing-by-4 ------------------------------------------------------ */
+
+static inline uint32_t crc32_word(uint32_t c, uint32_t w)
+{
+  c ^= w;
+  return s_crc32_table[3][c & 0xFFu] ^ s_crc32_table[2][(c >> 8) & 0xFFu] ^
+         s_crc32_table[1][(c >> 16) & 0xFFu] ^ s_crc32_table[0][c >> 24];
+}
+
+uint32_t os_crc32_update_sliced(uint32_t crc, const void *data, size_t len)
+{
+  const uint8_t *p = (const uint8_t *)data;
+  uint32_t c = ~crc;
+
+#if CRC32_SLICE_LE
+  /* Head bytes up to word alignment, then whole words */
+  while (len && ((uintptr_t)p & 3u)) {
+    c = crc32_byte(c, *p++);
+    len--;
+  }
+  while (len >= 4u) {
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    c = crc32_word(c, w);
+    p += 4;
+    len -= 4u;
+  }
+#endif
+  while (len--) {
+    c = crc32_byte(c, *p++);
+  }
+  return ~c;
+}
+
+/* ---- Public ------------------------------------------------------------ */
+
+uint32_t os_crc32_update(uint32_t crc, const void *data, size_t len)
+{
+#if OS_CRC32_USE_ROM
+  return esp_rom_crc32_le(crc, (const uint8_t *)data, (uint32_t)len);
+#else
+  return os_crc32_update_sliced(crc, data, len);
+#endif
+}
+
+uint32_t os_crc32_copy(void *dst, const void *src, size_t len, uint32_t crc)
+{
+#if OS_CRC32_USE_ROM
+  /* The ROM loop beats a fused table loop; dst is still hot from the copy */
+  memcpy(dst, src, len);
+  return esp_rom_crc32_le(crc, (const uint8_t *)dst, (uint32_t)len);
+#else
+  const uint8_t *s = (const uint8_t *)src;
+  uint8_t *d = (uint8_t *)dst;
+  uint32_t c = ~crc;
+
+#if CRC32_SLICE_LE
+  /* One load per word feeds both the store and the CRC */
+  while (len && ((uintptr_t)s & 3u)) {
+    *d = *s;
+    c = crc32_byte(c, *s++);
+    d++;
+    len--;
+  }
+  while (len >= 4u) {
+    uint32_t w;
+    memcpy(&w, s, sizeof(w));
+    memcpy(d, &w, sizeof(w));
+    c = crc32_word(c, w);
+    s += 4;
+    d += 4;
+    len -= 4u;
+  }
+#endif
+  while (len--) {
+    *d = *s;
+    c = crc32_byte(c, *s++);
+    d++;
+  }
+  return ~c;
+#endif
+}
@@ -0,0 +1,112 @@
+#include "os_spsc.h"
+#include <string.h>
+
+/* ---- Setup ------------------------------------------------------------- */
+
+os_err_t os_spsc_init(os_spsc_t *q, void *buf, uint32_t elem_size, uint32_t cap)
+{
+  if (!q || !buf || !elem_size || cap < 2u || (cap & (cap - 1u))) {
+    return OS_EINVAL;
+  }
+  memset(q, 0, sizeof(*q));
+  atomic_init(&q->head, 0u);
+  atomic_init(&q->tail, 0u);
+  q->buf = (uint8_t *)buf;
+  q->mask = cap - 1u;
+  q->elem_size = elem_size;
+  return OS_OK;
+}
+
+/* ---- Producer ---------------------------------------------------------- */
+
+void *os_spsc_claim(os_spsc_t *q)
+{
+  uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+  if (head - q->tail_cache > q->mask) {
+    /* Looks full: see how far the consumer got */
+    q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+    if (head - q->tail_cache > q->mask) {
+      q->full++;
+      return NULL;
+    }
+  }
+  return q->buf + (size_t)(head & q->mask) * q->elem_size;
+}
+
+void os_spsc_publish(os_spsc_t *q)
+{
+  uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+  /* The record is written before the consumer can see the new head */
+  atomic_store_explicit(&q->head, head + 1u, memory_order_release);
+  q->pushed++;
+}
+
+os_err_t os_spsc_push(os_spsc_t *q, const void *item)
+{
+  void *slot = os_spsc_claim(q);
+  if (!slot) {
+    return OS_EFULL;
+  }
+  memcpy(slot, item, q->elem_size);
+  os_spsc_publish(q);
+  return OS_OK;
+}
+
+/* ---- Consumer ---------------------------------------------------------- */
+
+void *os_spsc_peek(os_spsc_t *q)
+{
+  uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+  if (tail == q->head_cache) {
+    /* Looks empty: see what the producer published */
+    q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+    if (tail == q->head_cache) {
+      return NULL;
+    }
+    if (q->head_cache - tail > q->high_water) {
+      q->high_water = q->head_cache - tail;
+    }
+  }
+  return q->buf + (size_t)(tail & q->mask) * q->elem_size;
+}
+
+void os_spsc_release(os_spsc_t *q)
+{
+  uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+  /* The record is read before the producer can reuse it */
+  atomic_store_explicit(&q->tail, tail + 1u, memory_order_release);
+  q->popped++;
+}
+
+os_err_t os_spsc_pop(os_spsc_t *q, void *item)
+{
+  const void *slot = os_spsc_peek(q);
+  if (!slot) {
+    return OS_EINVAL;
+  }
+  memcpy(item, slot, q->elem_size);
+  os_spsc_release(q);
+  return OS_OK;
+}
+
+/* ---- Introspection ----------------------------------------------------- */
+
+uint32_t os_spsc_depth(const os_spsc_t *q)
+{
+  os_spsc_t *mq = (os_spsc_t *)q;  /* atomic loads take a non-const pointer in C11 */
+  uint32_t tail = atomic_load_explicit(&mq->tail, memory_order_acquire);
+  uint32_t head = atomic_load_explicit(&mq->head, memory_order_acquire);
+  return head - tail;
+}
+
+void os_spsc_get_stats(const os_spsc_t *q, os_spsc_stats_t *out)
+{
+  if (!q || !out) {
+    return;
+  }
+  out->pushed = q->pushed;
+  out->popped = q->popped;
+  out->full = q->full;
+  out->high_water = q->high_water;
+  out->depth = os_spsc_depth(q);
+}
@@ -0,0 +1,121 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Scheduler engine (platform-agnostic)
+ *
+ * Next-deadline scheduling over a binary min-heap keyed by absolute epoch
+ * seconds. The caller sleeps until sched_next_deadline() and then calls
+ * sched_process(); nothing scans the whole table.
+ *
+ * POLICY:
+ * - At-most-once: last_run is persisted BEFORE the due callback runs
+ * - Late by more than max_late_s (reboot, forward time jump): missed policy
+ * - Backward time jumps never re-fire: deadlines only move forward
+ *
+ * THREADING:
+ * - Without a lock the engine is single-task: every call from one task
+ * - With lock/unlock set, any task may call the API (sched_get() from a bus
+ *   handler while the main loop runs sched_process()); each call holds the
+ *   lock for its whole heap access, so no caller sees a torn entry
+ * - persist_last_run runs under the lock and must not call back into the
+ *   scheduler; on_due runs with the lock released and may
+ * ========================================================================== */
+
+#ifndef SCHED_MAX_ENTRIES
+#define SCHED_MAX_ENTRIES 64u
+#endif
+
+#ifndef SCHED_DEFAULT_MAX_LATE_S
+#define SCHED_DEFAULT_MAX_LATE_S 120u
+#endif
+
+#ifndef SCHED_PERSIST_RETRY_S
+#define SCHED_PERSIST_RETRY_S 5u
+#endif
+
+#define SCHED_NO_DEADLINE UINT32_MAX
+
+typedef enum {
+  SCHED_MISSED_SKIP     = 0, /* drop missed occurrences, wait for the next one */
+  SCHED_MISSED_RUN_ONCE = 1, /* fire once for all missed occurrences */
+} sched_missed_policy_t;
+
+typedef struct {
+  uint32_t id;            /* schedule_id reported in EVT_SCHEDULE_DUE */
+  uint16_t slot;          /* IR slot executed by this schedule */
+  uint8_t  missed_policy; /* sched_missed_policy_t */
+  uint8_t  rsvd;
+  uint32_t first_run;     /* epoch seconds of the first occurrence */
+  uint32_t period_s;      /* 0 = one-shot */
+  uint32_t last_run;      /* epoch seconds of the last fired occurrence, 0 = never (persisted) */
+} sched_entry_t;
+
+/* Called for every fired occurrence; deadline is the nominal occurrence time */
+typedef void (*sched_due_cb_t)(const sched_entry_t *entry, uint32_t deadline, void *user_ctx);
+
+/* Must make entry->last_run durable before returning OS_OK */
+typedef os_err_t (*sched_persist_fn_t)(const sched_entry_t *entry, void *user_ctx);
+
+typedef struct {
+  sched_due_cb_t     on_due;
+  void              *due_ctx;
+  sched_persist_fn_t persist_last_run; /* optional; NULL = no persistence */
+  void              *persist_ctx;
+  uint32_t           max_late_s;       /* 0 = SCHED_DEFAULT_MAX_LATE_S */
+  void             (*lock)(void *ctx); /* optional: API used from more than one task */
+  void             (*unlock)(void *ctx);
+  void              *lock_ctx;
+} sched_config_t;
+
+typedef struct {
+  uint32_t wakeups;        /* sched_process() calls */
+  uint32_t idle_wakeups;   /* sched_process() calls that fired nothing */
+  uint32_t fires;
+  uint32_t skipped;        /* occurrences dropped by SCHED_MISSED_SKIP */
+  uint32_t persist_errors;
+  uint32_t time_jumps;
+  uint32_t rekeyed;        /* entries re-keyed by sched_on_time_jump() */
+  uint32_t jitter_max_s;   /* worst fire time - deadline */
+  uint64_t jitter_sum_s;   /* divide by fires for the mean */
+} sched_stats_t;
+
+os_err_t sched_init(const sched_config_t *cfg);
+
+/* Add or replace (same id) an entry. last_run is honoured: the first deadline
+ * is the first occurrence after last_run, so a reload after reboot cannot
+ * re-fire an occurrence that already ran. */
+os_err_t sched_add(const sched_entry_t *entry);
+os_err_t sched_remove(uint32_t id);
+os_err_t sched_get(uint32_t id, sched_entry_t *out);
+uint16_t sched_count(void);
+
+/* Earliest pending deadline (epoch seconds), SCHED_NO_DEADLINE if empty */
+uint32_t sched_next_deadline(void);
+
+/* Earliest pending entry; OS_EINVAL if empty */
+os_err_t sched_peek_next(sched_entry_t *out, uint32_t *deadline);
+
+/* Fire everything due at now_s; returns the next deadline to sleep until */
+uint32_t sched_process(uint32_t now_s);
+
+/* EVT_TIME_JUMPED handler. now_s is the time after the jump. Only entries
+ * whose deadline was jumped over are re-keyed (O(k log n)). */
+void sched_on_time_jump(uint32_t now_s, int32_t delta_s);
+
+void sched_get_stats(sched_stats_t *out);
+void sched_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCHEDULER_H */
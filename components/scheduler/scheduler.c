@@ -0,0 +1,387 @@
+/* scheduler.c — next-deadline scheduler engine (no RTOS, no heap)
+ *
+ * Entries live in a fixed slot table; pending deadlines are kept in a binary
+ * min-heap of slot indexes. Each slot tracks its heap position so re-keying
+ * or removing one entry is O(log n). Public calls hold the optional lock
+ * for their whole table/heap access; on_due runs outside it.
+ */
+
+#include <string.h>
+#include "scheduler.h"
+
+#define SCHED_HEAP_NONE 0xFFFFu
+
+typedef struct {
+  sched_entry_t entry;
+  uint32_t      deadline;  /* next occurrence, SCHED_NO_DEADLINE when done */
+  uint16_t      heap_pos;  /* SCHED_HEAP_NONE when not queued */
+  uint8_t       used;
+} sched_slot_t;
+
+typedef struct {
+  sched_config_t cfg;
+  sched_slot_t   slots[SCHED_MAX_ENTRIES];
+  uint16_t       heap[SCHED_MAX_ENTRIES];
+  uint16_t       heap_len;
+  sched_stats_t  stats;
+} sched_ctx_t;
+
+static sched_ctx_t s_sched;
+
+static inline void sched_lock(void)
+{
+  if (s_sched.cfg.lock) {
+    s_sched.cfg.lock(s_sched.cfg.lock_ctx);
+  }
+}
+
+static inline void sched_unlock(void)
+{
+  if (s_sched.cfg.unlock) {
+    s_sched.cfg.unlock(s_sched.cfg.lock_ctx);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Heap helpers                                                               */
+/* -------------------------------------------------------------------------- */
+
+static inline uint32_t heap_key(uint16_t pos)
+{
+  return s_sched.slots[s_sched.heap[pos]].deadline;
+}
+
+static inline void heap_set(uint16_t pos, uint16_t slot)
+{
+  s_sched.heap[pos] = slot;
+  s_sched.slots[slot].heap_pos = pos;
+}
+
+static void heap_sift_up(uint16_t pos)
+{
+  uint16_t slot = s_sched.heap[pos];
+  uint32_t key = s_sched.slots[slot].deadline;
+  while (pos > 0) {
+    uint16_t parent = (uint16_t)((pos - 1u) / 2u);
+    if (heap_key(parent) <= key) {
+      break;
+    }
+    heap_set(pos, s_sched.heap[parent]);
+    pos = parent;
+  }
+  heap_set(pos, slot);
+}
+
+static void heap_sift_down(uint16_t pos)
+{
+  uint16_t slot = s_sched.heap[pos];
+  uint32_t key = s_sched.slots[slot].deadline;
+  for (;;) {
+    uint16_t child = (uint16_t)(2u * pos + 1u);
+    if (child >= s_sched.heap_len) {
+      break;
+    }
+    if (child + 1u < s_sched.heap_len && heap_key(child + 1u) < heap_key(child)) {
+      child++;
+    }
+    if (key <= heap_key(child)) {
+      break;
+    }
+    heap_set(pos, s_sched.heap[child]);
+    pos = child;
+  }
+  heap_set(pos, slot);
+}
+
+static void heap_remove(uint16_t slot)
+{
+  uint16_t pos = s_sched.slots[slot].heap_pos;
+  if (pos == SCHED_HEAP_NONE) {
+    return;
+  }
+  s_sched.slots[slot].heap_pos = SCHED_HEAP_NONE;
+  s_sched.heap_len--;
+  if (pos == s_sched.heap_len) {
+    return;
+  }
+  uint16_t moved = s_sched.heap[s_sched.heap_len];
+  heap_set(pos, moved);
+  heap_sift_down(pos);
+  heap_sift_up(s_sched.slots[moved].heap_pos);
+}
+
+/* Move a slot to a new deadline, (de)queueing it as needed */
+static void sched_rekey(uint16_t slot, uint32_t deadline)
+{
+  sched_slot_t *s = &s_sched.slots[slot];
+  s->deadline = deadline;
+  if (deadline == SCHED_NO_DEADLINE) {
+    heap_remove(slot);
+    return;
+  }
+  if (s->heap_pos == SCHED_HEAP_NONE) {
+    heap_set(s_sched.heap_len, slot);
+    s_sched.heap_len++;
+    heap_sift_up(s->heap_pos);
+    return;
+  }
+  heap_sift_up(s->heap_pos);
+  heap_sift_down(s->heap_pos);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Recurrence                                                                 */
+/* -------------------------------------------------------------------------- */
+
+/* First occurrence strictly after t */
+static uint32_t sched_occurrence_after(const sched_entry_t *e, uint32_t t)
+{
+  if (e->first_run > t) {
+    return e->first_run;
+  }
+  if (e->period_s == 0u) {
+    return SCHED_NO_DEADLINE;
+  }
+  uint64_t k = (uint64_t)(t - e->first_run) / e->period_s + 1u;
+  uint64_t next = (uint64_t)e->first_run + k * e->period_s;
+  return (next >= SCHED_NO_DEADLINE) ? SCHED_NO_DEADLINE : (uint32_t)next;
+}
+
+/* Latest occurrence at or before t (t >= deadline of a pending occurrence) */
+static uint32_t sched_occurrence_covering(const sched_entry_t *e, uint32_t deadline, uint32_t t)
+{
+  if (e->period_s == 0u || t < e->first_run) {
+    return deadline;
+  }
+  return e->first_run + ((t - e->first_run) / e->period_s) * e->period_s;
+}
+
+static int sched_find(uint32_t id)
+{
+  for (uint16_t i = 0; i < SCHED_MAX_ENTRIES; i++) {
+    if (s_sched.slots[i].used && s_sched.slots[i].entry.id == id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+os_err_t sched_init(const sched_config_t *cfg)
+{
+  if (!cfg || !cfg->on_due || !!cfg->lock != !!cfg->unlock) {
+    return OS_EINVAL;
+  }
+  memset(&s_sched, 0, sizeof(s_sched));
+  s_sched.cfg = *cfg;
+  if (s_sched.cfg.max_late_s == 0u) {
+    s_sched.cfg.max_late_s = SCHED_DEFAULT_MAX_LATE_S;
+  }
+  for (uint16_t i = 0; i < SCHED_MAX_ENTRIES; i++) {
+    s_sched.slots[i].heap_pos = SCHED_HEAP_NONE;
+  }
+  return OS_OK;
+}
+
+os_err_t sched_add(const sched_entry_t *entry)
+{
+  if (!entry || entry->missed_policy > SCHED_MISSED_RUN_ONCE) {
+    return OS_EINVAL;
+  }
+  sched_lock();
+  int idx = sched_find(entry->id);
+  if (idx < 0) {
+    for (uint16_t i = 0; i < SCHED_MAX_ENTRIES; i++) {
+      if (!s_sched.slots[i].used) {
+        idx = i;
+        break;
+      }
+    }
+  }
+  if (idx < 0) {
+    sched_unlock();
+    return OS_EFULL;
+  }
+  sched_slot_t *s = &s_sched.slots[idx];
+  s->used = 1u;
+  s->entry = *entry;
+  sched_rekey((uint16_t)idx, entry->last_run ? sched_occurrence_after(entry, entry->last_run) : entry->first_run);
+  sched_unlock();
+  return OS_OK;
+}
+
+os_err_t sched_remove(uint32_t id)
+{
+  sched_lock();
+  int idx = sched_find(id);
+  if (idx < 0) {
+    sched_unlock();
+    return OS_EINVAL;
+  }
+  heap_remove((uint16_t)idx);
+  memset(&s_sched.slots[idx], 0, sizeof(s_sched.slots[idx]));
+  s_sched.slots[idx].heap_pos = SCHED_HEAP_NONE;
+  sched_unlock();
+  return OS_OK;
+}
+
+os_err_t sched_get(uint32_t id, sched_entry_t *out)
+{
+  if (!out) {
+    return OS_EINVAL;
+  }
+  sched_lock();
+  int idx = sched_find(id);
+  if (idx >= 0) {
+    *out = s_sched.slots[idx].entry;
+  }
+  sched_unlock();
+  return idx < 0 ? OS_EINVAL : OS_OK;
+}
+
+uint16_t sched_count(void)
+{
+  uint16_t n = 0;
+  sched_lock();
+  for (uint16_t i = 0; i < SCHED_MAX_ENTRIES; i++) {
+    n += s_sched.slots[i].used;
+  }
+  sched_unlock();
+  return n;
+}
+
+static inline uint32_t sched_head_deadline(void)
+{
+  return s_sched.heap_len ? heap_key(0) : SCHED_NO_DEADLINE;
+}
+
+uint32_t sched_next_deadline(void)
+{
+  sched_lock();
+  uint32_t deadline = sched_head_deadline();
+  sched_unlock();
+  return deadline;
+}
+
+os_err_t sched_peek_next(sched_entry_t *out, uint32_t *deadline)
+{
+  sched_lock();
+  if (!s_sched.heap_len) {
+    sched_unlock();
+    return OS_EINVAL;
+  }
+  const sched_slot_t *s = &s_sched.slots[s_sched.heap[0]];
+  if (out) {
+    *out = s->entry;
+  }
+  if (deadline) {
+    *deadline = s->deadline;
+  }
+  sched_unlock();
+  return OS_OK;
+}
+
+uint32_t sched_process(uint32_t now_s)
+{
+  uint32_t fired = 0;
+  sched_lock();
+  s_sched.stats.wakeups++;
+
+  while (s_sched.heap_len && heap_key(0) <= now_s) {
+    uint16_t slot = s_sched.heap[0];
+    sched_slot_t *s = &s_sched.slots[slot];
+    uint32_t deadline = s->deadline;
+    uint32_t late = now_s - deadline;
+
+    if (late > s_sched.cfg.max_late_s && s->entry.missed_policy == SCHED_MISSED_SKIP) {
+      s_sched.stats.skipped++;
+      sched_rekey(slot, sched_occurrence_after(&s->entry, now_s));
+      continue;
+    }
+
+    /* One fire covers every occurrence up to now; persist before firing */
+    uint32_t prev_last_run = s->entry.last_run;
+    s->entry.last_run = sched_occurrence_covering(&s->entry, deadline, now_s);
+    if (s_sched.cfg.persist_last_run &&
+        s_sched.cfg.persist_last_run(&s->entry, s_sched.cfg.persist_ctx) != OS_OK) {
+      s->entry.last_run = prev_last_run;
+      s_sched.stats.persist_errors++;
+      sched_unlock();
+      return now_s + SCHED_PERSIST_RETRY_S;
+    }
+
+    sched_entry_t fired_entry = s->entry;
+    sched_rekey(slot, sched_occurrence_after(&s->entry, s->entry.last_run));
+
+    s_sched.stats.fires++;
+    s_sched.stats.jitter_sum_s += late;
+    if (late > s_sched.stats.jitter_max_s) {
+      s_sched.stats.jitter_max_s = late;
+    }
+    fired++;
+    /* The handler may call back in (sched_get, sched_add); the heap is re-read after it */
+    sched_unlock();
+    s_sched.cfg.on_due(&fired_entry, deadline, s_sched.cfg.due_ctx);
+    sched_lock();
+  }
+
+  if (!fired) {
+    s_sched.stats.idle_wakeups++;
+  }
+  uint32_t next = sched_head_deadline();
+  sched_unlock();
+  return next;
+}
+
+void sched_on_time_jump(uint32_t now_s, int32_t delta_s)
+{
+  sched_lock();
+  s_sched.stats.time_jumps++;
+
+  /* Deadlines are absolute: a backward jump only delays them, and small
+   * forward corrections are handled as ordinary lateness by sched_process(). */
+  if (delta_s <= 0 || (uint32_t)delta_s <= s_sched.cfg.max_late_s) {
+    sched_unlock();
+    return;
+  }
+
+  /* Only the entries that were jumped over sit at the top of the heap */
+  uint16_t run_once[SCHED_MAX_ENTRIES];
+  uint16_t run_once_len = 0;
+  while (s_sched.heap_len && heap_key(0) <= now_s) {
+    uint16_t slot = s_sched.heap[0];
+    sched_slot_t *s = &s_sched.slots[slot];
+    if (s->entry.missed_policy == SCHED_MISSED_RUN_ONCE) {
+      heap_remove(slot);
+      run_once[run_once_len++] = slot;
+      continue;
+    }
+    s_sched.stats.skipped++;
+    s_sched.stats.rekeyed++;
+    sched_rekey(slot, sched_occurrence_after(&s->entry, now_s));
+  }
+  /* RUN_ONCE entries stay due and fire on the next sched_process() */
+  for (uint16_t i = 0; i < run_once_len; i++) {
+    sched_rekey(run_once[i], s_sched.slots[run_once[i]].deadline);
+  }
+  sched_unlock();
+}
+
+void sched_get_stats(sched_stats_t *out)
+{
+  if (out) {
+    sched_lock();
+    *out = s_sched.stats;
+    sched_unlock();
+  }
+}
+
+void sched_reset_stats(void)
+{
+  sched_lock();
+  memset(&s_sched.stats, 0, sizeof(s_sched.stats));
+  sched_unlock();
+}
@@ -0,0 +1,115 @@
+#ifndef SLOT_PREFETCH_H
+#define SLOT_PREFETCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "retrofit_os_types.h"
+#include "scheduler.h"
+
+/* ==========================================================================
+ * Schedule-aware slot prefetch (platform-agnostic, no heap)
+ *
+ * Sending a scheduled slot needs a storage read, a CRC check and the
+ * expansion into RMT symbols before rmt_transmit() can start. The scheduler
+ * knows the next deadline, so this stage does all three up to lead_s ahead
+ * of it, into one reserved TX buffer. EVT_SCHEDULE_DUE then only claims the
+ * buffer, and schedule-to-emission latency no longer depends on storage.
+ *
+ * POLICY:
+ * - One prefetched slot: the head of the scheduler heap (sched_peek_next),
+ *   prepared once its deadline is within lead_s
+ * - Validated before rendering: a slot whose CRC-32 does not match its
+ *   stored value is never rendered (OS_ECRC, same as the cold path)
+ * - Dropped on EVT_TIME_JUMPED, EVT_FACTORY_RESET_DONE, EVT_IR_SLOT_WRITTEN
+ *   for the prefetched slot, and EVT_SCHEDULE_TABLE_UPDATED that removed the
+ *   schedule or changed its slot; slot_prefetch_tick() re-checks the head
+ * - A prepared frame is kept until claimed, even after sched_process() has
+ *   moved the heap on; it is discarded if not claimed within claim_s
+ * - A miss runs the same load/check/render on the due path, into the same
+ *   buffer, so slot_prefetch_acquire() always returns a frame or the error
+ * - The buffer is held from acquire() to release() (TX done); nothing is
+ *   prefetched over it meanwhile
+ * ========================================================================== */
+
+#ifndef SLOT_PREFETCH_DATA_MAX
+#define SLOT_PREFETCH_DATA_MAX 256u     /* stored slot bytes */
+#endif
+
+#ifndef SLOT_PREFETCH_SYMBOLS_MAX
+#define SLOT_PREFETCH_SYMBOLS_MAX 128u  /* rendered RMT symbols */
+#endif
+
+#ifndef SLOT_PREFETCH_LEAD_S
+#define SLOT_PREFETCH_LEAD_S 2u
+#endif
+
+#ifndef SLOT_PREFETCH_CLAIM_S
+#define SLOT_PREFETCH_CLAIM_S 60u
+#endif
+
+/* Slot storage and the IR renderer */
+typedef struct {
+  /* Stored slot bytes and the CRC-32 recorded when the slot was written */
+  os_err_t (*load)(uint16_t slot, void *buf, uint16_t cap, uint16_t *len, uint32_t *crc32, void *ctx);
+  /* Expand a validated slot into RMT symbols (raw 32-bit rmt_symbol_word_t) */
+  os_err_t (*render)(uint16_t slot, const void *data, uint16_t len,
+                     uint32_t *symbols, uint16_t cap, uint16_t *num, void *ctx);
+  void     (*lock)(void *ctx);    /* optional: tick and acquire on different tasks */
+  void     (*unlock)(void *ctx);
+  uint32_t (*now_us)(void *ctx);  /* optional: latency stats */
+  void      *ctx;
+} slot_prefetch_source_t;
+
+typedef struct {
+  slot_prefetch_source_t source;
+  uint32_t               lead_s;   /* 0 = SLOT_PREFETCH_LEAD_S */
+  uint32_t               claim_s;  /* 0 = SLOT_PREFETCH_CLAIM_S */
+} slot_prefetch_config_t;
+
+typedef struct {
+  uint32_t prefetches;      /* frames prepared ahead of their deadline */
+  uint32_t hits;            /* acquire() served from the prefetched frame */
+  uint32_t misses;          /* acquire() that ran the cold path */
+  uint32_t invalidated;     /* prepared frames dropped by an event */
+  uint32_t wasted;          /* prepared frames never claimed */
+  uint32_t crc_errors;
+  uint32_t errors;          /* load / render failures */
+  uint32_t busy;            /* acquire() while the buffer was held */
+  uint32_t prepare_us_max;  /* load + check + render, either path */
+  uint64_t prepare_us_sum;
+  uint32_t prepares;
+  uint32_t hit_us_max;      /* acquire() latency on a hit */
+  uint32_t miss_us_max;     /* acquire() latency on a miss */
+  uint64_t miss_us_sum;
+  uint64_t saved_us_sum;    /* prepare time taken off the due path by hits */
+} slot_prefetch_stats_t;
+
+os_err_t slot_prefetch_init(const slot_prefetch_config_t *cfg);
+
+/* Prefetch the next due slot if it is within lead_s. Call after
+ * sched_process(), after a release and at the returned time (epoch s,
+ * SCHED_NO_DEADLINE if nothing is pending). */
+uint32_t slot_prefetch_tick(uint32_t now_s);
+
+/* EVT_SCHEDULE_DUE: the rendered frame for schedule_id, prefetched or
+ * prepared now. The buffer stays valid until slot_prefetch_release(). */
+os_err_t slot_prefetch_acquire(uint32_t schedule_id, const uint32_t **symbols, uint16_t *num);
+void     slot_prefetch_release(void);
+
+void     slot_prefetch_invalidate(void);
+
+/* os_process_fn_t compatible: schedule / slot / time / factory reset events */
+os_err_t slot_prefetch_process(const os_evt_t *evt);
+
+void slot_prefetch_get_stats(slot_prefetch_stats_t *out);
+void slot_prefetch_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SLOT_PREFETCH_H */
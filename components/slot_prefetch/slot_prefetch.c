@@ -0,0 +1,311 @@
+/* slot_prefetch.c — prepare the next scheduled slot before it is due
+ *
+ * One reserved frame: the stored slot is read into a staging buffer,
+ * checked against its CRC-32 and rendered into RMT symbols. The frame is
+ * tagged with the schedule id and deadline it was prepared for; the due
+ * path claims it by id, or prepares it there and then (a miss).
+ */
+
+#include <string.h>
+#include "os_crc32.h"
+#include "slot_prefetch.h"
+
+typedef struct {
+  slot_prefetch_config_t cfg;
+  uint32_t id;               /* schedule the frame was prepared for */
+  uint32_t deadline;
+  uint32_t prepare_us;       /* what preparing it cost */
+  uint32_t failed_id;        /* occurrence whose prefetch failed: not retried */
+  uint32_t failed_deadline;
+  uint16_t slot;
+  uint16_t num;              /* rendered symbols */
+  uint8_t  valid;
+  uint8_t  held;             /* claimed, TX in progress */
+  uint8_t  failed;
+  uint8_t  ready;
+  uint8_t  data[SLOT_PREFETCH_DATA_MAX];
+  uint32_t symbols[SLOT_PREFETCH_SYMBOLS_MAX];
+  slot_prefetch_stats_t stats;
+} spf_ctx_t;
+
+static spf_ctx_t s_spf;
+
+/* -------------------------------------------------------------------------- */
+/* Helpers                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static inline void spf_lock(void)
+{
+  if (s_spf.cfg.source.lock) {
+    s_spf.cfg.source.lock(s_spf.cfg.source.ctx);
+  }
+}
+
+static inline void spf_unlock(void)
+{
+  if (s_spf.cfg.source.unlock) {
+    s_spf.cfg.source.unlock(s_spf.cfg.source.ctx);
+  }
+}
+
+static inline uint32_t spf_now_us(void)
+{
+  return s_spf.cfg.source.now_us ? s_spf.cfg.source.now_us(s_spf.cfg.source.ctx) : 0u;
+}
+
+/* Load, check and render a slot into the reserved frame (buffer not held) */
+static os_err_t spf_prepare(uint16_t slot)
+{
+  const slot_prefetch_source_t *src = &s_spf.cfg.source;
+  uint32_t t0 = spf_now_us();
+  uint16_t len = 0;
+  uint32_t crc = 0;
+
+  s_spf.valid = 0u;
+  os_err_t err = src->load(slot, s_spf.data, sizeof(s_spf.data), &len, &crc, src->ctx);
+  if (err == OS_OK && len > sizeof(s_spf.data)) {
+    err = OS_EINVAL;
+  }
+  if (err != OS_OK) {
+    s_spf.stats.errors++;
+    return err;
+  }
+  if (os_crc32_update(OS_CRC32_INIT, s_spf.data, len) != crc) {
+    s_spf.stats.crc_errors++;
+    return OS_ECRC;
+  }
+  uint16_t num = 0;
+  err = src->render(slot, s_spf.data, len, s_spf.symbols, SLOT_PREFETCH_SYMBOLS_MAX, &num, src->ctx);
+  if (err == OS_OK && (num == 0u || num > SLOT_PREFETCH_SYMBOLS_MAX)) {
+    err = OS_EINVAL;
+  }
+  if (err != OS_OK) {
+    s_spf.stats.errors++;
+    return err;
+  }
+
+  uint32_t dt = spf_now_us() - t0;
+  s_spf.slot = slot;
+  s_spf.num = num;
+  s_spf.prepare_us = dt;
+  s_spf.stats.prepares++;
+  s_spf.stats.prepare_us_sum += dt;
+  if (dt > s_spf.stats.prepare_us_max) {
+    s_spf.stats.prepare_us_max = dt;
+  }
+  return OS_OK;
+}
+
+static void spf_drop(uint32_t *counter)
+{
+  if (s_spf.valid && !s_spf.held) {
+    s_spf.valid = 0u;
+    (*counter)++;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+os_err_t slot_prefetch_init(const slot_prefetch_config_t *cfg)
+{
+  if (!cfg || !cfg->source.load || !cfg->source.render) {
+    return OS_EINVAL;
+  }
+  if (!!cfg->source.lock != !!cfg->source.unlock) {
+    return OS_EINVAL;
+  }
+  memset(&s_spf, 0, sizeof(s_spf));
+  s_spf.cfg = *cfg;
+  if (!s_spf.cfg.lead_s) {
+    s_spf.cfg.lead_s = SLOT_PREFETCH_LEAD_S;
+  }
+  if (!s_spf.cfg.claim_s) {
+    s_spf.cfg.claim_s = SLOT_PREFETCH_CLAIM_S;
+  }
+  s_spf.ready = 1u;
+  return OS_OK;
+}
+
+uint32_t slot_prefetch_tick(uint32_t now_s)
+{
+  sched_entry_t head;
+  uint32_t deadline;
+  uint32_t next = SCHED_NO_DEADLINE;
+
+  if (!s_spf.ready) {
+    return next;
+  }
+  spf_lock();
+
+  /* Fired but never claimed (IR service down, event dropped) */
+  if (s_spf.valid && s_spf.deadline <= now_s && now_s - s_spf.deadline > s_spf.cfg.claim_s) {
+    spf_drop(&s_spf.stats.wasted);
+  }
+
+  if (sched_peek_next(&head, &deadline) != OS_OK) {
+    spf_unlock();
+    return next;
+  }
+
+  if (s_spf.valid) {
+    if (s_spf.id == head.id && s_spf.deadline == deadline && s_spf.slot == head.slot) {
+      spf_unlock();
+      return next;  /* ready; the next work follows sched_process() */
+    }
+    if (s_spf.held || s_spf.deadline <= now_s) {
+      /* The frame of a fired schedule waits for its claim */
+      spf_unlock();
+      return now_s + 1u;
+    }
+    /* The table changed under a frame that is not due yet */
+    spf_drop(&s_spf.stats.wasted);
+  }
+
+  if (deadline > now_s && deadline - now_s > s_spf.cfg.lead_s) {
+    spf_unlock();
+    return deadline - s_spf.cfg.lead_s;
+  }
+  if (s_spf.failed && s_spf.failed_id == head.id && s_spf.failed_deadline == deadline) {
+    spf_unlock();
+    return next;  /* the due path reports the error */
+  }
+
+  if (spf_prepare(head.slot) == OS_OK) {
+    s_spf.id = head.id;
+    s_spf.deadline = deadline;
+    s_spf.valid = 1u;
+    s_spf.failed = 0u;
+    s_spf.stats.prefetches++;
+  } else {
+    s_spf.failed = 1u;
+    s_spf.failed_id = head.id;
+    s_spf.failed_deadline = deadline;
+  }
+  spf_unlock();
+  return next;
+}
+
+os_err_t slot_prefetch_acquire(uint32_t schedule_id, const uint32_t **symbols, uint16_t *num)
+{
+  if (!symbols || !num) {
+    return OS_EINVAL;
+  }
+  if (!s_spf.ready) {
+    return OS_ESTATE;
+  }
+  spf_lock();
+  uint32_t t0 = spf_now_us();
+  if (s_spf.held) {
+    s_spf.stats.busy++;
+    spf_unlock();
+    return OS_EBUSY;
+  }
+
+  if (s_spf.valid && s_spf.id == schedule_id) {
+    uint32_t dt = spf_now_us() - t0;
+    s_spf.stats.hits++;
+    s_spf.stats.saved_us_sum += s_spf.prepare_us;
+    if (dt > s_spf.stats.hit_us_max) {
+      s_spf.stats.hit_us_max = dt;
+    }
+  } else {
+    /* Cold path into the same buffer; a frame for another schedule is lost */
+    sched_entry_t e;
+    spf_drop(&s_spf.stats.wasted);
+    s_spf.stats.misses++;
+    os_err_t err = sched_get(schedule_id, &e);
+    if (err == OS_OK) {
+      err = spf_prepare(e.slot);
+    }
+    if (err != OS_OK) {
+      spf_unlock();
+      return err;
+    }
+    uint32_t dt = spf_now_us() - t0;
+    s_spf.id = schedule_id;
+    s_spf.valid = 1u;
+    s_spf.stats.miss_us_sum += dt;
+    if (dt > s_spf.stats.miss_us_max) {
+      s_spf.stats.miss_us_max = dt;
+    }
+  }
+
+  s_spf.held = 1u;
+  *symbols = s_spf.symbols;
+  *num = s_spf.num;
+  spf_unlock();
+  return OS_OK;
+}
+
+void slot_prefetch_release(void)
+{
+  spf_lock();
+  /* A frame belongs to one occurrence */
+  s_spf.held = 0u;
+  s_spf.valid = 0u;
+  spf_unlock();
+}
+
+void slot_prefetch_invalidate(void)
+{
+  spf_lock();
+  spf_drop(&s_spf.stats.invalidated);
+  s_spf.failed = 0u;
+  spf_unlock();
+}
+
+os_err_t slot_prefetch_process(const os_evt_t *evt)
+{
+  if (!evt) {
+    return OS_EINVAL;
+  }
+  switch (evt->id) {
+  case EVT_SCHEDULE_TABLE_UPDATED: {
+    /* Only a change to the prefetched schedule's slot matters; a moved
+     * deadline is picked up by the next tick */
+    sched_entry_t e;
+    spf_lock();
+    if (s_spf.valid && (sched_get(s_spf.id, &e) != OS_OK || e.slot != s_spf.slot)) {
+      spf_drop(&s_spf.stats.invalidated);
+    }
+    s_spf.failed = 0u;
+    spf_unlock();
+    return OS_OK;
+  }
+  case EVT_TIME_JUMPED:
+  case EVT_FACTORY_RESET_DONE:
+    slot_prefetch_invalidate();
+    return OS_OK;
+  case EVT_IR_SLOT_WRITTEN: {
+    evt_ir_slot_written_t p;
+    if (evt->len < sizeof(p)) {
+      return OS_EINVAL;
+    }
+    memcpy(&p, evt->payload, sizeof(p));
+    /* Also retries a prefetch that failed on the old contents */
+    spf_lock();
+    if (s_spf.valid && s_spf.slot == p.slot) {
+      spf_drop(&s_spf.stats.invalidated);
+    }
+    s_spf.failed = 0u;
+    spf_unlock();
+    return OS_OK;
+  }
+  default:
+    return OS_OK;
+  }
+}
+
+void slot_prefetch_get_stats(slot_prefetch_stats_t *out)
+{
+  if (out) {
+    *out = s_spf.stats;
+  }
+}
+
+void slot_prefetch_reset_stats(void)
+{
+  memset(&s_spf.stats, 0, sizeof(s_spf.stats));
+}
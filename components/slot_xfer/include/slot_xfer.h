@@ -0,0 +1,169 @@
+#ifndef SLOT_XFER_H
+#define SLOT_XFER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Bulk IR slot transfer over the command transport (platform-agnostic, no heap)
+ *
+ * Streams whole slots between the device and a peer (phone backup/restore
+ * over BLE GATT, FR-7). Slots move as MTU-sized chunks under a sliding
+ * acknowledgement window, instead of one request/response per chunk.
+ *
+ * Frames (little-endian, 2-byte header: type, flags):
+ *   REQ    peer -> device   slot u16, offset u32          export from offset
+ *   START  sender -> rcv    slot u16, size u32, crc32 u32, offset u32
+ *   DATA   sender -> rcv    offset u32, payload[]
+ *   ACK    rcv -> sender    next u32, credit u8, status i8
+ *   ABORT  either           status i8
+ *
+ * POLICY:
+ * - Window: at most min(window, peer credit) chunks unacknowledged; the
+ *   receiver acks every SLOT_XFER_ACK_EVERY chunks, on SLOT_XFER_F_ACKREQ
+ *   and at the end; go-back-N on a duplicate ack or an ack timeout
+ * - Order: DATA is accepted only at the expected offset (the link is
+ *   in-order); anything else is dropped and answered with a duplicate ack
+ * - No full-frame copies: export reads storage straight into the TX frame,
+ *   import hands DATA payloads to the store in place; CRC-32 is folded in
+ * - Resume: a link drop pauses the transfer. Export restarts from the offset
+ *   in the peer's next REQ; import keeps its progress and answers a START
+ *   for the same slot, size and CRC with its next offset (SLOT_XFER_F_RESUME)
+ * - One transfer at a time, all calls from the transport task; frames must
+ *   come from an authenticated session (FR-9, gated by the command layer)
+ * ========================================================================== */
+
+#ifndef SLOT_XFER_MTU_MAX
+#define SLOT_XFER_MTU_MAX 247u       /* largest ATT MTU used for chunking */
+#endif
+
+#ifndef SLOT_XFER_DEFAULT_MTU
+#define SLOT_XFER_DEFAULT_MTU 23u    /* BLE default until EVT_BLE_SEC_CHANGED */
+#endif
+
+#ifndef SLOT_XFER_WINDOW
+#define SLOT_XFER_WINDOW 8u          /* chunks in flight / credit granted */
+#endif
+
+#ifndef SLOT_XFER_ACK_EVERY
+#define SLOT_XFER_ACK_EVERY 4u
+#endif
+
+#ifndef SLOT_XFER_ACK_TIMEOUT_MS
+#define SLOT_XFER_ACK_TIMEOUT_MS 1000u
+#endif
+
+#ifndef SLOT_XFER_MAX_RETRIES
+#define SLOT_XFER_MAX_RETRIES 4u
+#endif
+
+#define SLOT_XFER_ATT_OVERHEAD 3u    /* opcode + handle of a notification / write command */
+#define SLOT_XFER_HDR_LEN      2u
+#define SLOT_XFER_DATA_HDR_LEN 6u
+#define SLOT_XFER_FRAME_MAX    (SLOT_XFER_MTU_MAX - SLOT_XFER_ATT_OVERHEAD)
+
+/* Frame types */
+#define SLOT_XFER_T_REQ   1u
+#define SLOT_XFER_T_START 2u
+#define SLOT_XFER_T_DATA  3u
+#define SLOT_XFER_T_ACK   4u
+#define SLOT_XFER_T_ABORT 5u
+
+/* Frame flags */
+#define SLOT_XFER_F_RESUME (1u << 0)  /* ACK: answers a START that continues a paused import */
+#define SLOT_XFER_F_DONE   (1u << 1)  /* ACK: final, slot verified and committed (or status) */
+#define SLOT_XFER_F_ACKREQ (1u << 2)  /* DATA: sender window is full, ack now */
+
+typedef enum {
+  SLOT_XFER_IDLE = 0,
+  SLOT_XFER_EXPORT,    /* device sends a stored slot */
+  SLOT_XFER_IMPORT,    /* device receives a slot into storage */
+} slot_xfer_dir_t;
+
+/* Command transport (GATT notifications / write commands, loopback on host) */
+typedef struct {
+  /* One frame of at most mtu - SLOT_XFER_ATT_OVERHEAD bytes.
+   * OS_EBUSY if the link queue is full: retried from slot_xfer_tick(). */
+  os_err_t (*send)(const void *frame, uint16_t len, void *ctx);
+  void      *ctx;
+} slot_xfer_transport_t;
+
+/* Slot storage, read and written in place by chunk */
+typedef struct {
+  /* Export */
+  os_err_t (*info)(uint16_t slot, uint32_t *size, uint32_t *crc32, void *ctx);
+  os_err_t (*read)(uint16_t slot, uint32_t off, void *buf, uint16_t len, void *ctx);
+  /* Import: begin, in-order writes, commit once the CRC matched */
+  os_err_t (*begin)(uint16_t slot, uint32_t size, void *ctx);
+  os_err_t (*write)(uint16_t slot, uint32_t off, const void *data, uint16_t len, void *ctx);
+  os_err_t (*commit)(uint16_t slot, uint32_t crc32, void *ctx);
+  void     (*abort)(uint16_t slot, void *ctx);   /* optional: drop a partial slot */
+  void      *ctx;
+} slot_xfer_store_t;
+
+/* End of a transfer: OS_OK, or the local / peer error */
+typedef void (*slot_xfer_done_fn_t)(slot_xfer_dir_t dir, uint16_t slot, os_err_t result, void *user_ctx);
+
+typedef struct {
+  slot_xfer_transport_t transport;
+  slot_xfer_store_t     store;
+  slot_xfer_done_fn_t   done;       /* optional, e.g. publish EVT_IR_SLOT_WRITTEN */
+  void                 *user_ctx;
+  uint16_t              mtu;        /* 0 = SLOT_XFER_DEFAULT_MTU */
+  uint8_t               window;     /* 0 = SLOT_XFER_WINDOW; 1 = stop-and-wait */
+} slot_xfer_config_t;
+
+typedef struct {
+  uint32_t frames_tx;
+  uint32_t frames_rx;
+  uint32_t chunks_tx;
+  uint32_t chunks_rx;
+  uint32_t retransmits;   /* chunks sent again after go-back-N */
+  uint32_t dropped;       /* out-of-order / duplicate / stale frames */
+  uint32_t acks_tx;
+  uint32_t acks_rx;
+  uint32_t timeouts;
+  uint32_t busy;          /* transport returned OS_EBUSY */
+  uint32_t resumes;
+  uint32_t completed;
+  uint32_t failed;
+  uint64_t bytes_tx;      /* slot payload bytes */
+  uint64_t bytes_rx;
+} slot_xfer_stats_t;
+
+os_err_t slot_xfer_init(const slot_xfer_config_t *cfg);
+
+/* One received frame (without the ATT header) */
+os_err_t slot_xfer_on_rx(const void *frame, uint16_t len);
+
+/* Ack timeouts and frames deferred by OS_EBUSY; call periodically and when the link drains */
+void slot_xfer_tick(uint32_t now_ms);
+
+/* Chunk size follows the negotiated MTU from the next chunk on */
+void slot_xfer_set_mtu(uint16_t mtu);
+
+/* os_process_fn_t compatible: EVT_BLE_SEC_CHANGED (mtu), EVT_BLE_CONN_CHANGED (pause) */
+os_err_t slot_xfer_process(const os_evt_t *evt);
+
+/* Aborts the current transfer and tells the peer */
+void slot_xfer_cancel(void);
+
+/* Current direction; *done / *size in bytes (each optional) */
+slot_xfer_dir_t slot_xfer_get_progress(uint16_t *slot, uint32_t *done, uint32_t *size);
+
+void     slot_xfer_get_stats(slot_xfer_stats_t *out);
+void     slot_xfer_reset_stats(void);
+
+/* Static RAM of the transfer context, frame buffer included */
+uint32_t slot_xfer_ram_bytes(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SLOT_XFER_H */
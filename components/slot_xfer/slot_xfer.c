@@ -0,0 +1,560 @@
+/* slot_xfer.c — windowed, resumable slot streaming over the command transport
+ *
+ * Export (device -> peer) is a go-back-N sender: DATA is read from storage
+ * straight into the single TX frame, at most min(window, credit) chunks are
+ * in flight, and a duplicate ack or an ack timeout rewinds to the last
+ * acknowledged offset. Import (peer -> device) accepts DATA only at the next
+ * expected offset and writes the payload to the store in place, folding it
+ * into a running CRC-32 that must match the START before the commit.
+ *
+ * Offsets, not sequence numbers, identify chunks, so the chunk size may
+ * follow an MTU change mid-transfer and a resume is just "continue at next".
+ */
+
+#include <string.h>
+#include "os_crc32.h"
+#include "slot_xfer.h"
+
+#define SX_PEND_START (1u << 0)
+#define SX_PEND_ACK   (1u << 1)
+#define SX_PEND_ABORT (1u << 2)
+
+#define SX_REQ_LEN   (SLOT_XFER_HDR_LEN + 6u)
+#define SX_START_LEN (SLOT_XFER_HDR_LEN + 14u)
+#define SX_ACK_LEN   (SLOT_XFER_HDR_LEN + 6u)
+#define SX_ABORT_LEN (SLOT_XFER_HDR_LEN + 1u)
+
+#define SX_NO_OFFSET UINT32_MAX
+
+_Static_assert(SLOT_XFER_MTU_MAX >= SLOT_XFER_DEFAULT_MTU, "MTU bounds");
+_Static_assert(SLOT_XFER_FRAME_MAX > SLOT_XFER_DATA_HDR_LEN && SLOT_XFER_FRAME_MAX >= SX_START_LEN,
+               "frame must hold a chunk and a START");
+_Static_assert(SLOT_XFER_DEFAULT_MTU > SLOT_XFER_ATT_OVERHEAD + SLOT_XFER_DATA_HDR_LEN, "no room for payload");
+
+typedef struct {
+  slot_xfer_config_t cfg;
+  uint8_t            ready;
+  uint8_t            dir;          /* slot_xfer_dir_t */
+  uint8_t            paused;       /* link dropped, waiting for REQ / START */
+  uint8_t            pending;      /* SX_PEND_*: frames deferred by OS_EBUSY */
+  uint8_t            credit;       /* export: window granted by the peer */
+  uint8_t            retries;
+  uint8_t            since_ack;    /* import: chunks since the last ack */
+  uint8_t            ack_flags;    /* pending ACK / ABORT contents */
+  int8_t             ack_status;
+  uint16_t           slot;
+  uint16_t           chunk;        /* payload bytes per DATA at the current MTU */
+  uint32_t           size;
+  uint32_t           crc32;        /* export: stored, import: announced */
+  uint32_t           crc_run;      /* import: over [0, next) */
+  uint32_t           next;         /* import: next expected offset */
+  uint32_t           ack_next;
+  uint32_t           acked;        /* export: peer has [0, acked) */
+  uint32_t           sent;         /* export: next offset to send */
+  uint32_t           sent_max;
+  uint32_t           rewound_at;   /* export: go-back-N once per duplicate ack value */
+  uint32_t           start_off;
+  uint32_t           now_ms;       /* last slot_xfer_tick() */
+  uint32_t           progress_ms;  /* export: last ack progress */
+  slot_xfer_stats_t  stats;
+  uint8_t            tx[SLOT_XFER_FRAME_MAX];
+} slot_xfer_ctx_t;
+
+static slot_xfer_ctx_t s_x;
+
+/* -------------------------------------------------------------------------- */
+/* Helpers                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static inline void sx_put16(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void sx_put32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint16_t sx_get16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static inline uint32_t sx_get32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t sx_chunk_for_mtu(uint16_t mtu)
+{
+  if (mtu < SLOT_XFER_DEFAULT_MTU) {
+    mtu = SLOT_XFER_DEFAULT_MTU;
+  }
+  if (mtu > SLOT_XFER_MTU_MAX) {
+    mtu = SLOT_XFER_MTU_MAX;
+  }
+  return (uint16_t)(mtu - SLOT_XFER_ATT_OVERHEAD - SLOT_XFER_DATA_HDR_LEN);
+}
+
+static os_err_t sx_send(uint8_t type, uint8_t flags, uint16_t len)
+{
+  s_x.tx[0] = type;
+  s_x.tx[1] = flags;
+  os_err_t err = s_x.cfg.transport.send(s_x.tx, len, s_x.cfg.transport.ctx);
+  if (err == OS_OK) {
+    s_x.stats.frames_tx++;
+  } else if (err == OS_EBUSY) {
+    s_x.stats.busy++;
+  }
+  return err;
+}
+
+static void sx_send_ack(uint32_t next, uint8_t flags, os_err_t status)
+{
+  s_x.ack_next = next;
+  s_x.ack_flags = flags;
+  s_x.ack_status = (int8_t)status;
+  sx_put32(&s_x.tx[2], next);
+  s_x.tx[6] = s_x.cfg.window;
+  s_x.tx[7] = (uint8_t)(int8_t)status;
+  if (sx_send(SLOT_XFER_T_ACK, flags, SX_ACK_LEN) == OS_OK) {
+    s_x.pending &= (uint8_t)~SX_PEND_ACK;
+    s_x.stats.acks_tx++;
+    s_x.since_ack = 0u;
+  } else {
+    s_x.pending |= SX_PEND_ACK;
+  }
+}
+
+static void sx_send_abort(os_err_t status)
+{
+  s_x.ack_status = (int8_t)status;
+  s_x.tx[2] = (uint8_t)(int8_t)status;
+  if (sx_send(SLOT_XFER_T_ABORT, 0u, SX_ABORT_LEN) == OS_OK) {
+    s_x.pending &= (uint8_t)~SX_PEND_ABORT;
+  } else {
+    s_x.pending |= SX_PEND_ABORT;
+  }
+}
+
+/* Ends the current transfer; a deferred ACK / ABORT for the peer stays pending */
+static void sx_finish(os_err_t result)
+{
+  slot_xfer_dir_t dir = (slot_xfer_dir_t)s_x.dir;
+  uint16_t slot = s_x.slot;
+  if (dir == SLOT_XFER_IDLE) {
+    return;
+  }
+  if (dir == SLOT_XFER_IMPORT && result != OS_OK && s_x.cfg.store.abort) {
+    s_x.cfg.store.abort(slot, s_x.cfg.store.ctx);
+  }
+  s_x.dir = SLOT_XFER_IDLE;
+  s_x.paused = 0u;
+  s_x.pending &= (uint8_t)~SX_PEND_START;
+  if (result == OS_OK) {
+    s_x.stats.completed++;
+  } else {
+    s_x.stats.failed++;
+  }
+  if (s_x.cfg.done) {
+    s_x.cfg.done(dir, slot, result, s_x.cfg.user_ctx);
+  }
+}
+
+static void sx_fail(os_err_t err)
+{
+  sx_send_abort(err);
+  sx_finish(err);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Export (sender)                                                            */
+/* -------------------------------------------------------------------------- */
+
+static os_err_t sx_send_start(void)
+{
+  sx_put16(&s_x.tx[2], s_x.slot);
+  sx_put32(&s_x.tx[4], s_x.size);
+  sx_put32(&s_x.tx[8], s_x.crc32);
+  sx_put32(&s_x.tx[12], s_x.start_off);
+  os_err_t err = sx_send(SLOT_XFER_T_START, 0u, SX_START_LEN);
+  if (err == OS_OK) {
+    s_x.pending &= (uint8_t)~SX_PEND_START;
+  }
+  return err;
+}
+
+static void sx_pump(void)
+{
+  if (s_x.dir != SLOT_XFER_EXPORT || s_x.paused) {
+    return;
+  }
+  if ((s_x.pending & SX_PEND_START) && sx_send_start() != OS_OK) {
+    return;
+  }
+
+  uint8_t window = (s_x.credit < s_x.cfg.window) ? s_x.credit : s_x.cfg.window;
+  uint32_t in_flight_max = (uint32_t)window * s_x.chunk;
+  while (s_x.sent < s_x.size && s_x.sent - s_x.acked < in_flight_max) {
+    uint32_t left = s_x.size - s_x.sent;
+    uint16_t n = (left < s_x.chunk) ? (uint16_t)left : s_x.chunk;
+    os_err_t err = s_x.cfg.store.read(s_x.slot, s_x.sent, &s_x.tx[SLOT_XFER_DATA_HDR_LEN], n, s_x.cfg.store.ctx);
+    if (err != OS_OK) {
+      sx_fail(err);
+      return;
+    }
+    uint8_t flags = (s_x.sent + n == s_x.size || s_x.sent + n - s_x.acked >= in_flight_max) ? SLOT_XFER_F_ACKREQ : 0u;
+    sx_put32(&s_x.tx[2], s_x.sent);
+    err = sx_send(SLOT_XFER_T_DATA, flags, (uint16_t)(SLOT_XFER_DATA_HDR_LEN + n));
+    if (err == OS_EBUSY) {
+      return;  /* retried from slot_xfer_tick() */
+    }
+    if (err != OS_OK) {
+      s_x.paused = 1u;  /* link gone: wait for the peer to resume */
+      return;
+    }
+    if (s_x.sent == s_x.acked) {
+      s_x.progress_ms = s_x.now_ms;
+    }
+    if (s_x.sent < s_x.sent_max) {
+      s_x.stats.retransmits++;
+    }
+    s_x.stats.chunks_tx++;
+    s_x.stats.bytes_tx += n;
+    s_x.sent += n;
+    if (s_x.sent > s_x.sent_max) {
+      s_x.sent_max = s_x.sent;
+    }
+  }
+}
+
+static os_err_t sx_on_req(const uint8_t *f, uint16_t len)
+{
+  if (len < SX_REQ_LEN) {
+    return OS_EINVAL;
+  }
+  uint16_t slot = sx_get16(&f[2]);
+  uint32_t off = sx_get32(&f[4]);
+  uint32_t size = 0;
+  uint32_t crc = 0;
+
+  /* Last request wins: the peer has abandoned whatever it was doing */
+  if (s_x.dir != SLOT_XFER_IDLE && !(s_x.dir == SLOT_XFER_EXPORT && s_x.slot == slot)) {
+    sx_finish(OS_EFAIL);
+  }
+  os_err_t err = s_x.cfg.store.info(slot, &size, &crc, s_x.cfg.store.ctx);
+  if (err == OS_OK && off > size) {
+    err = OS_EINVAL;
+  }
+  if (err != OS_OK) {
+    if (s_x.dir == SLOT_XFER_EXPORT) {
+      sx_finish(err);
+    }
+    sx_send_abort(err);
+    return err;
+  }
+  if (off > 0u) {
+    s_x.stats.resumes++;
+  }
+
+  s_x.dir = SLOT_XFER_EXPORT;
+  s_x.paused = 0u;
+  s_x.slot = slot;
+  s_x.size = size;
+  s_x.crc32 = crc;
+  s_x.start_off = off;
+  s_x.acked = s_x.sent = s_x.sent_max = off;
+  s_x.rewound_at = SX_NO_OFFSET;
+  s_x.credit = s_x.cfg.window;
+  s_x.retries = 0u;
+  s_x.progress_ms = s_x.now_ms;
+  s_x.pending |= SX_PEND_START;
+  sx_pump();
+  return OS_OK;
+}
+
+static os_err_t sx_on_ack(const uint8_t *f, uint16_t len)
+{
+  if (len < SX_ACK_LEN || s_x.dir != SLOT_XFER_EXPORT) {
+    s_x.stats.dropped++;
+    return OS_OK;
+  }
+  uint32_t next = sx_get32(&f[2]);
+  uint8_t credit = f[6];
+  os_err_t status = (int8_t)f[7];
+  s_x.stats.acks_rx++;
+
+  if (f[1] & SLOT_XFER_F_DONE) {
+    sx_finish((status != OS_OK) ? status : ((next == s_x.size) ? OS_OK : OS_EFAIL));
+    return OS_OK;
+  }
+  if (status != OS_OK) {
+    sx_finish(status);
+    return OS_OK;
+  }
+  if (next < s_x.acked || next > s_x.sent_max) {
+    s_x.stats.dropped++;  /* stale ack from before a resume */
+    return OS_OK;
+  }
+  s_x.credit = credit ? credit : 1u;
+  s_x.paused = 0u;
+  if (next > s_x.acked) {
+    s_x.acked = next;
+    s_x.retries = 0u;
+    s_x.progress_ms = s_x.now_ms;
+    if (s_x.sent < next) {
+      s_x.sent = next;
+    }
+  } else if (next < s_x.sent && s_x.rewound_at != next) {
+    s_x.sent = next;  /* duplicate ack: the peer dropped a chunk, go back once */
+    s_x.rewound_at = next;
+  }
+  sx_pump();
+  return OS_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Import (receiver)                                                          */
+/* -------------------------------------------------------------------------- */
+
+static os_err_t sx_import_complete(void)
+{
+  os_err_t err = (s_x.crc_run == s_x.crc32) ? OS_OK : OS_ECRC;
+  if (err == OS_OK) {
+    err = s_x.cfg.store.commit(s_x.slot, s_x.crc32, s_x.cfg.store.ctx);
+  }
+  sx_send_ack(s_x.next, SLOT_XFER_F_DONE, err);
+  sx_finish(err);
+  return err;
+}
+
+static os_err_t sx_on_start(const uint8_t *f, uint16_t len)
+{
+  if (len < SX_START_LEN) {
+    return OS_EINVAL;
+  }
+  uint16_t slot = sx_get16(&f[2]);
+  uint32_t size = sx_get32(&f[4]);
+  uint32_t crc = sx_get32(&f[8]);
+
+  if (s_x.dir == SLOT_XFER_IMPORT && s_x.slot == slot && s_x.size == size && s_x.crc32 == crc) {
+    s_x.paused = 0u;
+    s_x.stats.resumes++;
+    sx_send_ack(s_x.next, SLOT_XFER_F_RESUME, OS_OK);
+    return OS_OK;
+  }
+  sx_finish(OS_EFAIL);  /* last request wins */
+
+  os_err_t err = s_x.cfg.store.begin(slot, size, s_x.cfg.store.ctx);
+  if (err != OS_OK) {
+    sx_send_abort(err);
+    return err;
+  }
+  s_x.dir = SLOT_XFER_IMPORT;
+  s_x.paused = 0u;
+  s_x.slot = slot;
+  s_x.size = size;
+  s_x.crc32 = crc;
+  s_x.crc_run = OS_CRC32_INIT;
+  s_x.next = 0u;
+  s_x.since_ack = 0u;
+  if (size == 0u) {
+    return sx_import_complete();
+  }
+  sx_send_ack(0u, 0u, OS_OK);
+  return OS_OK;
+}
+
+static os_err_t sx_on_data(const uint8_t *f, uint16_t len)
+{
+  if (len < SLOT_XFER_DATA_HDR_LEN || s_x.dir != SLOT_XFER_IMPORT || s_x.paused) {
+    s_x.stats.dropped++;
+    return OS_OK;
+  }
+  uint32_t off = sx_get32(&f[2]);
+  uint16_t n = (uint16_t)(len - SLOT_XFER_DATA_HDR_LEN);
+  const uint8_t *payload = &f[SLOT_XFER_DATA_HDR_LEN];
+
+  if (off != s_x.next) {
+    s_x.stats.dropped++;
+    if (off > s_x.next) {
+      sx_send_ack(s_x.next, 0u, OS_OK);  /* duplicate ack: go back */
+    }
+    return OS_OK;
+  }
+  if (n == 0u || n > s_x.size - s_x.next) {
+    sx_fail(OS_EINVAL);
+    return OS_EINVAL;
+  }
+  os_err_t err = s_x.cfg.store.write(s_x.slot, off, payload, n, s_x.cfg.store.ctx);
+  if (err != OS_OK) {
+    sx_fail(err);
+    return err;
+  }
+  s_x.crc_run = os_crc32_update(s_x.crc_run, payload, n);
+  s_x.next += n;
+  s_x.since_ack++;
+  s_x.stats.chunks_rx++;
+  s_x.stats.bytes_rx += n;
+
+  if (s_x.next == s_x.size) {
+    return sx_import_complete();
+  }
+  if (s_x.since_ack >= SLOT_XFER_ACK_EVERY || (f[1] & SLOT_XFER_F_ACKREQ)) {
+    sx_send_ack(s_x.next, 0u, OS_OK);
+  }
+  return OS_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+os_err_t slot_xfer_init(const slot_xfer_config_t *cfg)
+{
+  if (!cfg || !cfg->transport.send || !cfg->store.info || !cfg->store.read || !cfg->store.begin ||
+      !cfg->store.write || !cfg->store.commit) {
+    return OS_EINVAL;
+  }
+  memset(&s_x, 0, sizeof(s_x));
+  s_x.cfg = *cfg;
+  if (!s_x.cfg.window) {
+    s_x.cfg.window = SLOT_XFER_WINDOW;
+  }
+  s_x.chunk = sx_chunk_for_mtu(cfg->mtu ? cfg->mtu : SLOT_XFER_DEFAULT_MTU);
+  s_x.ready = 1u;
+  return OS_OK;
+}
+
+os_err_t slot_xfer_on_rx(const void *frame, uint16_t len)
+{
+  if (!s_x.ready) {
+    return OS_ESTATE;
+  }
+  const uint8_t *f = (const uint8_t *)frame;
+  if (!f || len < SLOT_XFER_HDR_LEN) {
+    s_x.stats.dropped++;
+    return OS_EINVAL;
+  }
+  s_x.stats.frames_rx++;
+
+  switch (f[0]) {
+  case SLOT_XFER_T_REQ:
+    return sx_on_req(f, len);
+  case SLOT_XFER_T_START:
+    return sx_on_start(f, len);
+  case SLOT_XFER_T_DATA:
+    return sx_on_data(f, len);
+  case SLOT_XFER_T_ACK:
+    return sx_on_ack(f, len);
+  case SLOT_XFER_T_ABORT:
+    sx_finish((len > SLOT_XFER_HDR_LEN && (int8_t)f[2] != OS_OK) ? (int8_t)f[2] : OS_EFAIL);
+    return OS_OK;
+  default:
+    s_x.stats.dropped++;
+    return OS_EINVAL;
+  }
+}
+
+void slot_xfer_tick(uint32_t now_ms)
+{
+  if (!s_x.ready) {
+    return;
+  }
+  s_x.now_ms = now_ms;
+
+  if (s_x.pending & SX_PEND_ABORT) {
+    sx_send_abort(s_x.ack_status);
+  }
+  if (s_x.pending & SX_PEND_ACK) {
+    sx_send_ack(s_x.ack_next, s_x.ack_flags, s_x.ack_status);
+  }
+  if (s_x.dir != SLOT_XFER_EXPORT || s_x.paused) {
+    return;
+  }
+  if (s_x.sent > s_x.acked && now_ms - s_x.progress_ms >= SLOT_XFER_ACK_TIMEOUT_MS) {
+    s_x.stats.timeouts++;
+    if (++s_x.retries > SLOT_XFER_MAX_RETRIES) {
+      sx_fail(OS_ETIMEOUT);
+      return;
+    }
+    s_x.sent = s_x.acked;
+    s_x.rewound_at = s_x.acked;
+    s_x.progress_ms = now_ms;
+  }
+  sx_pump();
+}
+
+void slot_xfer_set_mtu(uint16_t mtu)
+{
+  s_x.chunk = sx_chunk_for_mtu(mtu);
+}
+
+os_err_t slot_xfer_process(const os_evt_t *evt)
+{
+  if (!evt) {
+    return OS_EINVAL;
+  }
+  if (evt->id == EVT_BLE_SEC_CHANGED && evt->len >= sizeof(evt_ble_sec_changed_t)) {
+    evt_ble_sec_changed_t sec;
+    memcpy(&sec, evt->payload, sizeof(sec));
+    if (sec.mtu) {
+      slot_xfer_set_mtu(sec.mtu);
+    }
+  } else if (evt->id == EVT_BLE_CONN_CHANGED && evt->len >= sizeof(evt_ble_conn_changed_t)) {
+    evt_ble_conn_changed_t conn;
+    memcpy(&conn, evt->payload, sizeof(conn));
+    if (conn.state == OS_LINK_DOWN) {
+      /* Frames for the old link are meaningless; progress is kept for a resume */
+      s_x.pending = 0u;
+      if (s_x.dir != SLOT_XFER_IDLE) {
+        s_x.paused = 1u;
+      }
+      slot_xfer_set_mtu(SLOT_XFER_DEFAULT_MTU);
+    }
+  }
+  return OS_OK;
+}
+
+void slot_xfer_cancel(void)
+{
+  if (s_x.dir != SLOT_XFER_IDLE) {
+    sx_fail(OS_EFAIL);
+  }
+}
+
+slot_xfer_dir_t slot_xfer_get_progress(uint16_t *slot, uint32_t *done, uint32_t *size)
+{
+  if (slot) {
+    *slot = s_x.slot;
+  }
+  if (done) {
+    *done = (s_x.dir == SLOT_XFER_EXPORT) ? s_x.acked : s_x.next;
+  }
+  if (size) {
+    *size = s_x.size;
+  }
+  return (slot_xfer_dir_t)s_x.dir;
+}
+
+void slot_xfer_get_stats(slot_xfer_stats_t *out)
+{
+  if (out) {
+    *out = s_x.stats;
+  }
+}
+
+void slot_xfer_reset_stats(void)
+{
+  memset(&s_x.stats, 0, sizeof(s_x.stats));
+}
+
+uint32_t slot_xfer_ram_bytes(void)
+{
+  return (uint32_t)sizeof(s_x);
+}
@@ -0,0 +1,152 @@
+#ifndef STORAGE_CACHE_H
+#define STORAGE_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Write-back storage cache (platform-agnostic, no heap)
+ *
+ * Sits between the Storage Service API and the NVM backend. Small records
+ * (schedule last_run, slot metadata, config) are updated in RAM and written
+ * in batches: one backend write per dirty record and one commit per flush,
+ * no matter how often a record changed in between.
+ *
+ * POLICY:
+ * - Flush triggers: dirty age >= flush_interval_s, power mode leaving
+ *   PWR_ACTIVE, EVT_OTA_START, a full cache, an explicit scache_flush()
+ * - SCACHE_F_JOURNAL records are durable on return: the update is appended
+ *   to a small journal and replayed on boot (at-most-once schedules)
+ * - SCACHE_F_SYNC records are written through (e.g. slot commits)
+ * - Flush order: records -> commit -> journal checkpoint; the journal is
+ *   erased only when full (replay is idempotent)
+ * ========================================================================== */
+
+#ifndef SCACHE_MAX_ENTRIES
+#define SCACHE_MAX_ENTRIES 48u
+#endif
+
+#ifndef SCACHE_MAX_VALUE
+#define SCACHE_MAX_VALUE 32u
+#endif
+
+#ifndef SCACHE_JOURNAL_VALUE_MAX
+#define SCACHE_JOURNAL_VALUE_MAX 8u
+#endif
+
+#ifndef SCACHE_DEFAULT_FLUSH_S
+#define SCACHE_DEFAULT_FLUSH_S 3600u
+#endif
+
+#define SCACHE_NO_DEADLINE UINT32_MAX
+
+typedef uint32_t scache_key_t;
+
+#define SCACHE_KEY(ns, id) (((scache_key_t)(ns) << 16) | (uint16_t)(id))
+
+typedef enum {
+  SCACHE_NS_CONFIG    = 1,
+  SCACHE_NS_SLOT_META = 2,
+  SCACHE_NS_SCHED     = 3,  /* id = schedule id, value = last_run */
+} scache_ns_t;
+
+/* Journal record closing a committed batch (key namespace 0 is reserved) */
+#define SCACHE_JOURNAL_CHECKPOINT SCACHE_KEY(0, 0)
+
+/* scache_put() flags */
+#define SCACHE_F_JOURNAL (1u << 0)  /* durable now via the journal, flushed later */
+#define SCACHE_F_SYNC    (1u << 1)  /* write through and commit now */
+
+typedef enum {
+  SCACHE_FLUSH_EXPLICIT = 0,
+  SCACHE_FLUSH_TIMER,
+  SCACHE_FLUSH_POWER,
+  SCACHE_FLUSH_OTA,
+  SCACHE_FLUSH_PRESSURE,  /* cache or journal full */
+  SCACHE_FLUSH__MAX
+} scache_flush_reason_t;
+
+/* Journal record: fixed size so the backend can append it as one program */
+typedef struct {
+  scache_key_t key;
+  uint16_t     len;
+  uint16_t     seq;
+  uint8_t      value[SCACHE_JOURNAL_VALUE_MAX];
+} scache_journal_rec_t;
+
+typedef void (*scache_replay_cb_t)(const scache_journal_rec_t *rec, void *cb_ctx);
+
+/* NVM binding (NVS, raw partition, RAM mock) */
+typedef struct {
+  /* OS_EINVAL if the key does not exist; *len = stored length */
+  os_err_t (*read)(scache_key_t key, void *buf, uint16_t cap, uint16_t *len, void *ctx);
+  os_err_t (*write)(scache_key_t key, const void *buf, uint16_t len, void *ctx);
+  os_err_t (*commit)(void *ctx);  /* optional: make the preceding writes durable */
+
+  /* Optional journal; required for SCACHE_F_JOURNAL (append-only, torn
+   * records must be discarded by the backend). OS_EFULL when full; reset
+   * erases it. */
+  os_err_t (*journal_append)(const scache_journal_rec_t *rec, void *ctx);
+  os_err_t (*journal_replay)(scache_replay_cb_t cb, void *cb_ctx, void *ctx);
+  os_err_t (*journal_reset)(void *ctx);
+
+  void     (*lock)(void *ctx);    /* optional: callers on several tasks */
+  void     (*unlock)(void *ctx);
+  uint32_t (*now_us)(void *ctx);  /* optional: latency stats */
+  void      *ctx;
+} scache_backend_t;
+
+typedef struct {
+  scache_backend_t backend;
+  uint32_t         flush_interval_s;  /* max dirty age; 0 = SCACHE_DEFAULT_FLUSH_S */
+} scache_config_t;
+
+typedef struct {
+  uint32_t puts;
+  uint32_t coalesced;       /* puts that overwrote an already dirty record */
+  uint32_t unchanged;       /* puts equal to the cached value (no-op) */
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t evictions;
+  uint32_t backend_writes;
+  uint32_t commits;
+  uint32_t journal_appends;
+  uint32_t journal_replayed;
+  uint32_t journal_checkpoints;
+  uint32_t journal_resets;  /* journal erased because it was full */
+  uint32_t errors;
+  uint32_t flushes[SCACHE_FLUSH__MAX];
+  uint32_t put_us_max;      /* caller-visible put latency */
+  uint32_t flush_us_max;
+  uint64_t flush_us_sum;
+} scache_stats_t;
+
+/* Replays the journal into the cache and flushes it */
+os_err_t scache_init(const scache_config_t *cfg);
+
+os_err_t scache_get(scache_key_t key, void *buf, uint16_t cap, uint16_t *len);
+os_err_t scache_put(scache_key_t key, const void *buf, uint16_t len, uint32_t flags);
+
+os_err_t scache_flush(scache_flush_reason_t reason);
+
+/* Timer flush; returns the next flush deadline (epoch s) or SCACHE_NO_DEADLINE */
+uint32_t scache_tick(uint32_t now_s);
+
+/* os_process_fn_t compatible: EVT_POWER_MODE_CHANGED, EVT_OTA_START, EVT_FACTORY_RESET_DONE */
+os_err_t scache_process(const os_evt_t *evt);
+
+uint16_t scache_dirty_count(void);
+
+void scache_get_stats(scache_stats_t *out);
+void scache_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STORAGE_CACHE_H */
@@ -0,0 +1,455 @@
+/* storage_cache.c — write-back cache with batched flushes and a boot journal
+ *
+ * Fixed table of small records with an LRU counter. A put only touches RAM
+ * (plus one journal append for SCACHE_F_JOURNAL); a flush writes every dirty
+ * record once and commits once, so N updates to a record cost one write.
+ *
+ * A flush closes the journal with a checkpoint record instead of erasing it;
+ * the journal is only erased when full, so erases scale with appends, not
+ * with flushes. Replay applies only the records after the last checkpoint.
+ */
+
+#include <string.h>
+#include "storage_cache.h"
+
+typedef struct {
+  scache_key_t key;
+  uint16_t     len;
+  uint8_t      valid;
+  uint8_t      dirty;
+  uint8_t      journaled;  /* latest value is in the journal */
+  uint32_t     lru;
+  uint8_t      value[SCACHE_MAX_VALUE];
+} scache_entry_t;
+
+typedef struct {
+  scache_config_t cfg;
+  scache_entry_t  entries[SCACHE_MAX_ENTRIES];
+  uint32_t        lru_clock;
+  uint32_t        now_s;          /* last scache_tick() time, 0 = unknown */
+  uint32_t        dirty_since_s;  /* SCACHE_NO_DEADLINE = not known yet */
+  uint16_t        dirty;
+  uint16_t        journal_used;
+  uint16_t        journal_seq;
+  uint8_t         journal_full;   /* last append hit OS_EFULL: erase at next flush */
+  uint8_t         ready;
+  uint8_t         replaying;      /* journal is being iterated: do not reset it */
+  scache_stats_t  stats;
+} scache_ctx_t;
+
+static scache_ctx_t s_cache;
+
+/* -------------------------------------------------------------------------- */
+/* Helpers (called with the backend lock held)                                */
+/* -------------------------------------------------------------------------- */
+
+static inline void scache_lock(void)
+{
+  if (s_cache.cfg.backend.lock) {
+    s_cache.cfg.backend.lock(s_cache.cfg.backend.ctx);
+  }
+}
+
+static inline void scache_unlock(void)
+{
+  if (s_cache.cfg.backend.unlock) {
+    s_cache.cfg.backend.unlock(s_cache.cfg.backend.ctx);
+  }
+}
+
+static inline uint32_t scache_now_us(void)
+{
+  return s_cache.cfg.backend.now_us ? s_cache.cfg.backend.now_us(s_cache.cfg.backend.ctx) : 0u;
+}
+
+static scache_entry_t *scache_find(scache_key_t key)
+{
+  for (uint16_t i = 0; i < SCACHE_MAX_ENTRIES; i++) {
+    scache_entry_t *e = &s_cache.entries[i];
+    if (e->valid && e->key == key) {
+      e->lru = ++s_cache.lru_clock;
+      return e;
+    }
+  }
+  return NULL;
+}
+
+static void scache_mark_clean(scache_entry_t *e)
+{
+  if (e->dirty) {
+    e->dirty = 0u;
+    s_cache.dirty--;
+  }
+  e->journaled = 0u;
+}
+
+static os_err_t scache_write_entry(scache_entry_t *e)
+{
+  os_err_t err = s_cache.cfg.backend.write(e->key, e->value, e->len, s_cache.cfg.backend.ctx);
+  if (err != OS_OK) {
+    s_cache.stats.errors++;
+    return err;
+  }
+  s_cache.stats.backend_writes++;
+  scache_mark_clean(e);
+  return OS_OK;
+}
+
+static os_err_t scache_commit(void)
+{
+  if (!s_cache.cfg.backend.commit) {
+    return OS_OK;
+  }
+  os_err_t err = s_cache.cfg.backend.commit(s_cache.cfg.backend.ctx);
+  if (err != OS_OK) {
+    s_cache.stats.errors++;
+    return err;
+  }
+  s_cache.stats.commits++;
+  return OS_OK;
+}
+
+static void scache_journal_checkpoint(void)
+{
+  os_err_t err = OS_EFULL;
+  if (!s_cache.journal_full) {
+    scache_journal_rec_t cp = { .key = SCACHE_JOURNAL_CHECKPOINT, .seq = s_cache.journal_seq++ };
+    err = s_cache.cfg.backend.journal_append(&cp, s_cache.cfg.backend.ctx);
+    s_cache.stats.journal_checkpoints += (err == OS_OK);
+  }
+  if (err == OS_EFULL) {
+    /* Nothing before the checkpoint is needed any more */
+    err = s_cache.cfg.backend.journal_reset(s_cache.cfg.backend.ctx);
+    s_cache.stats.journal_resets += (err == OS_OK);
+  }
+  if (err == OS_OK) {
+    s_cache.journal_used = 0u;
+    s_cache.journal_full = 0u;
+  } else {
+    s_cache.stats.errors++;
+  }
+}
+
+static os_err_t scache_flush_locked(scache_flush_reason_t reason)
+{
+  if (!s_cache.dirty && !s_cache.journal_used && !s_cache.journal_full) {
+    return OS_OK;
+  }
+  uint32_t t0 = scache_now_us();
+  os_err_t err = OS_OK;
+
+  for (uint16_t i = 0; i < SCACHE_MAX_ENTRIES; i++) {
+    scache_entry_t *e = &s_cache.entries[i];
+    if (e->valid && e->dirty && scache_write_entry(e) != OS_OK) {
+      err = OS_EFAIL;
+    }
+  }
+  if (scache_commit() != OS_OK) {
+    err = OS_EFAIL;
+  }
+  /* Checkpoint only once everything the journal covers is committed */
+  if (err == OS_OK && (s_cache.journal_used || s_cache.journal_full) && !s_cache.replaying) {
+    scache_journal_checkpoint();
+  }
+  if (!s_cache.dirty) {
+    s_cache.dirty_since_s = SCACHE_NO_DEADLINE;
+  }
+
+  uint32_t dt = scache_now_us() - t0;
+  s_cache.stats.flushes[reason]++;
+  s_cache.stats.flush_us_sum += dt;
+  if (dt > s_cache.stats.flush_us_max) {
+    s_cache.stats.flush_us_max = dt;
+  }
+  return err;
+}
+
+/* Free slot, else least recently used clean record, else flush and retry */
+static scache_entry_t *scache_alloc(scache_key_t key)
+{
+  for (int pass = 0; pass < 2; pass++) {
+    scache_entry_t *victim = NULL;
+    for (uint16_t i = 0; i < SCACHE_MAX_ENTRIES; i++) {
+      scache_entry_t *e = &s_cache.entries[i];
+      if (!e->valid) {
+        victim = e;
+        break;
+      }
+      if (!e->dirty && (!victim || e->lru < victim->lru)) {
+        victim = e;
+      }
+    }
+    if (victim) {
+      if (victim->valid) {
+        s_cache.stats.evictions++;
+      }
+      memset(victim, 0, sizeof(*victim));
+      victim->valid = 1u;
+      victim->key = key;
+      victim->lru = ++s_cache.lru_clock;
+      return victim;
+    }
+    if (scache_flush_locked(SCACHE_FLUSH_PRESSURE) != OS_OK) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+static void scache_set_dirty(scache_entry_t *e)
+{
+  if (e->dirty) {
+    s_cache.stats.coalesced++;
+    return;
+  }
+  e->dirty = 1u;
+  s_cache.dirty++;
+  if (s_cache.dirty_since_s == SCACHE_NO_DEADLINE && s_cache.now_s) {
+    s_cache.dirty_since_s = s_cache.now_s;
+  }
+}
+
+static void scache_replay_cb(const scache_journal_rec_t *rec, void *cb_ctx)
+{
+  (void)cb_ctx;
+  s_cache.journal_seq = (uint16_t)(rec->seq + 1u);
+  if (rec->key == SCACHE_JOURNAL_CHECKPOINT) {
+    /* Everything replayed so far was committed before this checkpoint, and
+     * NVM may hold newer values written since: drop it, reads go to NVM */
+    for (uint16_t i = 0; i < SCACHE_MAX_ENTRIES; i++) {
+      if (s_cache.entries[i].journaled) {
+        scache_mark_clean(&s_cache.entries[i]);
+        s_cache.entries[i].valid = 0u;
+      }
+    }
+    s_cache.journal_used = 0u;
+    return;
+  }
+  if (rec->len > SCACHE_JOURNAL_VALUE_MAX) {
+    return;
+  }
+  scache_entry_t *e = scache_find(rec->key);
+  if (!e) {
+    e = scache_alloc(rec->key);
+  }
+  if (!e) {
+    s_cache.stats.errors++;
+    return;
+  }
+  memcpy(e->value, rec->value, rec->len);
+  e->len = rec->len;
+  scache_set_dirty(e);
+  e->journaled = 1u;
+  s_cache.journal_used++;
+  s_cache.stats.journal_replayed++;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+os_err_t scache_init(const scache_config_t *cfg)
+{
+  if (!cfg || !cfg->backend.read || !cfg->backend.write) {
+    return OS_EINVAL;
+  }
+  if (!!cfg->backend.journal_append != !!cfg->backend.journal_reset) {
+    return OS_EINVAL;
+  }
+  memset(&s_cache, 0, sizeof(s_cache));
+  s_cache.cfg = *cfg;
+  if (!s_cache.cfg.flush_interval_s) {
+    s_cache.cfg.flush_interval_s = SCACHE_DEFAULT_FLUSH_S;
+  }
+  s_cache.dirty_since_s = SCACHE_NO_DEADLINE;
+  s_cache.ready = 1u;
+
+  if (!cfg->backend.journal_replay) {
+    return OS_OK;
+  }
+  scache_lock();
+  s_cache.replaying = 1u;
+  os_err_t err = cfg->backend.journal_replay(scache_replay_cb, NULL, cfg->backend.ctx);
+  s_cache.replaying = 0u;
+  if (err == OS_OK) {
+    err = scache_flush_locked(SCACHE_FLUSH_EXPLICIT);
+  }
+  scache_unlock();
+  return err;
+}
+
+os_err_t scache_get(scache_key_t key, void *buf, uint16_t cap, uint16_t *len)
+{
+  if (!s_cache.ready || !buf || !len) {
+    return OS_EINVAL;
+  }
+  os_err_t err = OS_OK;
+  scache_lock();
+  scache_entry_t *e = scache_find(key);
+  if (e) {
+    s_cache.stats.hits++;
+  } else {
+    s_cache.stats.misses++;
+    uint8_t tmp[SCACHE_MAX_VALUE];
+    uint16_t n = 0;
+    err = s_cache.cfg.backend.read(key, tmp, sizeof(tmp), &n, s_cache.cfg.backend.ctx);
+    if (err == OS_OK && n <= SCACHE_MAX_VALUE && (e = scache_alloc(key)) != NULL) {
+      memcpy(e->value, tmp, n);
+      e->len = n;
+    } else if (err == OS_OK) {
+      err = OS_ENOMEM;
+    }
+  }
+  if (e) {
+    if (e->len > cap) {
+      err = OS_EINVAL;
+    } else {
+      memcpy(buf, e->value, e->len);
+      *len = e->len;
+    }
+  }
+  scache_unlock();
+  return err;
+}
+
+static os_err_t scache_put_locked(scache_key_t key, const void *buf, uint16_t len, uint32_t flags)
+{
+  scache_entry_t *e = scache_find(key);
+  if (e && e->len == len && memcmp(e->value, buf, len) == 0 &&
+      (!e->dirty || !flags || (flags == SCACHE_F_JOURNAL && e->journaled))) {
+    s_cache.stats.unchanged++;
+    return OS_OK;
+  }
+  if (!e && (e = scache_alloc(key)) == NULL) {
+    return OS_ENOMEM;
+  }
+  memcpy(e->value, buf, len);
+  e->len = len;
+  scache_set_dirty(e);
+  e->journaled = 0u;
+
+  if (flags & SCACHE_F_SYNC) {
+    os_err_t err = scache_write_entry(e);
+    return (err == OS_OK) ? scache_commit() : err;
+  }
+  if (!(flags & SCACHE_F_JOURNAL)) {
+    return OS_OK;
+  }
+
+  scache_journal_rec_t rec = { .key = key, .len = len, .seq = s_cache.journal_seq++ };
+  memcpy(rec.value, buf, len);
+  os_err_t err = s_cache.cfg.backend.journal_append(&rec, s_cache.cfg.backend.ctx);
+  if (err == OS_EFULL) {
+    /* Flushing makes the record durable and erases the journal */
+    s_cache.journal_full = 1u;
+    return scache_flush_locked(SCACHE_FLUSH_PRESSURE);
+  }
+  if (err != OS_OK) {
+    s_cache.stats.errors++;
+    return err;
+  }
+  e->journaled = 1u;
+  s_cache.journal_used++;
+  s_cache.stats.journal_appends++;
+  return OS_OK;
+}
+
+os_err_t scache_put(scache_key_t key, const void *buf, uint16_t len, uint32_t flags)
+{
+  if (!s_cache.ready || (len && !buf) || len > SCACHE_MAX_VALUE) {
+    return OS_EINVAL;
+  }
+  if ((flags & SCACHE_F_JOURNAL) && (!s_cache.cfg.backend.journal_append || len > SCACHE_JOURNAL_VALUE_MAX)) {
+    return OS_ENOTSUP;
+  }
+  scache_lock();
+  uint32_t t0 = scache_now_us();
+  s_cache.stats.puts++;
+  os_err_t err = scache_put_locked(key, buf, len, flags);
+  uint32_t dt = scache_now_us() - t0;
+  if (dt > s_cache.stats.put_us_max) {
+    s_cache.stats.put_us_max = dt;
+  }
+  scache_unlock();
+  return err;
+}
+
+os_err_t scache_flush(scache_flush_reason_t reason)
+{
+  if (!s_cache.ready || reason >= SCACHE_FLUSH__MAX) {
+    return OS_EINVAL;
+  }
+  scache_lock();
+  os_err_t err = scache_flush_locked(reason);
+  scache_unlock();
+  return err;
+}
+
+uint32_t scache_tick(uint32_t now_s)
+{
+  if (!s_cache.ready) {
+    return SCACHE_NO_DEADLINE;
+  }
+  scache_lock();
+  s_cache.now_s = now_s;
+  if (s_cache.dirty && s_cache.dirty_since_s == SCACHE_NO_DEADLINE) {
+    s_cache.dirty_since_s = now_s;
+  }
+  if (s_cache.dirty && now_s - s_cache.dirty_since_s >= s_cache.cfg.flush_interval_s) {
+    (void)scache_flush_locked(SCACHE_FLUSH_TIMER);
+  }
+  uint32_t next = s_cache.dirty ? s_cache.dirty_since_s + s_cache.cfg.flush_interval_s : SCACHE_NO_DEADLINE;
+  scache_unlock();
+  return next;
+}
+
+os_err_t scache_process(const os_evt_t *evt)
+{
+  if (!evt) {
+    return OS_EINVAL;
+  }
+  switch (evt->id) {
+  case EVT_POWER_MODE_CHANGED: {
+    evt_power_mode_changed_t p;
+    if (evt->len < sizeof(p)) {
+      return OS_EINVAL;
+    }
+    memcpy(&p, evt->payload, sizeof(p));
+    return (p.mode != PWR_ACTIVE) ? scache_flush(SCACHE_FLUSH_POWER) : OS_OK;
+  }
+  case EVT_OTA_START:
+    return scache_flush(SCACHE_FLUSH_OTA);
+  case EVT_FACTORY_RESET_DONE:
+    /* Storage was wiped: pending values belong to the old state */
+    scache_lock();
+    memset(s_cache.entries, 0, sizeof(s_cache.entries));
+    s_cache.dirty = 0u;
+    s_cache.dirty_since_s = SCACHE_NO_DEADLINE;
+    if ((s_cache.journal_used || s_cache.journal_full) &&
+        s_cache.cfg.backend.journal_reset(s_cache.cfg.backend.ctx) == OS_OK) {
+      s_cache.journal_used = 0u;
+      s_cache.journal_full = 0u;
+    }
+    scache_unlock();
+    return OS_OK;
+  default:
+    return OS_OK;
+  }
+}
+
+uint16_t scache_dirty_count(void)
+{
+  return s_cache.dirty;
+}
+
+void scache_get_stats(scache_stats_t *out)
+{
+  if (out) {
+    *out = s_cache.stats;
+  }
+}
+
+void scache_reset_stats(void)
+{
+  memset(&s_cache.stats, 0, sizeof(s_cache.stats));
+}
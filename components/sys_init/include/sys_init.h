@@ -0,0 +1,86 @@
+#ifndef SYS_INIT_H
+#define SYS_INIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Module registry + dependency-graph startup
+ *
+ * Each module declares the modules it depends on. sys_init_run() starts a
+ * small pool of workers spread over the cores; every worker repeatedly picks
+ * a module whose dependencies are all done and runs its os_init_fn_t, so
+ * independent inits overlap instead of adding up.
+ *
+ * POLICY:
+ * - A module never starts before all of its dependencies finished
+ * - A failed init marks every (transitive) dependent as skipped (OS_ESTATE)
+ * - Module ids are os_module_id_t and must be unique
+ * ========================================================================== */
+
+typedef uint32_t sys_init_mask_t;
+
+#define SYS_INIT_DEP(mod) ((sys_init_mask_t)1u << (mod))
+
+#ifndef SYS_INIT_MAX_WORKERS
+#define SYS_INIT_MAX_WORKERS 4u
+#endif
+
+/* Per-worker stack reserved at build time (bytes; workers 1..MAX-1) */
+#ifndef SYS_INIT_WORKER_STACK
+#define SYS_INIT_WORKER_STACK 4096u
+#endif
+
+typedef struct {
+  os_module_id_t  id;
+  const char     *name;
+  os_init_fn_t    init;
+  sys_init_mask_t deps;   /* SYS_INIT_DEP(OS_MOD_x) | ... */
+} sys_init_module_t;
+
+typedef struct {
+  uint8_t        workers;        /* 1..SYS_INIT_MAX_WORKERS; 0 = one per core */
+  uint8_t        priority;       /* worker task priority */
+  uint16_t       stack_bytes;    /* worker task stack; 0 or above SYS_INIT_WORKER_STACK = all of it */
+  os_module_id_t ready_module;   /* milestone reported as ready_us (e.g. OS_MOD_IR) */
+} sys_init_cfg_t;
+
+typedef struct {
+  uint32_t start_us;  /* since boot (esp_timer) */
+  uint32_t end_us;
+  os_err_t err;       /* init result; OS_ESTATE if skipped because a dependency failed */
+  uint8_t  worker;
+} sys_init_timing_t;
+
+typedef struct {
+  sys_init_timing_t mod[OS_MOD_MAX];
+  uint32_t          begin_us;        /* sys_init_run() entry, since boot */
+  uint32_t          end_us;          /* all modules done, since boot */
+  uint32_t          ready_us;        /* ready_module done, since boot; 0 if it failed */
+  uint32_t          sequential_us;   /* sum of init durations (old sequential boot) */
+  uint32_t          critical_path_us;/* longest dependency chain: the parallel lower bound */
+  sys_init_mask_t   critical_path;   /* modules on that chain */
+  sys_init_mask_t   failed;          /* failed or skipped modules */
+} sys_init_report_t;
+
+/* Check ids are unique and in range, dependencies are registered and the graph is acyclic */
+os_err_t sys_init_validate(const sys_init_module_t *mods, size_t count);
+
+/* Run every init, blocking until all are done. Returns OS_EFAIL if any init
+ * failed (the report says which), OS_OK otherwise. */
+os_err_t sys_init_run(const sys_init_module_t *mods, size_t count,
+                      const sys_init_cfg_t *cfg, sys_init_report_t *report);
+
+/* Log per-module timings, the critical path and the ready milestone */
+void sys_init_log_report(const sys_init_module_t *mods, size_t count, const sys_init_report_t *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYS_INIT_H */
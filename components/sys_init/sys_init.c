@@ -0,0 +1,336 @@
+/* sys_init.c — parallel dependency-graph module startup with boot profiling
+ *
+ * Scheduling is a shared "started/done" mask pair under a spinlock. A worker
+ * that finds nothing runnable waits on the event-group bits of the modules
+ * still in flight, so a completion wakes it without polling.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sys_init.h"
+
+static const char *TAG = "SYS_INIT";
+
+#define SYS_INIT_WORKER_BIT(w)   ((EventBits_t)1u << (OS_MOD_MAX + (w)))
+
+_Static_assert(OS_MOD_MAX + SYS_INIT_MAX_WORKERS <= 24, "module and worker bits must fit one event group");
+
+typedef struct {
+  const sys_init_module_t *mods;
+  size_t                   count;
+  sys_init_report_t       *report;
+  EventGroupHandle_t       bits;
+  portMUX_TYPE             lock;
+  sys_init_mask_t          all;
+  sys_init_mask_t          started;
+  sys_init_mask_t          done;
+  sys_init_mask_t          failed;
+} sys_init_run_t;
+
+typedef struct {
+  sys_init_run_t *run;
+  uint8_t         worker;
+} sys_init_worker_arg_t;
+
+/* Worker tasks 1..MAX-1 (worker 0 is the caller), never on the heap */
+typedef struct {
+  StaticTask_t tcb[SYS_INIT_MAX_WORKERS - 1u];
+  StackType_t  stack[SYS_INIT_MAX_WORKERS - 1u][SYS_INIT_WORKER_STACK];
+} sys_init_arena_t;
+
+static sys_init_arena_t s_arena;
+
+static inline uint32_t sys_init_now_us(void)
+{
+  return (uint32_t)esp_timer_get_time();
+}
+
+/* -------------------------------------------------------------------------- */
+/* Graph helpers                                                              */
+/* -------------------------------------------------------------------------- */
+
+/* Kahn ordering; fills order[] with module indexes. OS_EINVAL on a cycle. */
+static os_err_t sys_init_topo_order(const sys_init_module_t *mods, size_t count, uint8_t *order)
+{
+  sys_init_mask_t placed = 0;
+  size_t n = 0;
+  while (n < count) {
+    size_t before = n;
+    for (size_t i = 0; i < count; i++) {
+      sys_init_mask_t bit = SYS_INIT_DEP(mods[i].id);
+      if (!(placed & bit) && !(mods[i].deps & ~placed)) {
+        order[n++] = (uint8_t)i;
+        placed |= bit;
+      }
+    }
+    if (n == before) {
+      return OS_EINVAL;
+    }
+  }
+  return OS_OK;
+}
+
+static int sys_init_index_of(const sys_init_module_t *mods, size_t count, uint32_t id)
+{
+  for (size_t i = 0; i < count; i++) {
+    if (mods[i].id == id) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+os_err_t sys_init_validate(const sys_init_module_t *mods, size_t count)
+{
+  if (!mods || count == 0 || count > OS_MOD_MAX) {
+    return OS_EINVAL;
+  }
+  sys_init_mask_t registered = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (mods[i].id >= OS_MOD_MAX || !mods[i].init || (registered & SYS_INIT_DEP(mods[i].id))) {
+      ESP_LOGE(TAG, "invalid or duplicate module id=%u", (unsigned)mods[i].id);
+      return OS_EINVAL;
+    }
+    registered |= SYS_INIT_DEP(mods[i].id);
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (mods[i].deps & ~registered) {
+      ESP_LOGE(TAG, "%s depends on unregistered modules (mask=0x%08x)", mods[i].name,
+               (unsigned)(mods[i].deps & ~registered));
+      return OS_EINVAL;
+    }
+  }
+  uint8_t order[OS_MOD_MAX];
+  if (sys_init_topo_order(mods, count, order) != OS_OK) {
+    ESP_LOGE(TAG, "dependency cycle");
+    return OS_EINVAL;
+  }
+  return OS_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Workers                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static void sys_init_worker(sys_init_run_t *run, uint8_t worker)
+{
+  for (;;) {
+    int pick = -1;
+    bool skip = false;
+    sys_init_mask_t in_flight;
+
+    portENTER_CRITICAL(&run->lock);
+    for (size_t i = 0; i < run->count; i++) {
+      const sys_init_module_t *m = &run->mods[i];
+      sys_init_mask_t bit = SYS_INIT_DEP(m->id);
+      if ((run->started & bit) || (m->deps & ~run->done)) {
+        continue;
+      }
+      run->started |= bit;
+      skip = (m->deps & run->failed) != 0;
+      pick = (int)i;
+      break;
+    }
+    bool finished = (run->started == run->all);
+    in_flight = run->started & ~run->done;
+    portEXIT_CRITICAL(&run->lock);
+
+    if (pick < 0) {
+      if (finished || !in_flight) {
+        return;
+      }
+      xEventGroupWaitBits(run->bits, (EventBits_t)in_flight, pdFALSE, pdFALSE, portMAX_DELAY);
+      continue;
+    }
+
+    const sys_init_module_t *m = &run->mods[pick];
+    sys_init_timing_t *t = &run->report->mod[m->id];
+    t->worker = worker;
+    t->start_us = sys_init_now_us();
+    t->err = skip ? OS_ESTATE : m->init();
+    t->end_us = sys_init_now_us();
+
+    sys_init_mask_t bit = SYS_INIT_DEP(m->id);
+    portENTER_CRITICAL(&run->lock);
+    if (t->err != OS_OK) {
+      run->failed |= bit;
+    }
+    run->done |= bit;
+    portEXIT_CRITICAL(&run->lock);
+    xEventGroupSetBits(run->bits, (EventBits_t)bit);
+  }
+}
+
+/* A worker parks itself and is deleted by sys_init_run(): deleting a
+ * suspended task releases its static TCB at once, so the arena can be
+ * reused by a later run. */
+static void sys_init_worker_task(void *arg)
+{
+  sys_init_worker_arg_t *w = (sys_init_worker_arg_t *)arg;
+  sys_init_worker(w->run, w->worker);
+  xEventGroupSetBits(w->run->bits, SYS_INIT_WORKER_BIT(w->worker));
+  vTaskSuspend(NULL);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Report                                                                     */
+/* -------------------------------------------------------------------------- */
+
+static void sys_init_build_report(const sys_init_module_t *mods, size_t count,
+                                  const sys_init_cfg_t *cfg, sys_init_report_t *r)
+{
+  uint8_t order[OS_MOD_MAX];
+  uint32_t chain_us[OS_MOD_MAX] = {0};
+  int8_t pred[OS_MOD_MAX];
+  int last = -1;
+
+  (void)sys_init_topo_order(mods, count, order);
+  r->sequential_us = 0;
+  r->end_us = r->begin_us;
+  for (size_t k = 0; k < count; k++) {
+    const sys_init_module_t *m = &mods[order[k]];
+    const sys_init_timing_t *t = &r->mod[m->id];
+    uint32_t dur = t->end_us - t->start_us;
+    uint32_t best = 0;
+    pred[m->id] = -1;
+    for (uint32_t d = 0; d < OS_MOD_MAX; d++) {
+      if ((m->deps & SYS_INIT_DEP(d)) && chain_us[d] >= best) {
+        best = chain_us[d];
+        pred[m->id] = (int8_t)d;
+      }
+    }
+    chain_us[m->id] = best + dur;
+    r->sequential_us += dur;
+    if (t->end_us > r->end_us) {
+      r->end_us = t->end_us;
+    }
+    if (last < 0 || chain_us[m->id] > chain_us[last]) {
+      last = m->id;
+    }
+  }
+
+  r->critical_path = 0;
+  r->critical_path_us = (last >= 0) ? chain_us[last] : 0;
+  for (int id = last; id >= 0; id = pred[id]) {
+    r->critical_path |= SYS_INIT_DEP(id);
+  }
+
+  r->ready_us = 0;
+  if (cfg && sys_init_index_of(mods, count, cfg->ready_module) >= 0 &&
+      r->mod[cfg->ready_module].err == OS_OK) {
+    r->ready_us = r->mod[cfg->ready_module].end_us;
+  }
+}
+
+void sys_init_log_report(const sys_init_module_t *mods, size_t count, const sys_init_report_t *r)
+{
+  if (!mods || !r) {
+    return;
+  }
+  ESP_LOGI(TAG, "%-10s %6s %10s %10s %s", "module", "worker", "start_us", "dur_us", "result");
+  for (size_t i = 0; i < count; i++) {
+    const sys_init_timing_t *t = &r->mod[mods[i].id];
+    ESP_LOGI(TAG, "%-10s %6u %10u %10u %s%s", mods[i].name ? mods[i].name : "?", (unsigned)t->worker,
+             (unsigned)(t->start_us - r->begin_us), (unsigned)(t->end_us - t->start_us),
+             (t->err == OS_OK) ? "ok" : (t->err == OS_ESTATE ? "skipped" : "FAILED"),
+             (r->critical_path & SYS_INIT_DEP(mods[i].id)) ? " *" : "");
+  }
+
+  char path[128];
+  size_t len = 0;
+  path[0] = '\0';
+  /* Critical path members in start order ('*' above) */
+  for (size_t i = 0; i < count && len < sizeof(path); i++) {
+    if (r->critical_path & SYS_INIT_DEP(mods[i].id)) {
+      len += (size_t)snprintf(&path[len], sizeof(path) - len, "%s%s", len ? " -> " : "",
+                              mods[i].name ? mods[i].name : "?");
+    }
+  }
+  ESP_LOGI(TAG, "boot: wall=%u us, sequential=%u us, critical path=%u us (%s)",
+           (unsigned)(r->end_us - r->begin_us), (unsigned)r->sequential_us,
+           (unsigned)r->critical_path_us, path);
+  if (r->ready_us) {
+    ESP_LOGI(TAG, "ready to send IR at %u us since boot", (unsigned)r->ready_us);
+  } else {
+    ESP_LOGW(TAG, "ready milestone not reached");
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public API                                                                 */
+/* -------------------------------------------------------------------------- */
+
+os_err_t sys_init_run(const sys_init_module_t *mods, size_t count,
+                      const sys_init_cfg_t *cfg, sys_init_report_t *report)
+{
+  os_err_t err = sys_init_validate(mods, count);
+  if (err != OS_OK || !report) {
+    return OS_EINVAL;
+  }
+  memset(report, 0, sizeof(*report));
+
+  sys_init_run_t run = {
+    .mods = mods,
+    .count = count,
+    .report = report,
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+  };
+  for (size_t i = 0; i < count; i++) {
+    run.all |= SYS_INIT_DEP(mods[i].id);
+  }
+  StaticEventGroup_t bits_buf;
+  run.bits = xEventGroupCreateStatic(&bits_buf);
+  if (!run.bits) {
+    return OS_ENOMEM;
+  }
+
+  uint8_t workers = (cfg && cfg->workers) ? cfg->workers : (uint8_t)portNUM_PROCESSORS;
+  if (workers > SYS_INIT_MAX_WORKERS) {
+    workers = SYS_INIT_MAX_WORKERS;
+  }
+  uint32_t stack = (cfg && cfg->stack_bytes && cfg->stack_bytes < SYS_INIT_WORKER_STACK) ? cfg->stack_bytes
+                                                                                      : SYS_INIT_WORKER_STACK;
+  UBaseType_t prio = cfg ? cfg->priority : 1u;
+
+  report->begin_us = sys_init_now_us();
+
+  /* Worker 0 is the caller; the others are spread over the remaining cores */
+  sys_init_worker_arg_t args[SYS_INIT_MAX_WORKERS];
+  TaskHandle_t tasks[SYS_INIT_MAX_WORKERS] = {0};
+  EventBits_t wait_bits = 0;
+  for (uint8_t w = 1; w < workers; w++) {
+    args[w] = (sys_init_worker_arg_t) { .run = &run, .worker = w };
+    tasks[w] = xTaskCreateStaticPinnedToCore(sys_init_worker_task, "sys_init", stack, &args[w], prio,
+                                             s_arena.stack[w - 1u], &s_arena.tcb[w - 1u],
+                                             (BaseType_t)(w % portNUM_PROCESSORS));
+    if (tasks[w]) {
+      wait_bits |= SYS_INIT_WORKER_BIT(w);
+    } else {
+      ESP_LOGW(TAG, "worker %u not started, continuing with fewer workers", (unsigned)w);
+    }
+  }
+  sys_init_worker(&run, 0);
+  if (wait_bits) {
+    xEventGroupWaitBits(run.bits, wait_bits, pdFALSE, pdTRUE, portMAX_DELAY);
+  }
+  for (uint8_t w = 1; w < workers; w++) {
+    if (!tasks[w]) {
+      continue;
+    }
+    while (eTaskGetState(tasks[w]) != eSuspended) {
+      vTaskDelay(1);
+    }
+    vTaskDelete(tasks[w]);
+  }
+  vEventGroupDelete(run.bits);
+
+  report->failed = run.failed;
+  sys_init_build_report(mods, count, cfg, report);
+  return run.failed ? OS_EFAIL : OS_OK;
+}
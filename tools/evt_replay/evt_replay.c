@@ -0,0 +1,424 @@
+/* evt_replay.c — re-drive an event journal dump through the host event bus and orchestrator
+ *
+ * The dump is memory-mapped and decoded in place. Each record is published
+ * through the real evt_bus_core.c at its recorded timestamp (virtual clock)
+ * and dispatched immediately, with orchestrator.c as the bus gate in front of
+ * every event as on the device. Runs as fast as the host allows. A second pass feeds
+ * the same events straight into orch_process(), without the bus, for the
+ * orchestrator's own events/s:
+ *
+ *   evt_replay <dump> [iterations] [-v]     replay, print transitions with -v
+ *   evt_replay --synth <out> [steps] [ring] write a dump of mock traffic
+ *
+ * Events the orchestrator published on the device (src OS_MOD_ORCH) are not
+ * re-injected: the replayed orchestrator regenerates them, and the counts are
+ * compared. Commands do not travel on the bus and are not in the journal.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "evt_bus_core.h"
+#include "evt_journal.h"
+#include "orchestrator.h"
+
+#define REPLAY_QUEUE_DEPTH  64u
+#define REPLAY_SYNTH_RING   (256u * 1024u)
+
+/* -------------------------------------------------------------------------- */
+/* Host bus port: array queue, no locking, virtual clock                      */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  evt_bus_item_t q[REPLAY_QUEUE_DEPTH];
+  uint16_t       head;
+  uint16_t       count;
+  uint32_t       clock_us;  /* latency clock */
+  uint32_t       clock_ms;  /* event timestamps */
+} replay_port_t;
+
+static replay_port_t g_port;
+
+static bool port_enqueue(const evt_bus_item_t *item, bool from_isr, uint16_t *depth, void *ctx)
+{
+  (void)from_isr;
+  (void)ctx;
+  if (g_port.count >= REPLAY_QUEUE_DEPTH) {
+    return false;
+  }
+  g_port.q[(g_port.head + g_port.count) % REPLAY_QUEUE_DEPTH] = *item;
+  *depth = ++g_port.count;
+  return true;
+}
+
+static bool port_dequeue(evt_bus_item_t *item, void *ctx)
+{
+  (void)ctx;
+  if (!g_port.count) {
+    return false;
+  }
+  *item = g_port.q[g_port.head];
+  g_port.head = (uint16_t)((g_port.head + 1u) % REPLAY_QUEUE_DEPTH);
+  g_port.count--;
+  return true;
+}
+
+static uint16_t port_depth(void *ctx)
+{
+  (void)ctx;
+  return g_port.count;
+}
+
+static void port_nop(void *ctx)
+{
+  (void)ctx;
+}
+
+static uint32_t port_now_us(void *ctx)
+{
+  (void)ctx;
+  return g_port.clock_us;
+}
+
+static uint32_t port_now_ms(void *ctx)
+{
+  (void)ctx;
+  return g_port.clock_ms;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Replay harness                                                             */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  bool     verbose;
+  uint32_t transitions;
+  uint32_t orch_published;  /* events regenerated by the replayed orchestrator */
+  uint32_t hash;            /* FNV-1a over (ts, from, to) of every transition */
+} replay_run_t;
+
+static replay_run_t *g_run;
+
+static void replay_hash(uint32_t v)
+{
+  for (int i = 0; i < 4; i++) {
+    g_run->hash = (g_run->hash ^ ((v >> (8 * i)) & 0xFFu)) * 16777619u;
+  }
+}
+
+static void replay_orch_publish(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len)
+{
+  g_run->orch_published++;
+  (void)evt_bus_publish(src, id, payload, len);
+}
+
+static void replay_state_changed(orch_state_t from, orch_state_t to, void *user_ctx)
+{
+  (void)user_ctx;
+  uint32_t ts_ms = g_port.clock_ms;
+  g_run->transitions++;
+  replay_hash(ts_ms);
+  replay_hash(((uint32_t)from << 8) | (uint32_t)to);
+  if (g_run->verbose) {
+    printf("  %10u ms  %s -> %s\n", (unsigned)ts_ms, orch_state_name(from), orch_state_name(to));
+  }
+}
+
+static bool replay_orch_gate(const os_evt_t *evt, void *gate_ctx)
+{
+  (void)gate_ctx;
+  return orch_process(evt) != OS_EPERM;
+}
+
+static int replay_setup(replay_run_t *run)
+{
+  const evt_bus_port_t port = {
+    .enqueue = port_enqueue,
+    .dequeue = port_dequeue,
+    .depth = port_depth,
+    .lock = port_nop,
+    .unlock = port_nop,
+    .now_us = port_now_us,
+    .now_ms = port_now_ms,
+  };
+  const orch_config_t orch_cfg = {
+    .publish = replay_orch_publish,
+    .on_state_changed = replay_state_changed,
+  };
+  memset(&g_port, 0, sizeof(g_port));
+  g_run = run;
+  if (evt_bus_init(&port, NULL) != OS_OK || orch_init(&orch_cfg) != OS_OK) {
+    return -1;
+  }
+  evt_bus_set_gate(replay_orch_gate, NULL);
+  return 0;
+}
+
+static double replay_now_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* One pass over the journal; returns the number of records or -1 on a malformed record */
+static long replay_pass(const evt_journal_hdr_t *hdr, const uint8_t *records, uint32_t *recorded_orch)
+{
+  evt_journal_reader_t rd;
+  os_evt_t evt;
+  os_err_t err;
+  long n = 0;
+
+  evt_journal_reader_init(&rd, hdr, records);
+  while ((err = evt_journal_next(&rd, &evt)) == OS_OK) {
+    n++;
+    if (evt.src == OS_MOD_ORCH) {
+      (*recorded_orch)++;
+      continue;
+    }
+    g_port.clock_ms = evt.ts_ms;
+    g_port.clock_us = evt.ts_ms * 1000u;
+    if (evt_bus_publish(evt.src, evt.id, evt.payload, evt.len) != OS_OK) {
+      fprintf(stderr, "publish failed at record %ld (id=%u)\n", n, (unsigned)evt.id);
+    }
+    evt_bus_dispatch_all();
+  }
+  if (err != OS_ESTATE) {
+    fprintf(stderr, "malformed record at offset %u\n", (unsigned)rd.pos);
+    return -1;
+  }
+  return n;
+}
+
+static int replay_file(const char *path, uint32_t iterations, bool verbose)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    perror(path);
+    return 1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    fprintf(stderr, "%s: empty or unreadable\n", path);
+    close(fd);
+    return 1;
+  }
+  const void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+
+  evt_journal_hdr_t hdr;
+  const uint8_t *records = NULL;
+  if (evt_journal_parse(map, (uint32_t)st.st_size, &hdr, &records) != OS_OK) {
+    fprintf(stderr, "%s: not an event journal dump\n", path);
+    return 1;
+  }
+  printf("%s: %u records, %u bytes (%.2f bytes/event, os_evt_t is %zu), %u dropped on device\n",
+         path, (unsigned)hdr.records, (unsigned)hdr.bytes,
+         hdr.records ? (double)hdr.bytes / hdr.records : 0.0, sizeof(os_evt_t), (unsigned)hdr.dropped);
+
+  /* Decode only */
+  double t0 = replay_now_s();
+  long decoded = 0;
+  for (uint32_t it = 0; it < iterations; it++) {
+    evt_journal_reader_t rd;
+    os_evt_t evt;
+    evt_journal_reader_init(&rd, &hdr, records);
+    while (evt_journal_next(&rd, &evt) == OS_OK) {
+      decoded++;
+    }
+  }
+  double decode_s = replay_now_s() - t0;
+
+  /* Orchestrator only: the decoded events straight into orch_process(), no bus */
+  os_evt_t *evts = malloc((size_t)(hdr.records ? hdr.records : 1u) * sizeof(*evts));
+  if (!evts) {
+    return 1;
+  }
+  uint32_t evt_num = 0;
+  {
+    evt_journal_reader_t rd;
+    os_evt_t evt;
+    evt_journal_reader_init(&rd, &hdr, records);
+    while (evt_num < hdr.records && evt_journal_next(&rd, &evt) == OS_OK) {
+      if (evt.src != OS_MOD_ORCH) {
+        evts[evt_num++] = evt;
+      }
+    }
+  }
+  double orch_s = 0.0;
+  uint32_t orch_rejected = 0;
+  for (uint32_t it = 0; it < iterations; it++) {
+    (void)orch_init(NULL);
+    t0 = replay_now_s();
+    for (uint32_t i = 0; i < evt_num; i++) {
+      orch_rejected += orch_process(&evts[i]) == OS_EPERM;
+    }
+    orch_s += replay_now_s() - t0;
+  }
+  free(evts);
+
+  /* Full replay, first run verbose */
+  uint32_t first_hash = 0;
+  bool deterministic = true;
+  replay_run_t run = {0};
+  uint32_t recorded_orch = 0;
+  long n = 0;
+  double replay_s = 0.0;
+  for (uint32_t it = 0; it < iterations; it++) {
+    memset(&run, 0, sizeof(run));
+    run.verbose = verbose && it == 0u;
+    run.hash = 2166136261u;
+    recorded_orch = 0;
+    if (replay_setup(&run) != 0) {
+      fprintf(stderr, "bus/orchestrator setup failed\n");
+      return 1;
+    }
+    t0 = replay_now_s();
+    n = replay_pass(&hdr, records, &recorded_orch);
+    replay_s += replay_now_s() - t0;
+    if (n < 0) {
+      return 1;
+    }
+    if (it == 0u) {
+      first_hash = run.hash;
+    } else if (run.hash != first_hash) {
+      deterministic = false;
+    }
+  }
+
+  orch_stats_t os;
+  evt_bus_stats_t bs;
+  orch_get_stats(&os);
+  evt_bus_get_stats(&bs);
+  printf("replay: %ld records, span %u ms, %u iterations\n", n,
+         (unsigned)(hdr.records ? g_port.clock_ms - hdr.base_ts_ms : 0u), (unsigned)iterations);
+  printf("  decode     %8.1f ns/event\n", decoded ? decode_s * 1e9 / (double)decoded : 0.0);
+  printf("  orch only  %8.1f ns/event, %.1f M events/s (orch_process(), %u rejected per pass)\n",
+         evt_num ? orch_s * 1e9 / ((double)evt_num * iterations) : 0.0,
+         orch_s > 0.0 ? (double)evt_num * iterations / orch_s / 1e6 : 0.0, (unsigned)(orch_rejected / iterations));
+  printf("  replay     %8.1f ns/event (publish + dispatch + orchestrator)\n",
+         n ? replay_s * 1e9 / ((double)n * iterations) : 0.0);
+  printf("  orchestrator: final %s, %u transitions, %u events, %u rejected (%u withheld by the gate)\n",
+         orch_state_name(orch_get_state()), (unsigned)run.transitions, (unsigned)os.events, (unsigned)os.rejected,
+         (unsigned)bs.gated);
+  printf("  orchestrator output: %u recorded, %u regenerated%s\n", (unsigned)recorded_orch,
+         (unsigned)run.orch_published, recorded_orch == run.orch_published ? "" : " (DIFFERS)");
+  printf("  bus: %u dispatched, %u dropped\n", (unsigned)bs.dispatched, (unsigned)bs.dropped);
+  printf("  deterministic across iterations: %s (transition hash %08x)\n", deterministic ? "yes" : "NO",
+         (unsigned)first_hash);
+  return deterministic ? 0 : 1;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Synthetic dump: the mock traffic of apps/system_demo, journaled on the bus */
+/* -------------------------------------------------------------------------- */
+
+static os_err_t synth_write(const void *data, uint32_t len, void *ctx)
+{
+  return (fwrite(data, 1, len, (FILE *)ctx) == len) ? OS_OK : OS_EFAIL;
+}
+
+static void synth_publish(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len)
+{
+  (void)evt_bus_publish(src, id, payload, len);
+  evt_bus_dispatch_all();
+}
+
+static int synth_file(const char *path, uint32_t steps, uint32_t ring_bytes)
+{
+  static uint8_t ring[REPLAY_SYNTH_RING];
+  const evt_journal_config_t jcfg = { .buf = ring, .cap = ring_bytes };
+  replay_run_t run = { .hash = 2166136261u };
+  if (replay_setup(&run) != 0 || evt_journal_init(&jcfg) != OS_OK) {
+    return 1;
+  }
+  evt_bus_set_trace(evt_journal_trace, NULL);
+
+  uint8_t authed = 0, ble = 0, pwr = 0;
+  uint32_t seed = 0x2545F491u;
+  for (uint32_t step = 1; step <= steps; step++) {
+    g_port.clock_ms = step * 100u;  /* 100 ms steps */
+    g_port.clock_us = g_port.clock_ms * 1000u;
+    seed = seed * 1664525u + 1013904223u;
+
+    if ((step % 5u) == 0u) {
+      ble ^= 1u;
+      evt_ble_conn_changed_t p = { .state = ble ? OS_LINK_UP : OS_LINK_DOWN };
+      synth_publish(OS_MOD_BLE, EVT_BLE_CONN_CHANGED, &p, sizeof(p));
+    }
+    if ((step % 7u) == 0u) {
+      authed ^= 1u;
+      evt_auth_state_changed_t p = { .authed = authed };
+      synth_publish(OS_MOD_AUTH, EVT_AUTH_STATE_CHANGED, &p, sizeof(p));
+    }
+    if ((step % 11u) == 0u) {
+      evt_schedule_due_t p = { .schedule_id = seed % 16u };
+      synth_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, &p, sizeof(p));
+      synth_publish(OS_MOD_IR, EVT_IR_SEND_STARTED, NULL, 0);
+      evt_ir_send_result_t r = { .result = (seed & 0x100u) ? IR_RES_FAIL : IR_RES_OK };
+      synth_publish(OS_MOD_IR, EVT_IR_SEND_RESULT, &r, sizeof(r));
+    }
+    if ((step % 23u) == 0u) {
+      pwr = (pwr == PWR_ACTIVE) ? PWR_IDLE : PWR_ACTIVE;
+      evt_power_mode_changed_t p = { .mode = (os_power_mode_t)pwr };
+      synth_publish(OS_MOD_POWER, EVT_POWER_MODE_CHANGED, &p, sizeof(p));
+    }
+    if ((step % 100u) == 0u) {
+      (void)evt_bus_emit_health_tick();
+      evt_bus_dispatch_all();
+    }
+  }
+
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    perror(path);
+    return 1;
+  }
+  os_err_t err = evt_journal_export(synth_write, f);
+  fclose(f);
+
+  evt_journal_stats_t js;
+  evt_journal_get_stats(&js);
+  printf("%s: %u steps, %u events, %llu bytes (%.2f bytes/event vs %zu for os_evt_t), %u dropped, %u transitions\n",
+         path, (unsigned)steps, (unsigned)js.records, (unsigned long long)js.bytes_total,
+         js.records ? (double)js.bytes_total / js.records : 0.0, sizeof(os_evt_t), (unsigned)js.dropped,
+         (unsigned)run.transitions);
+  printf("transition hash %08x\n", (unsigned)run.hash);
+  return err == OS_OK ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc >= 3 && strcmp(argv[1], "--synth") == 0) {
+    uint32_t steps = (argc > 3) ? (uint32_t)atoi(argv[3]) : 10000u;
+    uint32_t ring_bytes = (argc > 4) ? (uint32_t)atoi(argv[4]) : REPLAY_SYNTH_RING;
+    if (steps == 0u || steps > 40000u || ring_bytes > REPLAY_SYNTH_RING) {
+      fprintf(stderr, "steps must be 1..40000 and ring <= %u bytes\n", (unsigned)REPLAY_SYNTH_RING);
+      return 2;
+    }
+    return synth_file(argv[2], steps, ring_bytes);
+  }
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <dump> [iterations] [-v]\n       %s --synth <out> [steps] [ring_bytes]\n", argv[0], argv[0]);
+    return 2;
+  }
+  uint32_t iterations = 1u;
+  bool verbose = false;
+  for (int i = 2; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else if (atoi(argv[i]) > 0) {
+      iterations = (uint32_t)atoi(argv[i]);
+    }
+  }
+  return replay_file(argv[1], iterations, verbose);
+}
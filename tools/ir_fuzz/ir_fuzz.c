@@ -0,0 +1,662 @@
+/* ir_fuzz.c — noise-injection accuracy and throughput harness for the IR decode path
+ *
+ * NEC frames with random address/command are produced by the device encoder
+ * (ir_nec_encoder.c on a RAM channel, rmt_host.c), turned into what the RX
+ * channel captures (active-low receiver: levels inverted, the ending space
+ * cut by the idle threshold), then damaged:
+ *
+ *   jitter      every duration += uniform [-J, +J] us    (swept 0..-j by -t)
+ *   bias        marks += B, spaces -= B                  (receiver AGC stretch)
+ *   glitch      per symbol, a 20..199 us pulse splits a mark or a space
+ *   truncate    per frame, the capture stops at a random duration
+ *   invert      per frame, the levels are not inverted (wrong receiver polarity)
+ *
+ * Each frame goes through ir_decoder_decode() (default decoders) and the
+ * replay path ir_symbols_normalize_frame(). A decode is ok when it returns
+ * the sent code, wrong when it returns anything else (false accept).
+ * A normalize is ok when the frame is restored exactly to what the clean
+ * capture normalizes to. Every frame also goes through ir_screen_frame(),
+ * the RX-task noise screen; a screen loss is a frame the decoder would have
+ * got right but the screen rejected. Two kinds of non-IR input are then fed
+ * to the screen and the decoders: random symbol soup, and ambient light
+ * (short pulses at random intervals, as sunlight and lamps give a receiver).
+ * Last, the sweep is repeated for every registered protocol, with frames
+ * built from the decoders' timing specs (Samsung, Sony 12/15/20 bit, RC5,
+ * RC6 mode 0, a 48-bit pulse distance remote) and one screen loss count
+ * per protocol.
+ *
+ *   ir_fuzz [-n frames] [-j max_jitter] [-t step] [-b bias] [-g p_glitch]
+ *           [-c p_truncate] [-i p_invert] [-s seed] [--csv]
+ *
+ * Tolerances are build-time macros; CMake builds one binary per margin
+ * (ir_fuzz_m<N>, IR_FUZZ_MARGINS) and passes IR_FUZZ_DEFINES to all of them.
+ * Exits 1 if an undamaged frame of any protocol is not screened in, decoded
+ * and restored exactly.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ir_decoder.h"
+#include "ir_screen.h"
+#include "ir_nec_encoder.h"
+#include "ir_nec_timing.h"
+#include "ir_symbol_kernels.h"
+#include "rmt_host.h"
+
+#ifndef IR_DECODE_MARGIN
+#define IR_DECODE_MARGIN 300  /* ir_decoder.c default, for the report header only */
+#endif
+
+#define FUZZ_RESOLUTION_HZ  1000000u
+#define FUZZ_MAX_SYMBOLS    64u            /* MAX_FRAME_SIZE of the RX buffer */
+#define FUZZ_MAX_DURATIONS  (2u * FUZZ_MAX_SYMBOLS)
+#define FUZZ_BATCH          1024u
+#define FUZZ_GLITCH_MIN_US  20u
+#define FUZZ_GLITCH_SPAN_US 180u
+#define FUZZ_AMBIENT_MARK_US  230u   /* ambient pulses: 20..249 us marks */
+#define FUZZ_AMBIENT_SPACE_US 8000u  /* ... 100..8099 us apart, below the 12 ms idle cut */
+
+/* Timing specs of the generated non-NEC frames, in us (as ir_decoder.c) */
+#define FUZZ_SAMSUNG_LEADER_US    4500u
+#define FUZZ_SONY_LEADER_MARK_US  2400u
+#define FUZZ_SONY_UNIT_US         600u
+#define FUZZ_RC5_HALF_BIT_US      889u
+#define FUZZ_RC5_HALF_BITS        28u
+#define FUZZ_RC6_LEADER_MARK_US   2666u
+#define FUZZ_RC6_LEADER_SPACE_US  889u
+#define FUZZ_RC6_UNIT_US          444u
+#define FUZZ_RC6_UNITS            44u
+#define FUZZ_PD_LEADER_MARK_US    3456u  /* 48-bit Kaseikyo-style remote, decoded by the pulse distance fallback */
+#define FUZZ_PD_LEADER_SPACE_US   1728u
+#define FUZZ_PD_MARK_US           432u
+#define FUZZ_PD_ONE_US            1296u
+#define FUZZ_PD_BITS              48u
+
+typedef struct {
+  uint32_t frames;
+  uint32_t jitter_max;
+  uint32_t jitter_step;
+  int32_t  bias;
+  double   p_glitch;
+  double   p_truncate;
+  double   p_invert;
+  uint64_t seed;
+  int      csv;
+} fuzz_config_t;
+
+typedef struct {
+  rmt_symbol_word_t sym[FUZZ_MAX_SYMBOLS];
+  size_t            num;
+  rmt_symbol_word_t ref[FUZZ_MAX_SYMBOLS];  /* clean capture, normalized */
+  size_t            ref_num;
+  uint8_t           protocol;   /* ir_protocol_t sent */
+  uint32_t          address;
+  uint32_t          command;
+} fuzz_frame_t;
+
+/* Clean capture of one random frame: durations from the first mark, the ending space cut */
+typedef size_t (*fuzz_gen_fn_t)(uint32_t *dur, fuzz_frame_t *f);
+
+typedef struct {
+  uint64_t frames;
+  uint64_t decode_ok;
+  uint64_t decode_reject;
+  uint64_t decode_wrong_code;   /* sent protocol, other address/command */
+  uint64_t decode_wrong_other;  /* another protocol */
+  uint64_t restore_ok;
+  uint64_t screen_reject;
+  uint64_t screen_lost;         /* rejected, but decoded to the sent code */
+  double   screen_s;
+  double   decode_s;
+  double   normalize_s;
+} fuzz_result_t;
+
+static fuzz_frame_t g_batch[FUZZ_BATCH];
+static const ir_decoder_t *g_decoded[FUZZ_BATCH];
+static ir_screen_verdict_t g_verdicts[FUZZ_BATCH];
+static ir_scan_code_t g_codes[FUZZ_BATCH];
+static rmt_symbol_word_t g_normalized[FUZZ_BATCH][FUZZ_MAX_SYMBOLS];
+
+static struct rmt_channel_t g_tx;
+static rmt_encoder_handle_t g_nec_encoder;
+static uint64_t g_rng;
+
+/* -------------------------------------------------------------------------- */
+/* Helpers                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t fuzz_rand(void)
+{
+  /* xorshift64* */
+  g_rng ^= g_rng >> 12;
+  g_rng ^= g_rng << 25;
+  g_rng ^= g_rng >> 27;
+  return (uint32_t)((g_rng * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static uint32_t fuzz_below(uint32_t n)
+{
+  return (uint32_t)(((uint64_t)fuzz_rand() * n) >> 32);
+}
+
+static int fuzz_chance(double p)
+{
+  return p > 0.0 && fuzz_rand() < (uint32_t)(p * 4294967295.0);
+}
+
+static double fuzz_now_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint32_t fuzz_clamp(int32_t d)
+{
+  return d < 1 ? 1u : (d > 0x7FFF ? 0x7FFFu : (uint32_t)d);
+}
+
+/* Durations alternate mark, space, mark...; an odd count leaves a 0 space, as the RX idle cut does */
+static size_t fuzz_pack(const uint32_t *dur, size_t dur_num, unsigned mark_level, rmt_symbol_word_t *out)
+{
+  size_t num = (dur_num + 1u) / 2u;
+  for (size_t i = 0; i < num; i++) {
+    out[i].level0 = mark_level;
+    out[i].duration0 = dur[2u * i];
+    out[i].level1 = !mark_level;
+    out[i].duration1 = (2u * i + 1u < dur_num) ? dur[2u * i + 1u] : 0u;
+  }
+  return num;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Frame generation                                                           */
+/* -------------------------------------------------------------------------- */
+
+/* NEC through the device encoder */
+static size_t fuzz_gen_nec(uint32_t *dur, fuzz_frame_t *f)
+{
+  rmt_symbol_word_t tx[FUZZ_MAX_SYMBOLS];
+  ir_nec_scan_code_t code = {
+    .address = (uint16_t)fuzz_rand(),
+    .command = (uint16_t)fuzz_rand(),
+  };
+  size_t tx_num = rmt_host_transmit(&g_tx, g_nec_encoder, &code, sizeof(code), tx, FUZZ_MAX_SYMBOLS);
+  if (!tx_num) {
+    fprintf(stderr, "encoder produced no symbols\n");
+    exit(1);
+  }
+
+  /* What the receiver sees: every duration but the ending space, which the idle threshold cuts */
+  size_t dur_num = 0;
+  for (size_t i = 0; i < tx_num; i++) {
+    dur[dur_num++] = tx[i].duration0;
+    if (i + 1u < tx_num) {
+      dur[dur_num++] = tx[i].duration1;
+    }
+  }
+  f->protocol = IR_PROTO_NEC;
+  f->address = code.address;
+  f->command = code.command;
+  return dur_num;
+}
+
+/* Leader, LSB-first pulse distance bits, stop mark */
+static size_t fuzz_pulse_distance(uint32_t *dur, uint32_t lead_mark, uint32_t lead_space, uint32_t mark,
+                                  uint32_t space0, uint32_t space1, uint64_t value, size_t bits)
+{
+  size_t n = 0;
+  dur[n++] = lead_mark;
+  dur[n++] = lead_space;
+  for (size_t i = 0; i < bits; i++) {
+    dur[n++] = mark;
+    dur[n++] = ((value >> i) & 1u) ? space1 : space0;
+  }
+  dur[n++] = mark;
+  return n;
+}
+
+/* Level stream (1 = mark) to durations, from the first mark; the ending space is cut */
+static size_t fuzz_runs(const uint8_t *levels, size_t level_num, uint32_t unit_us, uint32_t *dur)
+{
+  size_t n = 0;
+  size_t i = 0;
+  while (i < level_num && !levels[i]) {
+    i++;
+  }
+  while (i < level_num) {
+    size_t run = 1;
+    while (i + run < level_num && levels[i + run] == levels[i]) {
+      run++;
+    }
+    if (levels[i] || i + run < level_num) {
+      dur[n++] = (uint32_t)run * unit_us;
+    }
+    i += run;
+  }
+  return n;
+}
+
+static size_t fuzz_gen_samsung(uint32_t *dur, fuzz_frame_t *f)
+{
+  uint32_t payload = fuzz_rand();
+  f->protocol = IR_PROTO_SAMSUNG;
+  f->address = payload & 0xFFFFu;
+  f->command = payload >> 16;
+  return fuzz_pulse_distance(dur, FUZZ_SAMSUNG_LEADER_US, FUZZ_SAMSUNG_LEADER_US, NEC_PAYLOAD_ZERO_DURATION_0,
+                             NEC_PAYLOAD_ZERO_DURATION_1, NEC_PAYLOAD_ONE_DURATION_1, payload, 32u);
+}
+
+/* Pulse width: the mark carries the bit, 12, 15 or 20 bits */
+static size_t fuzz_gen_sony(uint32_t *dur, fuzz_frame_t *f)
+{
+  static const size_t widths[] = { 12u, 15u, 20u };
+  size_t bits = widths[fuzz_below(3u)];
+  uint32_t payload = fuzz_rand() & ((1u << bits) - 1u);
+  size_t n = 0;
+  dur[n++] = FUZZ_SONY_LEADER_MARK_US;
+  dur[n++] = FUZZ_SONY_UNIT_US;
+  for (size_t i = 0; i < bits; i++) {
+    dur[n++] = ((payload >> i) & 1u) ? 2u * FUZZ_SONY_UNIT_US : FUZZ_SONY_UNIT_US;
+    if (i + 1u < bits) {
+      dur[n++] = FUZZ_SONY_UNIT_US;
+    }
+  }
+  f->protocol = IR_PROTO_SONY;
+  f->address = payload >> 7;
+  f->command = payload & 0x7Fu;
+  return n;
+}
+
+/* Manchester, 1 = space then mark: S1, S2 (inverted command bit 6), toggle, 5 address, 6 command bits */
+static size_t fuzz_gen_rc5(uint32_t *dur, fuzz_frame_t *f)
+{
+  uint32_t address = fuzz_below(32u);
+  uint32_t command = fuzz_below(128u);
+  uint32_t frame = (1u << 13) | ((command & 0x40u) ? 0u : (1u << 12)) | (fuzz_below(2u) << 11) |
+                   (address << 6) | (command & 0x3Fu);
+  uint8_t levels[FUZZ_RC5_HALF_BITS];
+  for (size_t bit = 0; bit < FUZZ_RC5_HALF_BITS / 2u; bit++) {
+    uint8_t one = (frame >> (13u - bit)) & 1u;
+    levels[2u * bit] = !one;
+    levels[2u * bit + 1u] = one;
+  }
+  f->protocol = IR_PROTO_RC5;
+  f->address = address;
+  f->command = command;
+  return fuzz_runs(levels, FUZZ_RC5_HALF_BITS, FUZZ_RC5_HALF_BIT_US, dur);
+}
+
+/* Leader, then Manchester units, 1 = mark then space: start, mode 0, double width toggle, 8 address, 8 command */
+static size_t fuzz_gen_rc6(uint32_t *dur, fuzz_frame_t *f)
+{
+  uint32_t address = fuzz_below(256u);
+  uint32_t command = fuzz_below(256u);
+  uint32_t frame = (1u << 20) | (fuzz_below(2u) << 16) | (address << 8) | command;
+  uint8_t levels[FUZZ_RC6_UNITS];
+  size_t pos = 0;
+  for (size_t bit = 0; bit < 21u; bit++) {
+    size_t width = (bit == 4u) ? 2u : 1u;
+    uint8_t one = (frame >> (20u - bit)) & 1u;
+    for (size_t u = 0; u < width; u++) {
+      levels[pos + u] = one;
+      levels[pos + width + u] = !one;
+    }
+    pos += 2u * width;
+  }
+  dur[0] = FUZZ_RC6_LEADER_MARK_US;
+  dur[1] = FUZZ_RC6_LEADER_SPACE_US;
+  f->protocol = IR_PROTO_RC6;
+  f->address = address;
+  f->command = command;
+  return 2u + fuzz_runs(levels, FUZZ_RC6_UNITS, FUZZ_RC6_UNIT_US, &dur[2]);
+}
+
+/* A remote no dedicated decoder knows */
+static size_t fuzz_gen_pulse_distance(uint32_t *dur, fuzz_frame_t *f)
+{
+  uint64_t value = (((uint64_t)fuzz_rand() << 32) | fuzz_rand()) & ((1ull << FUZZ_PD_BITS) - 1u);
+  f->protocol = IR_PROTO_PULSE_DISTANCE;
+  f->address = (uint32_t)(value >> 32);
+  f->command = (uint32_t)value;
+  return fuzz_pulse_distance(dur, FUZZ_PD_LEADER_MARK_US, FUZZ_PD_LEADER_SPACE_US, FUZZ_PD_MARK_US,
+                             FUZZ_PD_MARK_US, FUZZ_PD_ONE_US, value, FUZZ_PD_BITS);
+}
+
+/* One generator per registered protocol */
+static const fuzz_gen_fn_t s_gens[IR_PROTO_MAX] = {
+  [IR_PROTO_NEC] = fuzz_gen_nec,
+  [IR_PROTO_SAMSUNG] = fuzz_gen_samsung,
+  [IR_PROTO_SONY] = fuzz_gen_sony,
+  [IR_PROTO_RC5] = fuzz_gen_rc5,
+  [IR_PROTO_RC6] = fuzz_gen_rc6,
+  [IR_PROTO_PULSE_DISTANCE] = fuzz_gen_pulse_distance,
+};
+
+static void fuzz_make_frame(const fuzz_config_t *cfg, fuzz_gen_fn_t gen, uint32_t jitter, fuzz_frame_t *f)
+{
+  uint32_t dur[FUZZ_MAX_DURATIONS];
+  size_t dur_num = gen(dur, f);
+  f->ref_num = fuzz_pack(dur, dur_num, 0u, f->ref);
+  ir_symbols_normalize_frame(f->ref, f->ref, f->ref_num);
+
+  for (size_t k = 0; k < dur_num; k++) {
+    int32_t d = (int32_t)dur[k] + ((k & 1u) ? -cfg->bias : cfg->bias);
+    if (jitter) {
+      d += (int32_t)fuzz_below(2u * jitter + 1u) - (int32_t)jitter;
+    }
+    dur[k] = fuzz_clamp(d);
+  }
+
+  if (cfg->p_glitch > 0.0) {
+    for (size_t k = 0; k < dur_num && dur_num + 2u <= FUZZ_MAX_DURATIONS; k++) {
+      uint32_t w = FUZZ_GLITCH_MIN_US + fuzz_below(FUZZ_GLITCH_SPAN_US);
+      if (!fuzz_chance(cfg->p_glitch / 2.0) || dur[k] < w + 2u) {
+        continue;  /* p_glitch is per symbol, a symbol has two durations */
+      }
+      uint32_t head = 1u + fuzz_below(dur[k] - w - 1u);
+      memmove(&dur[k + 3u], &dur[k + 1u], (dur_num - k - 1u) * sizeof(dur[0]));
+      dur[k + 1u] = w;
+      dur[k + 2u] = dur[k] - head - w;
+      dur[k] = head;
+      dur_num += 2u;
+      k += 2u;
+    }
+  }
+
+  if (dur_num > 2u && fuzz_chance(cfg->p_truncate)) {
+    dur_num = 2u + fuzz_below((uint32_t)dur_num - 2u);
+  }
+
+  if (dur_num > 2u * FUZZ_MAX_SYMBOLS - 1u) {
+    dur_num = 2u * FUZZ_MAX_SYMBOLS - 1u;  /* RX buffer full */
+  }
+  f->num = fuzz_pack(dur, dur_num, fuzz_chance(cfg->p_invert) ? 1u : 0u, f->sym);
+}
+
+static void fuzz_make_garbage(fuzz_frame_t *f)
+{
+  f->num = 2u + fuzz_below(FUZZ_MAX_SYMBOLS - 1u);
+  for (size_t i = 0; i < f->num; i++) {
+    f->sym[i].val = IR_SYMBOL_PACK(50u + fuzz_below(10000u), 50u + fuzz_below(10000u)) | 0x80000000u;
+  }
+  f->sym[f->num - 1u].duration1 = 0;
+}
+
+static void fuzz_make_ambient(fuzz_frame_t *f)
+{
+  uint32_t dur[FUZZ_MAX_DURATIONS];
+  size_t dur_num = 1u + fuzz_below(FUZZ_MAX_DURATIONS - 1u);
+  for (size_t k = 0; k < dur_num; k++) {
+    dur[k] = (k & 1u) ? 100u + fuzz_below(FUZZ_AMBIENT_SPACE_US) : FUZZ_GLITCH_MIN_US + fuzz_below(FUZZ_AMBIENT_MARK_US);
+  }
+  f->num = fuzz_pack(dur, dur_num, 0u, f->sym);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Sweep                                                                      */
+/* -------------------------------------------------------------------------- */
+
+/* Every stage runs on every frame, so the screen can be scored against the decoder */
+static void fuzz_run_batch(size_t n, fuzz_result_t *r)
+{
+  double t0 = fuzz_now_s();
+  for (size_t i = 0; i < n; i++) {
+    g_verdicts[i] = ir_screen_frame(g_batch[i].sym, g_batch[i].num);
+  }
+  double t1 = fuzz_now_s();
+  for (size_t i = 0; i < n; i++) {
+    g_decoded[i] = ir_decoder_decode(g_batch[i].sym, g_batch[i].num, &g_codes[i]);
+  }
+  double t2 = fuzz_now_s();
+  for (size_t i = 0; i < n; i++) {
+    ir_symbols_normalize_frame(g_batch[i].sym, g_normalized[i], g_batch[i].num);
+  }
+  double t3 = fuzz_now_s();
+  r->screen_s += t1 - t0;
+  r->decode_s += t2 - t1;
+  r->normalize_s += t3 - t2;
+  r->frames += n;
+}
+
+static void fuzz_score_batch(size_t n, fuzz_result_t *r)
+{
+  for (size_t i = 0; i < n; i++) {
+    const fuzz_frame_t *f = &g_batch[i];
+    const ir_scan_code_t *c = &g_codes[i];
+    r->screen_reject += g_verdicts[i] != IR_SCREEN_PASS;
+    if (!g_decoded[i]) {
+      r->decode_reject++;
+    } else if (c->protocol != f->protocol) {
+      r->decode_wrong_other++;
+    } else if (c->address == f->address && c->command == f->command && !(c->flags & IR_SCAN_FLAG_REPEAT)) {
+      r->decode_ok++;
+      r->screen_lost += g_verdicts[i] != IR_SCREEN_PASS;
+    } else {
+      r->decode_wrong_code++;
+    }
+    if (f->num == f->ref_num && memcmp(g_normalized[i], f->ref, f->num * sizeof(rmt_symbol_word_t)) == 0) {
+      r->restore_ok++;
+    }
+  }
+}
+
+static void fuzz_run_point(const fuzz_config_t *cfg, ir_protocol_t protocol, uint32_t jitter, fuzz_result_t *r)
+{
+  memset(r, 0, sizeof(*r));
+  for (uint32_t done = 0; done < cfg->frames; done += FUZZ_BATCH) {
+    size_t n = (cfg->frames - done < FUZZ_BATCH) ? cfg->frames - done : FUZZ_BATCH;
+    for (size_t i = 0; i < n; i++) {
+      fuzz_make_frame(cfg, s_gens[protocol], jitter, &g_batch[i]);
+    }
+    fuzz_run_batch(n, r);
+    fuzz_score_batch(n, r);
+  }
+}
+
+static double fuzz_pct(uint64_t part, uint64_t whole)
+{
+  return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+static void fuzz_print_point(const fuzz_config_t *cfg, uint32_t jitter, const fuzz_result_t *r)
+{
+  double dec_fps = r->decode_s > 0.0 ? (double)r->frames / r->decode_s : 0.0;
+  double norm_fps = r->normalize_s > 0.0 ? (double)r->frames / r->normalize_s : 0.0;
+  double screen_fps = r->screen_s > 0.0 ? (double)r->frames / r->screen_s : 0.0;
+  if (cfg->csv) {
+    printf("%u,%d,%u,%llu,%llu,%llu,%llu,%llu,%llu,%.0f,%.0f,%llu,%llu,%.0f\n", (unsigned)jitter, IR_DECODE_MARGIN,
+           (unsigned)cfg->bias, (unsigned long long)r->frames, (unsigned long long)r->decode_ok,
+           (unsigned long long)r->decode_reject, (unsigned long long)r->decode_wrong_code,
+           (unsigned long long)r->decode_wrong_other, (unsigned long long)r->restore_ok, dec_fps, norm_fps,
+           (unsigned long long)r->screen_reject, (unsigned long long)r->screen_lost, screen_fps);
+    return;
+  }
+  printf("%6u  %8.3f%% %8.3f%% %9llu %9llu  %8.3f%%  %9.2f %9.2f  %8.3f%% %9llu %9.2f\n", (unsigned)jitter,
+         fuzz_pct(r->decode_ok, r->frames), fuzz_pct(r->decode_reject, r->frames),
+         (unsigned long long)r->decode_wrong_code, (unsigned long long)r->decode_wrong_other,
+         fuzz_pct(r->restore_ok, r->frames), dec_fps / 1e6, norm_fps / 1e6,
+         fuzz_pct(r->screen_reject, r->frames), (unsigned long long)r->screen_lost, screen_fps / 1e6);
+}
+
+/* Non-IR input: what the screen rejects, what the decoders would have accepted, and the time it saves */
+static void fuzz_noise(const fuzz_config_t *cfg, const char *name, void (*make)(fuzz_frame_t *))
+{
+  uint64_t accepted[IR_PROTO_MAX] = {0};
+  uint64_t verdicts[IR_SCREEN_VERDICT_MAX] = {0};
+  uint64_t total = 0;
+  uint64_t passed_accepts = 0;
+  fuzz_result_t r;
+  memset(&r, 0, sizeof(r));
+  for (uint32_t done = 0; done < cfg->frames; done += FUZZ_BATCH) {
+    size_t n = (cfg->frames - done < FUZZ_BATCH) ? cfg->frames - done : FUZZ_BATCH;
+    for (size_t i = 0; i < n; i++) {
+      make(&g_batch[i]);
+    }
+    fuzz_run_batch(n, &r);
+    for (size_t i = 0; i < n; i++) {
+      verdicts[g_verdicts[i]]++;
+      if (g_decoded[i]) {
+        accepted[g_codes[i].protocol]++;
+        total++;
+        passed_accepts += g_verdicts[i] == IR_SCREEN_PASS;
+      }
+    }
+  }
+  if (cfg->csv) {
+    return;
+  }
+  printf("\n%s: %u frames, %llu accepted (%.4f%%)", name, (unsigned)cfg->frames, (unsigned long long)total,
+         fuzz_pct(total, cfg->frames));
+  for (int p = IR_PROTO_NEC; p < IR_PROTO_MAX; p++) {
+    if (accepted[p]) {
+      printf(" %s=%llu", ir_decoder_protocol_name((ir_protocol_t)p), (unsigned long long)accepted[p]);
+    }
+  }
+  printf(", %llu of them screened in\n  screen:", (unsigned long long)passed_accepts);
+  for (int v = 0; v < IR_SCREEN_VERDICT_MAX; v++) {
+    printf(" %s=%.2f%%", ir_screen_verdict_name((ir_screen_verdict_t)v), fuzz_pct(verdicts[v], r.frames));
+  }
+  printf("\n  ns/frame: screen %.1f, decode %.1f, normalize %.1f\n", r.screen_s * 1e9 / (double)r.frames,
+         r.decode_s * 1e9 / (double)r.frames, r.normalize_s * 1e9 / (double)r.frames);
+}
+
+/* Screen losses per protocol over the whole jitter sweep, and the first jitter that loses a frame */
+static void fuzz_protocols(const fuzz_config_t *cfg)
+{
+  if (cfg->csv) {
+    return;
+  }
+  printf("\nper protocol, %u jitter points of %u frames (0..%u us, step %u):\n",
+         (unsigned)(cfg->jitter_max / cfg->jitter_step + 1u), (unsigned)cfg->frames, (unsigned)cfg->jitter_max,
+         (unsigned)cfg->jitter_step);
+  printf("%-14s %9s %9s %9s %9s %9s %9s %12s\n", "protocol", "decode", "reject", "wrong", "wrong", "screen",
+         "screen", "first lost");
+  printf("%-14s %9s %9s %9s %9s %9s %9s %12s\n", "", "ok", "", "code", "other", "reject", "lost", "jitter us");
+  for (int p = IR_PROTO_NEC; p < IR_PROTO_MAX; p++) {
+    fuzz_result_t sum;
+    memset(&sum, 0, sizeof(sum));
+    int64_t first_lost = -1;
+    for (uint32_t j = 0; j <= cfg->jitter_max; j += cfg->jitter_step) {
+      fuzz_result_t r;
+      fuzz_run_point(cfg, (ir_protocol_t)p, j, &r);
+      if (r.screen_lost && first_lost < 0) {
+        first_lost = j;
+      }
+      sum.frames += r.frames;
+      sum.decode_ok += r.decode_ok;
+      sum.decode_reject += r.decode_reject;
+      sum.decode_wrong_code += r.decode_wrong_code;
+      sum.decode_wrong_other += r.decode_wrong_other;
+      sum.screen_reject += r.screen_reject;
+      sum.screen_lost += r.screen_lost;
+    }
+    char first[24] = "-";
+    if (first_lost >= 0) {
+      snprintf(first, sizeof(first), "%lld", (long long)first_lost);
+    }
+    printf("%-14s %8.3f%% %8.3f%% %9llu %9llu %8.3f%% %9llu %12s\n", ir_decoder_protocol_name((ir_protocol_t)p),
+           fuzz_pct(sum.decode_ok, sum.frames), fuzz_pct(sum.decode_reject, sum.frames),
+           (unsigned long long)sum.decode_wrong_code, (unsigned long long)sum.decode_wrong_other,
+           fuzz_pct(sum.screen_reject, sum.frames), (unsigned long long)sum.screen_lost, first);
+  }
+}
+
+/* Undamaged frames must decode and restore exactly, or the harness itself is wrong */
+static int fuzz_sanity(const fuzz_config_t *cfg)
+{
+  fuzz_config_t clean = { .frames = FUZZ_BATCH, .seed = cfg->seed };
+  for (int p = IR_PROTO_NEC; p < IR_PROTO_MAX; p++) {
+    fuzz_result_t r;
+    fuzz_run_point(&clean, (ir_protocol_t)p, 0u, &r);
+    if (r.screen_reject || r.decode_ok != r.frames || r.restore_ok != r.frames) {
+      printf("sanity: %s: %llu/%llu screened out, %llu/%llu decoded, %llu/%llu restored on clean frames\n",
+             ir_decoder_protocol_name((ir_protocol_t)p),
+             (unsigned long long)r.screen_reject, (unsigned long long)r.frames,
+             (unsigned long long)r.decode_ok, (unsigned long long)r.frames,
+             (unsigned long long)r.restore_ok, (unsigned long long)r.frames);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Main                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static int fuzz_usage(void)
+{
+  fprintf(stderr, "usage: ir_fuzz [-n frames] [-j max_jitter] [-t step] [-b bias] [-g p_glitch]\n"
+                  "               [-c p_truncate] [-i p_invert] [-s seed] [--csv]\n");
+  return 2;
+}
+
+int main(int argc, char **argv)
+{
+  fuzz_config_t cfg = {
+    .frames = 200000u,
+    .jitter_max = 600u,
+    .jitter_step = 50u,
+    .seed = 0x1F2E3D4C5B6A7988ull,
+  };
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    if (!strcmp(a, "--csv")) {
+      cfg.csv = 1;
+      continue;
+    }
+    if (a[0] != '-' || !a[1] || a[2] || i + 1 >= argc) {
+      return fuzz_usage();
+    }
+    const char *v = argv[++i];
+    switch (a[1]) {
+    case 'n': cfg.frames = (uint32_t)strtoul(v, NULL, 0); break;
+    case 'j': cfg.jitter_max = (uint32_t)strtoul(v, NULL, 0); break;
+    case 't': cfg.jitter_step = (uint32_t)strtoul(v, NULL, 0); break;
+    case 'b': cfg.bias = (int32_t)strtol(v, NULL, 0); break;
+    case 'g': cfg.p_glitch = strtod(v, NULL); break;
+    case 'c': cfg.p_truncate = strtod(v, NULL); break;
+    case 'i': cfg.p_invert = strtod(v, NULL); break;
+    case 's': cfg.seed = strtoull(v, NULL, 0); break;
+    default: return fuzz_usage();
+    }
+  }
+  if (!cfg.frames || !cfg.jitter_step) {
+    return fuzz_usage();
+  }
+
+  g_rng = cfg.seed ? cfg.seed : 1u;
+  rmt_host_channel_init(&g_tx, RMT_HOST_MEM_BLOCK_SYMBOLS);
+  ir_nec_encoder_config_t enc_cfg = { .resolution = FUZZ_RESOLUTION_HZ };
+  if (rmt_new_ir_nec_encoder(&enc_cfg, &g_nec_encoder) != ESP_OK || ir_decoder_register_defaults() != ESP_OK) {
+    printf("setup failed\n");
+    return 1;
+  }
+  if (fuzz_sanity(&cfg)) {
+    return 1;
+  }
+
+  if (cfg.csv) {
+    printf("jitter_us,margin_us,bias_us,frames,decode_ok,decode_reject,wrong_nec,wrong_other,restore_ok,"
+           "decode_fps,normalize_fps,screen_reject,screen_lost,screen_fps\n");
+  } else {
+    printf("IR_DECODE_MARGIN=%d bias=%d glitch=%.3f truncate=%.3f invert=%.3f, %u frames per point\n\n",
+           IR_DECODE_MARGIN, (int)cfg.bias, cfg.p_glitch, cfg.p_truncate, cfg.p_invert, (unsigned)cfg.frames);
+    printf("%6s  %9s %9s %9s %9s  %9s  %9s %9s  %9s %9s %9s\n", "jitter", "decode", "reject", "wrong", "wrong",
+           "restore", "decode", "normalize", "screen", "screen", "screen");
+    printf("%6s  %9s %9s %9s %9s  %9s  %9s %9s  %9s %9s %9s\n", "us", "ok", "", "nec", "other", "ok", "Mfr/s",
+           "Mfr/s", "reject", "lost", "Mfr/s");
+  }
+  for (uint32_t j = 0; j <= cfg.jitter_max; j += cfg.jitter_step) {
+    fuzz_result_t r;
+    fuzz_run_point(&cfg, IR_PROTO_NEC, j, &r);
+    fuzz_print_point(&cfg, j, &r);
+  }
+  fuzz_noise(&cfg, "random symbols", fuzz_make_garbage);
+  fuzz_noise(&cfg, "ambient light", fuzz_make_ambient);
+  fuzz_protocols(&cfg);
+  return 0;
+}
@@ -0,0 +1,181 @@
+/* rmt_host.c — host copy/bytes encoders and a RAM TX channel (see rmt_host.h) */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "rmt_host.h"
+
+#define RMT_HOST_MAX_ENCODERS 4u
+
+typedef struct {
+  rmt_encoder_t              base;
+  rmt_bytes_encoder_config_t cfg;   /* bytes encoder only */
+  size_t                     pos;   /* symbols (copy) or bits (bytes) already encoded */
+  int                        in_use;
+} rmt_host_encoder_t;
+
+static rmt_host_encoder_t g_encoders[RMT_HOST_MAX_ENCODERS];
+
+static int rmt_host_put(rmt_channel_handle_t chan, rmt_symbol_word_t sym)
+{
+  if (chan->mem_len >= chan->mem_cap) {
+    return 0;
+  }
+  chan->mem[chan->mem_len++] = sym;
+  return 1;
+}
+
+static size_t rmt_host_copy_encode(rmt_encoder_t *encoder, rmt_channel_handle_t chan, const void *data,
+                                   size_t data_size, rmt_encode_state_t *ret_state)
+{
+  rmt_host_encoder_t *enc = __containerof(encoder, rmt_host_encoder_t, base);
+  const rmt_symbol_word_t *symbols = data;
+  size_t total = data_size / sizeof(rmt_symbol_word_t);
+  size_t n = 0;
+
+  while (enc->pos < total && rmt_host_put(chan, symbols[enc->pos])) {
+    enc->pos++;
+    n++;
+  }
+  if (enc->pos == total) {
+    enc->pos = 0;
+    *ret_state = RMT_ENCODING_COMPLETE;
+  } else {
+    *ret_state = RMT_ENCODING_MEM_FULL;
+  }
+  return n;
+}
+
+static size_t rmt_host_bytes_encode(rmt_encoder_t *encoder, rmt_channel_handle_t chan, const void *data,
+                                    size_t data_size, rmt_encode_state_t *ret_state)
+{
+  rmt_host_encoder_t *enc = __containerof(encoder, rmt_host_encoder_t, base);
+  const uint8_t *bytes = data;
+  size_t total = data_size * 8u;
+  size_t n = 0;
+
+  while (enc->pos < total) {
+    size_t bit = enc->cfg.flags.msb_first ? 7u - (enc->pos & 7u) : (enc->pos & 7u);
+    rmt_symbol_word_t sym = ((bytes[enc->pos >> 3] >> bit) & 1u) ? enc->cfg.bit1 : enc->cfg.bit0;
+    if (!rmt_host_put(chan, sym)) {
+      break;
+    }
+    enc->pos++;
+    n++;
+  }
+  if (enc->pos == total) {
+    enc->pos = 0;
+    *ret_state = RMT_ENCODING_COMPLETE;
+  } else {
+    *ret_state = RMT_ENCODING_MEM_FULL;
+  }
+  return n;
+}
+
+static esp_err_t rmt_host_reset(rmt_encoder_t *encoder)
+{
+  __containerof(encoder, rmt_host_encoder_t, base)->pos = 0;
+  return ESP_OK;
+}
+
+static esp_err_t rmt_host_del(rmt_encoder_t *encoder)
+{
+  __containerof(encoder, rmt_host_encoder_t, base)->in_use = 0;
+  return ESP_OK;
+}
+
+static rmt_host_encoder_t *rmt_host_alloc(void)
+{
+  for (size_t i = 0; i < RMT_HOST_MAX_ENCODERS; i++) {
+    if (!g_encoders[i].in_use) {
+      memset(&g_encoders[i], 0, sizeof(g_encoders[i]));
+      g_encoders[i].in_use = 1;
+      g_encoders[i].base.reset = rmt_host_reset;
+      g_encoders[i].base.del = rmt_host_del;
+      return &g_encoders[i];
+    }
+  }
+  return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ESP-IDF encoder API                                                        */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+  rmt_host_encoder_t *enc = (config && ret_encoder) ? rmt_host_alloc() : NULL;
+  if (!enc) {
+    return config && ret_encoder ? ESP_ERR_NO_MEM : ESP_ERR_INVALID_ARG;
+  }
+  enc->cfg = *config;
+  enc->base.encode = rmt_host_bytes_encode;
+  *ret_encoder = &enc->base;
+  return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+  rmt_host_encoder_t *enc = (config && ret_encoder) ? rmt_host_alloc() : NULL;
+  if (!enc) {
+    return config && ret_encoder ? ESP_ERR_NO_MEM : ESP_ERR_INVALID_ARG;
+  }
+  enc->base.encode = rmt_host_copy_encode;
+  *ret_encoder = &enc->base;
+  return ESP_OK;
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder)
+{
+  return encoder ? encoder->del(encoder) : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder)
+{
+  return encoder ? encoder->reset(encoder) : ESP_ERR_INVALID_ARG;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Channel                                                                    */
+/* -------------------------------------------------------------------------- */
+
+void rmt_host_channel_init(struct rmt_channel_t *chan, size_t mem_block_symbols)
+{
+  memset(chan, 0, sizeof(*chan));
+  chan->mem_cap = (mem_block_symbols && mem_block_symbols <= RMT_HOST_MEM_BLOCK_SYMBOLS)
+                    ? mem_block_symbols : RMT_HOST_MEM_BLOCK_SYMBOLS;
+}
+
+static int rmt_host_flush(struct rmt_channel_t *chan)
+{
+  if (chan->out_len + chan->mem_len > chan->out_cap) {
+    return 0;
+  }
+  memcpy(&chan->out[chan->out_len], chan->mem, chan->mem_len * sizeof(rmt_symbol_word_t));
+  chan->out_len += chan->mem_len;
+  chan->mem_len = 0;
+  return 1;
+}
+
+size_t rmt_host_transmit(struct rmt_channel_t *chan, rmt_encoder_handle_t encoder, const void *data,
+                         size_t data_size, rmt_symbol_word_t *out, size_t out_cap)
+{
+  chan->out = out;
+  chan->out_cap = out_cap;
+  chan->out_len = 0;
+  chan->mem_len = 0;
+  for (;;) {
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    encoder->encode(encoder, chan, data, data_size, &state);
+    if (!rmt_host_flush(chan)) {
+      encoder->reset(encoder);
+      return 0;
+    }
+    if (state & RMT_ENCODING_COMPLETE) {
+      return chan->out_len;
+    }
+    if (!(state & RMT_ENCODING_MEM_FULL)) {
+      encoder->reset(encoder);  /* encoder stalled without filling the block */
+      return 0;
+    }
+  }
+}
@@ -0,0 +1,27 @@
+/* rmt_host.h — RAM-backed RMT TX channel so the device encoders run on the host
+ *
+ * rmt_host_transmit() drives an encoder the way the RMT driver does: the
+ * encoder fills the channel memory block, and on RMT_ENCODING_MEM_FULL the
+ * block is flushed to the output frame and encode() is called again.
+ */
+#pragma once
+
+#include <stddef.h>
+#include "driver/rmt_encoder.h"
+
+#define RMT_HOST_MEM_BLOCK_SYMBOLS 64u  /* mem_block_symbols of the TX channel */
+
+struct rmt_channel_t {
+  rmt_symbol_word_t  mem[RMT_HOST_MEM_BLOCK_SYMBOLS];
+  size_t             mem_len;
+  size_t             mem_cap;     /* <= RMT_HOST_MEM_BLOCK_SYMBOLS */
+  rmt_symbol_word_t *out;
+  size_t             out_len;
+  size_t             out_cap;
+};
+
+void rmt_host_channel_init(struct rmt_channel_t *chan, size_t mem_block_symbols);
+
+/* Encode one transaction into out; returns the symbol count, 0 if it does not fit */
+size_t rmt_host_transmit(struct rmt_channel_t *chan, rmt_encoder_handle_t encoder, const void *data,
+                         size_t data_size, rmt_symbol_word_t *out, size_t out_cap);
@@ -0,0 +1,22 @@
+/* Host shim: the ESP_GOTO_ON_* helpers of esp_check.h */
+#pragma once
+
+#include "esp_err.h"
+#include "esp_log.h"
+
+#define ESP_GOTO_ON_ERROR(x, goto_tag, log_tag, fmt, ...) do {  \
+    esp_err_t err_rc_ = (x);                                    \
+    if (err_rc_ != ESP_OK) {                                    \
+      ESP_LOGE(log_tag, fmt, ##__VA_ARGS__);                    \
+      ret = err_rc_;                                            \
+      goto goto_tag;                                            \
+    }                                                           \
+  } while (0)
+
+#define ESP_GOTO_ON_FALSE(a, err_code, goto_tag, log_tag, fmt, ...) do {  \
+    if (!(a)) {                                                          \
+      ESP_LOGE(log_tag, fmt, ##__VA_ARGS__);                             \
+      ret = (err_code);                                                  \
+      goto goto_tag;                                                     \
+    }                                                                    \
+  } while (0)
@@ -0,0 +1,14 @@
+/* Host shim: RMT symbol layout as in ESP-IDF hal/rmt_types.h */
+#pragma once
+
+#include <stdint.h>
+
+typedef union {
+  struct {
+    uint16_t duration0 : 15;
+    uint16_t level0 : 1;
+    uint16_t duration1 : 15;
+    uint16_t level1 : 1;
+  };
+  uint32_t val;
+} rmt_symbol_word_t;
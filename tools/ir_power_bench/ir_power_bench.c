@@ -0,0 +1,307 @@
+/* ir_power_bench.c — IR channel on-time and wake-to-first-edge over one day
+ *
+ * Runs the real scheduler.c and ir_power.c for one simulated day on a
+ * virtual clock. Switching a channel on costs enable_us (rmt_enable() and
+ * the encoder reset on the device; override on the command line), a send
+ * holds TX for one NEC frame. The day has:
+ *
+ *   - the schedule table (periodic sends)
+ *   - manual sends from the app, at random times in the active hours
+ *   - three 90 s programming sessions (orchestrator ORCH_ST_PROGRAMMING,
+ *     RX learning; scheduled sends are gated out meanwhile)
+ *   - PWR_IDLE from 23:00 to 07:00
+ *
+ *   ir_power_bench [schedules] [manual/day] [enable_us]
+ *
+ * Modes: always-on (both channels held from boot, as app_main used to),
+ * lazy (no pre-warm) and lazy with pre-warm. Latency is acquire() to the
+ * first edge; on-time is what the RMT power-management lock is held.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scheduler.h"
+#include "orchestrator.h"
+#include "ir_power.h"
+
+#define BENCH_DAY_S          86400u
+#define BENCH_MAX_DUE        16u
+#define BENCH_MAX_SAMPLES    8192u
+#define BENCH_PERIOD_MIN_S   900u
+#define BENCH_PERIOD_MAX_S   14400u
+#define BENCH_ACTIVE_FROM_S  (7u * 3600u)
+#define BENCH_ACTIVE_TO_S    (23u * 3600u)
+#define BENCH_SESSIONS       3u
+#define BENCH_SESSION_S      90u
+#define BENCH_DISPATCH_US    50u      /* EVT_SCHEDULE_DUE to the IR handler */
+#define BENCH_FRAME_US       67500u   /* one NEC frame on the wire */
+#define BENCH_MAX_MANUAL     1000u
+
+typedef struct {
+  uint64_t clock_us;
+  uint32_t enable_us;
+  uint32_t rng;
+  uint32_t due[BENCH_MAX_DUE];
+  uint32_t due_len;
+  uint32_t manual_at[BENCH_MAX_MANUAL];
+  uint32_t manual_num;
+  uint32_t session_at[BENCH_SESSIONS];
+} bench_env_t;
+
+typedef struct {
+  const char *name;
+  uint32_t prewarm_s;      /* 0: pre-warm off */
+  uint8_t  always_on;
+  uint32_t sched_sends;
+  uint32_t manual_sends;
+  uint32_t sched_num;
+  uint32_t sched_lat[BENCH_MAX_SAMPLES];
+  uint32_t manual_num;
+  uint32_t manual_lat[BENCH_MAX_SAMPLES];
+} bench_result_t;
+
+static bench_env_t g_env;
+
+static uint32_t bench_rand(void)
+{
+  uint32_t x = g_env.rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  g_env.rng = x;
+  return x;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Modelled channels                                                          */
+/* -------------------------------------------------------------------------- */
+
+static os_err_t bench_enable(ir_power_ch_t ch, void *ctx)
+{
+  (void)ch;
+  (void)ctx;
+  g_env.clock_us += g_env.enable_us;
+  return OS_OK;
+}
+
+static os_err_t bench_disable(ir_power_ch_t ch, void *ctx)
+{
+  (void)ch;
+  (void)ctx;
+  return OS_OK;
+}
+
+static uint64_t bench_now_us(void *ctx)
+{
+  (void)ctx;
+  return g_env.clock_us;
+}
+
+static void bench_due(const sched_entry_t *entry, uint32_t deadline, void *user_ctx)
+{
+  (void)deadline;
+  (void)user_ctx;
+  if (g_env.due_len < BENCH_MAX_DUE) {
+    g_env.due[g_env.due_len++] = entry->id;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* One day                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static void bench_send(uint32_t *lat, uint32_t *num)
+{
+  g_env.clock_us += BENCH_DISPATCH_US;
+  uint64_t t0 = g_env.clock_us;
+  if (ir_power_acquire(IR_PWR_TX) != OS_OK) {
+    return;
+  }
+  ir_power_mark_edge(IR_PWR_TX);
+  if (*num < BENCH_MAX_SAMPLES) {
+    lat[(*num)++] = (uint32_t)(g_env.clock_us - t0);
+  }
+  g_env.clock_us += BENCH_FRAME_US;
+  ir_power_release(IR_PWR_TX);
+}
+
+static void bench_set_mode(os_power_mode_t mode)
+{
+  os_evt_t evt = { .id = EVT_POWER_MODE_CHANGED, .src = OS_MOD_POWER, .len = sizeof(evt_power_mode_changed_t) };
+  evt_power_mode_changed_t p = { .mode = mode };
+  memcpy(evt.payload, &p, sizeof(p));
+  (void)ir_power_process(&evt);
+}
+
+/* Pre-warm off: report a state that may not run schedules */
+static void bench_set_orch(const bench_result_t *r, orch_state_t st)
+{
+  orch_caps_t caps = (st == ORCH_ST_PROGRAMMING) ? ORCH_CAP_PROGRAM : ORCH_CAP_SCHED_RUN | ORCH_CAP_IR_SEND;
+  if (!r->prewarm_s) {
+    caps &= (orch_caps_t)~ORCH_CAP_SCHED_RUN;
+  }
+  ir_power_set_orch(st, caps);
+}
+
+static void bench_day(bench_result_t *r, uint32_t schedules)
+{
+  const sched_config_t scfg = { .on_due = bench_due };
+  const ir_power_config_t pcfg = {
+    .hw = { .enable = bench_enable, .disable = bench_disable, .now_us = bench_now_us },
+    .prewarm_s = r->prewarm_s,
+  };
+  g_env.rng = 0x2545F491u;
+  g_env.clock_us = 0u;
+  g_env.due_len = 0u;
+  (void)sched_init(&scfg);
+  (void)ir_power_init(&pcfg);
+  for (uint32_t id = 0; id < schedules; id++) {
+    uint32_t period = BENCH_PERIOD_MIN_S + bench_rand() % (BENCH_PERIOD_MAX_S - BENCH_PERIOD_MIN_S);
+    sched_entry_t e = {
+      .id = id,
+      .slot = (uint16_t)id,
+      .missed_policy = SCHED_MISSED_SKIP,
+      .first_run = 1u + bench_rand() % period,
+      .period_s = period,
+    };
+    (void)sched_add(&e);
+  }
+  bench_set_orch(r, ORCH_ST_NORMAL);
+  bench_set_mode(PWR_IDLE);
+  if (r->always_on) {
+    (void)ir_power_acquire(IR_PWR_RX);
+    (void)ir_power_acquire(IR_PWR_TX);
+  }
+
+  uint32_t next_tick = 0u;
+  uint32_t manual = 0u;
+  orch_state_t st = ORCH_ST_NORMAL;
+  for (uint32_t t = 1; t <= BENCH_DAY_S; t++) {
+    if (g_env.clock_us < (uint64_t)t * 1000000u) {
+      g_env.clock_us = (uint64_t)t * 1000000u;
+    }
+    if (t == BENCH_ACTIVE_FROM_S || t == BENCH_ACTIVE_TO_S) {
+      bench_set_mode(t == BENCH_ACTIVE_FROM_S ? PWR_ACTIVE : PWR_IDLE);
+      next_tick = t;
+    }
+    for (uint32_t i = 0; i < BENCH_SESSIONS; i++) {
+      if (t == g_env.session_at[i] || t == g_env.session_at[i] + BENCH_SESSION_S) {
+        st = (t == g_env.session_at[i]) ? ORCH_ST_PROGRAMMING : ORCH_ST_NORMAL;
+        bench_set_orch(r, st);
+        next_tick = t;
+      }
+    }
+
+    if (t >= sched_next_deadline()) {
+      (void)sched_process(t);
+      next_tick = t;
+    }
+    if (t >= next_tick) {
+      next_tick = ir_power_tick(t);
+    }
+    for (uint32_t i = 0; i < g_env.due_len; i++) {
+      if (st == ORCH_ST_PROGRAMMING) {
+        continue;  /* ORCH_CAP_SCHED_RUN is not granted while programming */
+      }
+      r->sched_sends++;
+      bench_send(r->sched_lat, &r->sched_num);
+      next_tick = t;
+    }
+    g_env.due_len = 0u;
+    while (manual < g_env.manual_num && g_env.manual_at[manual] == t) {
+      r->manual_sends++;
+      bench_send(r->manual_lat, &r->manual_num);
+      manual++;
+      next_tick = t;
+    }
+    /* A release starts the linger */
+    if (t >= next_tick) {
+      next_tick = ir_power_tick(t);
+    }
+  }
+}
+
+static int bench_cmp_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void bench_lat(uint32_t *lat, uint32_t n, double *mean, uint32_t *p99)
+{
+  uint64_t sum = 0;
+  qsort(lat, n, sizeof(lat[0]), bench_cmp_u32);
+  for (uint32_t i = 0; i < n; i++) {
+    sum += lat[i];
+  }
+  *mean = n ? (double)sum / (double)n : 0.0;
+  *p99 = n ? lat[(n * 99u) / 100u] : 0u;
+}
+
+static void bench_report(bench_result_t *r)
+{
+  ir_power_stats_t st;
+  ir_power_get_stats(&st);
+  double sched_mean, manual_mean;
+  uint32_t sched_p99, manual_p99;
+  bench_lat(r->sched_lat, r->sched_num, &sched_mean, &sched_p99);
+  bench_lat(r->manual_lat, r->manual_num, &manual_mean, &manual_p99);
+  const ir_power_ch_stats_t *tx = &st.ch[IR_PWR_TX];
+  const ir_power_ch_stats_t *rx = &st.ch[IR_PWR_RX];
+  printf("%-12s %7.3f%% %7.3f%% %6u %6u %6u %6u %9.1f %6u %9.1f %6u\n", r->name,
+         100.0 * (double)tx->on_us / (double)st.up_us, 100.0 * (double)rx->on_us / (double)st.up_us,
+         (unsigned)tx->enables, (unsigned)tx->cold, (unsigned)st.prewarm_hits, (unsigned)st.prewarm_wasted,
+         sched_mean, (unsigned)sched_p99, manual_mean, (unsigned)manual_p99);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t schedules = (argc > 1) ? (uint32_t)atoi(argv[1]) : 12u;
+  uint32_t manual = (argc > 2) ? (uint32_t)atoi(argv[2]) : 20u;
+  g_env.enable_us = (argc > 3) ? (uint32_t)atoi(argv[3]) : 400u;
+  if (schedules == 0u || schedules > SCHED_MAX_ENTRIES || manual > BENCH_MAX_MANUAL) {
+    fprintf(stderr, "schedules must be 1..%u, manual <= %u\n", (unsigned)SCHED_MAX_ENTRIES,
+            (unsigned)BENCH_MAX_MANUAL);
+    return 1;
+  }
+
+  /* Manual sends and programming sessions: same times in every mode */
+  g_env.rng = 0x9E3779B9u;
+  for (uint32_t i = 0; i < manual; i++) {
+    g_env.manual_at[i] = BENCH_ACTIVE_FROM_S + bench_rand() % (BENCH_ACTIVE_TO_S - BENCH_ACTIVE_FROM_S);
+  }
+  g_env.manual_num = manual;
+  qsort(g_env.manual_at, manual, sizeof(g_env.manual_at[0]), bench_cmp_u32);
+  for (uint32_t i = 0; i < BENCH_SESSIONS; i++) {
+    g_env.session_at[i] = BENCH_ACTIVE_FROM_S + bench_rand() % (BENCH_ACTIVE_TO_S - BENCH_ACTIVE_FROM_S - BENCH_SESSION_S);
+  }
+
+  printf("one day: %u schedules every %u..%u s, %u manual sends, %u x %u s programming, idle 23:00-07:00\n",
+         (unsigned)schedules, (unsigned)BENCH_PERIOD_MIN_S, (unsigned)BENCH_PERIOD_MAX_S, (unsigned)manual,
+         (unsigned)BENCH_SESSIONS, (unsigned)BENCH_SESSION_S);
+  printf("model: enable %u us, frame %u us, linger %u ms\n\n", (unsigned)g_env.enable_us,
+         (unsigned)BENCH_FRAME_US, (unsigned)IR_POWER_LINGER_MS);
+  printf("%-12s %8s %8s %6s %6s %6s %6s %9s %6s %9s %6s\n", "mode", "tx_on", "rx_on", "tx_en", "cold",
+         "pw_hit", "pw_wst", "sched_us", "p99", "manual_us", "p99");
+
+  static bench_result_t results[4];
+  static const struct { const char *name; uint32_t prewarm_s; uint8_t always_on; } modes[] = {
+    { "always-on", 0u, 1u },
+    { "lazy", 0u, 0u },
+    { "prewarm 1s", 1u, 0u },
+    { "prewarm 2s", 2u, 0u },
+  };
+  for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+    bench_result_t *r = &results[m];
+    memset(r, 0, sizeof(*r));
+    r->name = modes[m].name;
+    r->prewarm_s = modes[m].prewarm_s;
+    r->always_on = modes[m].always_on;
+    bench_day(r, schedules);
+    bench_report(r);
+  }
+  printf("\non: share of the day a channel was enabled; sched_us / manual_us: acquire to first edge (model)\n");
+  return 0;
+}
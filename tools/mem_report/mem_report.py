@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""Memory budget report: static RAM per module from the linker map, peak stack per task from a log.
+
+    mem_report.py build/<project>.map [--log monitor.txt] [--budget evt_bus=8192 ...] [--top 3]
+
+RAM is attributed by archive (one per IDF component, e.g. libevt_bus.a -> evt_bus) or by
+object file when it is not in an archive. On ESP-IDF maps the output section decides the
+region (.dram0.data / .dram0.bss / .iram0.* / .rtc.*), so code placed in IRAM is counted.
+
+--log merges the "STACK" / "HEAP" lines printed by mem_budget_log_report() and suggests a
+stack size per task (peak plus 25% or 512 bytes, whichever is more, rounded to 256).
+
+Exits 1 if a module is over its --budget or a task has less than 1/8 of its stack free.
+"""
+
+import argparse
+import collections
+import re
+import sys
+
+INPUT_RE = re.compile(r"^ (\.\S+|COMMON)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+INPUT_NAME_RE = re.compile(r"^ (\.\S+|COMMON)$")
+CONT_RE = re.compile(r"^\s{8,}0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+OUTPUT_RE = re.compile(r"^(\.\S+)(\s|$)")
+ARCHIVE_RE = re.compile(r"(?:^|/)lib([^/]+)\.a\((.+)\)$")
+STACK_RE = re.compile(r"STACK (\S+) size=(\d+)(?: peak=(\d+))?")
+HEAP_RE = re.compile(r"HEAP free=(\d+) min_free=(\d+) largest_block=(\d+)")
+
+REGIONS = ("data", "bss", "iram", "rtc")
+
+
+def region_of(output_section, input_section):
+    """RAM region of an input section, None for flash / code in flash."""
+    for name in (output_section or "", input_section):
+        n = name.lower()
+        if "rtc" in n:
+            return "rtc"
+        if "iram" in n:
+            return "iram"
+        if "flash" in n or n.startswith((".text", ".rodata", ".literal", ".debug", ".comment")):
+            return None
+        if n.startswith((".bss", ".sbss", ".tbss", ".noinit", "common")) or ("dram" in n and "bss" in n):
+            return "bss"
+        if n.startswith((".data", ".sdata", ".tdata")) or "dram" in n:
+            return "data"
+    return None
+
+
+def module_of(path):
+    m = ARCHIVE_RE.search(path)
+    if m:
+        return m.group(1)
+    base = path.rsplit("/", 1)[-1]
+    return re.sub(r"\.(obj|o)$", "", base)
+
+
+def parse_map(path):
+    """{module: {region: bytes}}, {module: Counter(symbol -> bytes)}"""
+    ram = collections.defaultdict(lambda: dict.fromkeys(REGIONS, 0))
+    syms = collections.defaultdict(collections.Counter)
+    in_map = False
+    output = None
+    pending = None
+
+    def add(section, size, origin):
+        region = region_of(output, section)
+        if region is None or size == 0:
+            return
+        mod = module_of(origin.strip())
+        ram[mod][region] += size
+        sym = section.split(".", 2)[2] if section.count(".") >= 2 else section
+        syms[mod][sym] += size
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if not in_map:
+                in_map = line.startswith("Linker script and memory map")
+                continue
+            m = OUTPUT_RE.match(line)
+            if m:
+                output = m.group(1)
+                pending = None
+                continue
+            m = INPUT_RE.match(line)
+            if m:
+                add(m.group(1), int(m.group(3), 16), m.group(4))
+                pending = None
+                continue
+            m = INPUT_NAME_RE.match(line)
+            if m:
+                pending = m.group(1)
+                continue
+            m = CONT_RE.match(line)
+            if m and pending:
+                add(pending, int(m.group(2), 16), m.group(3))
+            pending = None
+    return ram, syms
+
+
+def parse_log(path):
+    stacks = collections.OrderedDict()
+    heap = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = STACK_RE.search(line)
+            if m:
+                peak = int(m.group(3)) if m.group(3) else None
+                prev = stacks.get(m.group(1))
+                if peak is None and prev:
+                    continue  # keep the last peak seen while it ran
+                stacks[m.group(1)] = (int(m.group(2)), peak)
+                continue
+            m = HEAP_RE.search(line)
+            if m:
+                heap = tuple(int(g) for g in m.groups())
+    return stacks, heap
+
+
+def suggest_stack(peak):
+    need = peak + max(512, peak // 4)
+    return (need + 255) // 256 * 256
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("map")
+    ap.add_argument("--log", help="serial log containing mem_budget_log_report() output")
+    ap.add_argument("--budget", action="append", default=[], metavar="MODULE=BYTES")
+    ap.add_argument("--top", type=int, default=0, help="largest N symbols per module")
+    ap.add_argument("--min", type=int, default=0, help="hide modules below this many bytes")
+    args = ap.parse_args()
+
+    budgets = {}
+    for b in args.budget:
+        mod, _, val = b.partition("=")
+        budgets[mod] = int(val, 0)
+
+    ram, syms = parse_map(args.map)
+    ok = True
+    rows = sorted(ram.items(), key=lambda kv: -sum(kv[1].values()))
+    totals = dict.fromkeys(REGIONS, 0)
+    print("%-24s %8s %8s %8s %8s %8s  %s" % ("module", "data", "bss", "iram", "rtc", "total", "budget"))
+    for mod, r in rows:
+        total = sum(r.values())
+        for k in REGIONS:
+            totals[k] += r[k]
+        if total < args.min and mod not in budgets:
+            continue
+        note = ""
+        if mod in budgets:
+            over = total > budgets[mod]
+            ok &= not over
+            note = "%d%s" % (budgets[mod], " OVER" if over else "")
+        print("%-24s %8d %8d %8d %8d %8d  %s" % (mod[:24], r["data"], r["bss"], r["iram"], r["rtc"], total, note))
+        for name, size in syms[mod].most_common(args.top):
+            print("  %-22s %44d" % (name[:22], size))
+    print("%-24s %8d %8d %8d %8d %8d" % ("TOTAL", totals["data"], totals["bss"], totals["iram"], totals["rtc"],
+                                         sum(totals.values())))
+    for mod in budgets:
+        if mod not in ram:
+            print("budget for unknown module %s" % mod)
+
+    if args.log:
+        stacks, heap = parse_log(args.log)
+        print()
+        print("%-16s %8s %8s %8s %10s" % ("task", "stack", "peak", "free", "suggested"))
+        for name, (size, peak) in stacks.items():
+            if peak is None:
+                print("%-16s %8d %8s %8s %10s" % (name, size, "-", "-", "exited"))
+                continue
+            low = (size - peak) * 8 < size
+            ok &= not low
+            print("%-16s %8d %8d %8d %10d%s" % (name, size, peak, size - peak, suggest_stack(peak),
+                                                 "  LOW" if low else ""))
+        if heap:
+            print("heap: free=%d min_free=%d largest_block=%d (%.0f%% of free is one block)"
+                  % (heap[0], heap[1], heap[2], 100.0 * heap[2] / heap[0] if heap[0] else 0.0))
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,289 @@
+/* sched_bench.c — scheduler wakeups/day, firing jitter and at-most-once over a simulated day
+ *
+ * Runs the real scheduler.c for one day on a virtual clock. Real time only
+ * moves forward; the wall clock the scheduler sees is real time plus an
+ * offset that the day's events change:
+ *
+ *   06:00  +60 s      small forward correction (ordinary lateness)
+ *   09:00  -3600 s    backward jump (DST end)
+ *   12:00  reboot     300 s down; the table is reloaded with the persisted last_run
+ *   15:00  +7200 s    forward jump (NTP fix after a long RTC drift)
+ *   18:00  reboot     120 s down, the RTC comes back 600 s behind
+ *   18:01  +600 s     ... and NTP puts it right again
+ *   21:00  -30 s      small backward correction
+ *
+ * Every jump is reported through sched_on_time_jump(). Two drivers run the
+ * same day: next-deadline (wake at sched_next_deadline(), plus up to
+ * wake_slop_s of timer slack) and the old fixed 30 s poll of the table.
+ * Jitter is fire time minus the nominal occurrence, in wall seconds. Fires
+ * later than max_late_s (RUN_ONCE catch-up after a jump or a reboot) are
+ * counted apart, so they do not hide the timer jitter.
+ *
+ *   sched_bench [schedules] [wake_slop_s] [seed]
+ *
+ * Exits 1 if any schedule fires the same or an earlier occurrence twice
+ * (double fire), within a boot or across a reboot.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scheduler.h"
+
+#define BENCH_DAY_S         86400u
+#define BENCH_EPOCH_S       1700000000u
+#define BENCH_POLL_S        30u
+#define BENCH_PERIOD_MIN_S  300u
+#define BENCH_PERIOD_MAX_S  14400u
+#define BENCH_MAX_FIRES     (1u << 20)
+
+typedef enum {
+  BENCH_EV_JUMP = 0,
+  BENCH_EV_REBOOT,
+} bench_ev_kind_t;
+
+typedef struct {
+  uint32_t        at_s;      /* real seconds since start */
+  bench_ev_kind_t kind;
+  int32_t         delta_s;   /* jump, or RTC error after a reboot */
+  uint32_t        down_s;    /* reboot: time powered off */
+} bench_ev_t;
+
+static const bench_ev_t s_day[] = {
+  {  6u * 3600u,       BENCH_EV_JUMP,   60,    0u   },
+  {  9u * 3600u,       BENCH_EV_JUMP,   -3600, 0u   },
+  { 12u * 3600u,       BENCH_EV_REBOOT, 0,     300u },
+  { 15u * 3600u,       BENCH_EV_JUMP,   7200,  0u   },
+  { 18u * 3600u,       BENCH_EV_REBOOT, -600,  120u },
+  { 18u * 3600u + 60u, BENCH_EV_JUMP,   600,   0u   },
+  { 21u * 3600u,       BENCH_EV_JUMP,   -30,   0u   },
+};
+
+typedef struct {
+  const char *name;
+  uint32_t    poll_s;          /* 0: next-deadline */
+  uint32_t    real_s;
+  int64_t     offset_s;        /* wall = BENCH_EPOCH_S + real + offset */
+  sched_stats_t total;         /* summed over boots */
+  uint32_t    fires;           /* on time: late <= max_late_s */
+  uint32_t    late[BENCH_MAX_FIRES];
+  uint32_t    catch_up;
+  uint32_t    double_fires;
+  uint32_t    reboots;
+} bench_run_t;
+
+static uint32_t g_rng;
+static uint32_t g_slop_s;
+static uint32_t g_n;
+static sched_entry_t *g_table;   /* what the app would reload after a reboot */
+static uint32_t *g_persisted;    /* last_run, as made durable by persist_last_run */
+static uint32_t *g_last_fired;   /* latest occurrence fired per schedule, survives reboots */
+static bench_run_t g_run;
+
+static uint32_t bench_rand(void)
+{
+  uint32_t x = g_rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  g_rng = x;
+  return x;
+}
+
+static uint32_t bench_wall(const bench_run_t *r)
+{
+  return (uint32_t)((int64_t)BENCH_EPOCH_S + r->real_s + r->offset_s);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Scheduler hooks                                                            */
+/* -------------------------------------------------------------------------- */
+
+static void bench_due(const sched_entry_t *entry, uint32_t deadline, void *user_ctx)
+{
+  bench_run_t *r = (bench_run_t *)user_ctx;
+  uint32_t i = entry->id;
+  if (g_last_fired[i] && deadline <= g_last_fired[i]) {
+    r->double_fires++;
+  }
+  g_last_fired[i] = deadline;
+  uint32_t late = bench_wall(r) - deadline;
+  if (late > SCHED_DEFAULT_MAX_LATE_S) {
+    r->catch_up++;
+    return;
+  }
+  if (r->fires < BENCH_MAX_FIRES) {
+    r->late[r->fires] = late;
+  }
+  r->fires++;
+}
+
+static os_err_t bench_persist(const sched_entry_t *entry, void *user_ctx)
+{
+  (void)user_ctx;
+  g_persisted[entry->id] = entry->last_run;
+  return OS_OK;
+}
+
+static void bench_boot(bench_run_t *r)
+{
+  const sched_config_t cfg = {
+    .on_due = bench_due,
+    .due_ctx = r,
+    .persist_last_run = bench_persist,
+  };
+  if (sched_init(&cfg) != OS_OK) {
+    fprintf(stderr, "sched_init failed\n");
+    exit(1);
+  }
+  for (uint32_t i = 0; i < g_n; i++) {
+    sched_entry_t e = g_table[i];
+    e.last_run = g_persisted[i];
+    if (sched_add(&e) != OS_OK) {
+      fprintf(stderr, "sched_add failed (SCHED_MAX_ENTRIES=%u)\n", (unsigned)SCHED_MAX_ENTRIES);
+      exit(1);
+    }
+  }
+}
+
+static void bench_collect(bench_run_t *r)
+{
+  sched_stats_t st;
+  sched_get_stats(&st);
+  r->total.wakeups += st.wakeups;
+  r->total.idle_wakeups += st.idle_wakeups;
+  r->total.fires += st.fires;
+  r->total.skipped += st.skipped;
+  r->total.time_jumps += st.time_jumps;
+  r->total.rekeyed += st.rekeyed;
+  if (st.jitter_max_s > r->total.jitter_max_s) {
+    r->total.jitter_max_s = st.jitter_max_s;
+  }
+  r->total.jitter_sum_s += st.jitter_sum_s;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Day                                                                        */
+/* -------------------------------------------------------------------------- */
+
+/* Real second of the next wake-up: the next deadline (plus timer slack) or the next poll */
+static uint32_t bench_next_wake(const bench_run_t *r)
+{
+  if (r->poll_s) {
+    return r->real_s + r->poll_s;
+  }
+  uint32_t deadline = sched_next_deadline();
+  if (deadline == SCHED_NO_DEADLINE) {
+    return UINT32_MAX;
+  }
+  uint32_t wall = bench_wall(r);
+  uint32_t wake = r->real_s + (deadline > wall ? deadline - wall : 0u);
+  return wake + (g_slop_s ? bench_rand() % (g_slop_s + 1u) : 0u);
+}
+
+static void bench_event(bench_run_t *r, const bench_ev_t *ev)
+{
+  if (ev->kind == BENCH_EV_JUMP) {
+    r->offset_s += ev->delta_s;
+    sched_on_time_jump(bench_wall(r), ev->delta_s);
+    return;
+  }
+  bench_collect(r);
+  r->reboots++;
+  r->real_s += ev->down_s;
+  r->offset_s += ev->delta_s;  /* whatever the RTC kept */
+  bench_boot(r);
+}
+
+static void bench_day(bench_run_t *r)
+{
+  g_rng = 0x5EED1234u;
+  memset(g_persisted, 0, g_n * sizeof(g_persisted[0]));
+  memset(g_last_fired, 0, g_n * sizeof(g_last_fired[0]));
+  bench_boot(r);
+
+  size_t ev = 0;
+  uint32_t wake = bench_next_wake(r);
+  for (;;) {
+    uint32_t ev_at = ev < sizeof(s_day) / sizeof(s_day[0]) ? s_day[ev].at_s : UINT32_MAX;
+    if (ev_at <= wake && ev_at < BENCH_DAY_S) {
+      r->real_s = ev_at;
+      bench_event(r, &s_day[ev++]);
+    } else if (wake < BENCH_DAY_S) {
+      r->real_s = wake;
+      (void)sched_process(bench_wall(r));
+    } else {
+      break;
+    }
+    wake = bench_next_wake(r);
+  }
+  bench_collect(r);
+}
+
+static int bench_cmp_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void bench_print(bench_run_t *r)
+{
+  uint32_t n = r->fires < BENCH_MAX_FIRES ? r->fires : BENCH_MAX_FIRES;
+  qsort(r->late, n, sizeof(r->late[0]), bench_cmp_u32);
+  printf("%-14s %8u %8u %7u %7u %7u %7u %5u %5u %5u %6u\n", r->name, (unsigned)r->total.wakeups,
+         (unsigned)r->total.idle_wakeups, (unsigned)r->total.fires, (unsigned)r->catch_up, (unsigned)r->total.skipped,
+         (unsigned)r->total.rekeyed, n ? (unsigned)r->late[n / 2u] : 0u, n ? (unsigned)r->late[(n * 99u) / 100u] : 0u,
+         n ? (unsigned)r->late[n - 1u] : 0u, (unsigned)r->double_fires);
+}
+
+int main(int argc, char **argv)
+{
+  g_n = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : SCHED_MAX_ENTRIES;
+  g_slop_s = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 0u;
+  uint32_t seed = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 0) : 0xC0FFEEu;
+  if (!g_n || g_n > SCHED_MAX_ENTRIES) {
+    fprintf(stderr, "usage: sched_bench [schedules <= %u] [wake_slop_s] [seed]\n", (unsigned)SCHED_MAX_ENTRIES);
+    return 2;
+  }
+
+  g_table = calloc(g_n, sizeof(*g_table));
+  g_persisted = calloc(g_n, sizeof(*g_persisted));
+  g_last_fired = calloc(g_n, sizeof(*g_last_fired));
+  if (!g_table || !g_persisted || !g_last_fired) {
+    return 1;
+  }
+  g_rng = seed ? seed : 1u;
+  for (uint32_t i = 0; i < g_n; i++) {
+    uint32_t period = BENCH_PERIOD_MIN_S + bench_rand() % (BENCH_PERIOD_MAX_S - BENCH_PERIOD_MIN_S + 1u);
+    g_table[i] = (sched_entry_t){
+      .id = i,
+      .slot = (uint16_t)(i % 16u),
+      .missed_policy = (i & 1u) ? SCHED_MISSED_RUN_ONCE : SCHED_MISSED_SKIP,
+      .first_run = BENCH_EPOCH_S + bench_rand() % period,
+      .period_s = period,
+    };
+  }
+
+  static const struct { const char *name; uint32_t poll_s; } modes[] = {
+    { "next-deadline", 0u },
+    { "poll 30 s",     BENCH_POLL_S },
+  };
+  printf("%u schedules, %u-%u s periods, wake slack 0-%u s, one day with %u clock events\n\n", (unsigned)g_n,
+         (unsigned)BENCH_PERIOD_MIN_S, (unsigned)BENCH_PERIOD_MAX_S, (unsigned)g_slop_s,
+         (unsigned)(sizeof(s_day) / sizeof(s_day[0])));
+  printf("%-14s %8s %8s %7s %7s %7s %7s %5s %5s %5s %6s\n", "driver", "wakeups", "idle", "fires", "catchup",
+         "skipped", "rekeyed", "p50", "p99", "max", "double");
+  int failed = 0;
+  for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+    memset(&g_run, 0, sizeof(g_run));
+    g_run.name = modes[m].name;
+    g_run.poll_s = modes[m].poll_s;
+    bench_day(&g_run);
+    bench_print(&g_run);
+    failed |= g_run.double_fires != 0u || g_run.reboots != 2u;
+  }
+  printf("\nwakeups: sched_process() calls per day; p50/p99/max: jitter of on-time fires in s;\n"
+         "catchup: RUN_ONCE fires after a jump or reboot; double must be 0\n");
+  return failed;
+}
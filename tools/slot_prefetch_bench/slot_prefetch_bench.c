@@ -0,0 +1,364 @@
+/* slot_prefetch_bench.c — schedule-to-frame latency with and without prefetch
+ *
+ * Runs the real scheduler.c and slot_prefetch.c for one simulated day
+ * against a modelled slot store. The store charges read_us per load and the
+ * renderer render_us per frame on a virtual clock, so latencies are a model
+ * (override on the command line) while hits, misses and frame checks are
+ * exact:
+ *
+ *   slot_prefetch_bench [schedules] [read_us] [render_us] [edits/day] [lead_s]
+ *
+ * Every day also rewrites slots (EVT_IR_SLOT_WRITTEN), edits the schedule
+ * table (EVT_SCHEDULE_TABLE_UPDATED) and corrupts a few stored slots. Some
+ * rewrites and edits are aimed at the staged frame: the slot of the next due
+ * schedule is rewritten, or the schedule is pointed at another slot, inside
+ * lead_s of its deadline. Each frame handed out is compared with a fresh
+ * render of the slot's current contents, so a stale prefetch is caught.
+ * Exits 1 if a frame is wrong or the aimed changes invalidated nothing.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os_crc32.h"
+#include "scheduler.h"
+#include "slot_prefetch.h"
+
+#define BENCH_DAY_S          86400u
+#define BENCH_SLOTS          32u
+#define BENCH_MAX_SCHEDULES  SCHED_MAX_ENTRIES
+#define BENCH_MAX_DUE        16u      /* fired in one second */
+#define BENCH_MAX_SAMPLES    65536u
+#define BENCH_PERIOD_MIN_S   120u
+#define BENCH_PERIOD_MAX_S   1800u
+#define BENCH_REWRITES_DAY   24u
+#define BENCH_CORRUPT_DAY    4u
+#define BENCH_STAGED_DAY     24u      /* rewrites / edits aimed at the staged frame */
+/* rmt_symbol_word_t: duration0 bits 0-14, level0 bit 15, duration1 bits 16-30, level1 bit 31 */
+#define BENCH_SYMBOL(l0, d0, l1, d1) \
+  ((uint32_t)(d0) | ((uint32_t)(l0) << 15) | ((uint32_t)(d1) << 16) | ((uint32_t)(l1) << 31))
+#define BENCH_LEADER         BENCH_SYMBOL(1u, 9000u, 0u, 4500u)  /* NEC leader at 1 MHz */
+
+typedef struct {
+  uint8_t  data[SLOT_PREFETCH_DATA_MAX];  /* as stored, possibly corrupted */
+  uint8_t  good[SLOT_PREFETCH_DATA_MAX];  /* as last written */
+  uint16_t len;
+  uint32_t crc32;
+} bench_slot_t;
+
+typedef struct {
+  uint32_t read_us;
+  uint32_t render_us;
+  uint64_t clock_us;       /* modelled time */
+  uint32_t rng;
+  bench_slot_t slots[BENCH_SLOTS];
+  uint32_t due[BENCH_MAX_DUE];
+  uint32_t due_len;
+} bench_env_t;
+
+typedef struct {
+  const char *name;
+  uint32_t dues;
+  uint32_t rejected;       /* slot failed its CRC: not sent (both modes) */
+  uint32_t wrong;          /* frame differs from the slot's current contents */
+  uint32_t samples;
+  uint32_t lat_us[BENCH_MAX_SAMPLES];
+} bench_result_t;
+
+static bench_env_t g_env;
+
+static uint32_t bench_rand(void)
+{
+  uint32_t x = g_env.rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  g_env.rng = x;
+  return x;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Modelled slot store and renderer                                           */
+/* -------------------------------------------------------------------------- */
+
+static os_err_t bench_load(uint16_t slot, void *buf, uint16_t cap, uint16_t *len, uint32_t *crc32, void *ctx)
+{
+  (void)ctx;
+  if (slot >= BENCH_SLOTS || g_env.slots[slot].len > cap) {
+    return OS_EINVAL;
+  }
+  g_env.clock_us += g_env.read_us;
+  memcpy(buf, g_env.slots[slot].data, g_env.slots[slot].len);
+  *len = g_env.slots[slot].len;
+  *crc32 = g_env.slots[slot].crc32;
+  return OS_OK;
+}
+
+/* Stored symbols with the leader restored, as the IR replay path does */
+static uint16_t bench_expand(const void *data, uint16_t len, uint32_t *symbols, uint16_t cap)
+{
+  uint16_t num = (uint16_t)(len / sizeof(uint32_t));
+  if (num > cap) {
+    return 0u;
+  }
+  memcpy(symbols, data, (size_t)num * sizeof(uint32_t));
+  if (num) {
+    symbols[0] = BENCH_LEADER;
+  }
+  return num;
+}
+
+static os_err_t bench_render(uint16_t slot, const void *data, uint16_t len,
+                             uint32_t *symbols, uint16_t cap, uint16_t *num, void *ctx)
+{
+  (void)slot;
+  (void)ctx;
+  g_env.clock_us += g_env.render_us;
+  *num = bench_expand(data, len, symbols, cap);
+  return *num ? OS_OK : OS_EINVAL;
+}
+
+static uint32_t bench_now_us(void *ctx)
+{
+  (void)ctx;
+  return (uint32_t)g_env.clock_us;
+}
+
+static void bench_write_slot(uint16_t slot, bool publish)
+{
+  bench_slot_t *s = &g_env.slots[slot];
+  s->len = (uint16_t)((34u + bench_rand() % 30u) * sizeof(uint32_t));
+  for (uint16_t i = 0; i < s->len; i++) {
+    s->good[i] = (uint8_t)bench_rand();
+  }
+  s->crc32 = os_crc32_copy(s->data, s->good, s->len, OS_CRC32_INIT);
+  if (publish) {
+    os_evt_t evt = { .id = EVT_IR_SLOT_WRITTEN, .src = OS_MOD_IR, .len = sizeof(evt_ir_slot_written_t) };
+    evt_ir_slot_written_t p = { .slot = slot, .crc32 = s->crc32 };
+    memcpy(evt.payload, &p, sizeof(p));
+    (void)slot_prefetch_process(&evt);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Schedules                                                                  */
+/* -------------------------------------------------------------------------- */
+
+static void bench_due(const sched_entry_t *entry, uint32_t deadline, void *user_ctx)
+{
+  (void)deadline;
+  (void)user_ctx;
+  if (g_env.due_len < BENCH_MAX_DUE) {
+    g_env.due[g_env.due_len++] = entry->id;
+  }
+}
+
+static void bench_add_schedule(uint32_t id, uint32_t now_s)
+{
+  uint32_t period = BENCH_PERIOD_MIN_S + bench_rand() % (BENCH_PERIOD_MAX_S - BENCH_PERIOD_MIN_S);
+  sched_entry_t e = {
+    .id = id,
+    .slot = (uint16_t)(bench_rand() % BENCH_SLOTS),
+    .missed_policy = SCHED_MISSED_RUN_ONCE,
+    .first_run = now_s + 1u + bench_rand() % period,
+    .period_s = period,
+  };
+  (void)sched_add(&e);
+}
+
+/* Inside lead_s of the next deadline: rewrite its slot, or point the schedule at another one */
+static bool bench_edit_staged(uint32_t now_s, uint32_t lead_s, uint32_t n)
+{
+  sched_entry_t head;
+  uint32_t deadline;
+  if (sched_peek_next(&head, &deadline) != OS_OK || deadline <= now_s || deadline - now_s > lead_s) {
+    return false;
+  }
+  if (n & 1u) {
+    bench_write_slot(head.slot, true);
+    return true;
+  }
+  /* Same deadline: sched_add() re-keys from last_run / first_run */
+  head.slot = (uint16_t)((head.slot + 1u + bench_rand() % (BENCH_SLOTS - 1u)) % BENCH_SLOTS);
+  (void)sched_add(&head);
+  os_evt_t evt = { .id = EVT_SCHEDULE_TABLE_UPDATED, .src = OS_MOD_SCHED };
+  (void)slot_prefetch_process(&evt);
+  return true;
+}
+
+/* One EVT_SCHEDULE_DUE: claim the frame, check it against the slot */
+static void bench_claim(bench_result_t *r, uint32_t id)
+{
+  const uint32_t *symbols = NULL;
+  uint16_t num = 0;
+  uint64_t t0 = g_env.clock_us;
+  r->dues++;
+  os_err_t err = slot_prefetch_acquire(id, &symbols, &num);
+  if (err == OS_ECRC) {
+    r->rejected++;
+    return;
+  }
+  if (err != OS_OK) {
+    r->wrong++;
+    return;
+  }
+  if (r->samples < BENCH_MAX_SAMPLES) {
+    r->lat_us[r->samples++] = (uint32_t)(g_env.clock_us - t0);
+  }
+
+  sched_entry_t e;
+  uint32_t expect[SLOT_PREFETCH_SYMBOLS_MAX];
+  const bench_slot_t *s = NULL;
+  if (sched_get(id, &e) == OS_OK) {
+    s = &g_env.slots[e.slot];
+  }
+  if (!s || bench_expand(s->good, s->len, expect, SLOT_PREFETCH_SYMBOLS_MAX) != num ||
+      memcmp(expect, symbols, (size_t)num * sizeof(uint32_t)) != 0) {
+    r->wrong++;
+  }
+  slot_prefetch_release();
+}
+
+static void bench_day(bench_result_t *r, uint32_t schedules, uint32_t edits, uint32_t lead_s, bool prefetch)
+{
+  const sched_config_t scfg = { .on_due = bench_due };
+  const slot_prefetch_config_t pcfg = {
+    .source = { .load = bench_load, .render = bench_render, .now_us = bench_now_us },
+    .lead_s = lead_s,
+  };
+  memset(&g_env.slots, 0, sizeof(g_env.slots));
+  g_env.rng = 0x2545F491u;
+  g_env.clock_us = 0u;
+  g_env.due_len = 0u;
+  (void)sched_init(&scfg);
+  (void)slot_prefetch_init(&pcfg);
+  for (uint16_t i = 0; i < BENCH_SLOTS; i++) {
+    bench_write_slot(i, false);
+  }
+  for (uint32_t id = 0; id < schedules; id++) {
+    bench_add_schedule(id, 0u);
+  }
+
+  os_evt_t table_evt = { .id = EVT_SCHEDULE_TABLE_UPDATED, .src = OS_MOD_SCHED };
+  uint32_t next_prefetch = 0u;
+  uint32_t staged_edits = 0u;
+  bool aim = false;
+  for (uint32_t t = 1; t <= BENCH_DAY_S; t++) {
+    if (edits && t % (BENCH_DAY_S / edits) == 0u) {
+      bench_add_schedule(bench_rand() % schedules, t);
+      (void)slot_prefetch_process(&table_evt);
+      next_prefetch = t;
+    }
+    if (t % (BENCH_DAY_S / BENCH_REWRITES_DAY) == 0u) {
+      bench_write_slot((uint16_t)(bench_rand() % BENCH_SLOTS), true);
+      next_prefetch = t;
+    }
+    if (t % (BENCH_DAY_S / BENCH_CORRUPT_DAY) == 0u) {
+      /* Bit rot: no event, the CRC check has to catch it */
+      bench_slot_t *s = &g_env.slots[bench_rand() % BENCH_SLOTS];
+      s->data[bench_rand() % s->len] ^= 0x10u;
+    }
+    if (t % (BENCH_DAY_S / BENCH_STAGED_DAY) == 0u) {
+      aim = true;
+    }
+
+    if (t >= sched_next_deadline()) {
+      (void)sched_process(t);
+      next_prefetch = t;
+    }
+    /* The scheduler task prefetches; the IR task claims on EVT_SCHEDULE_DUE */
+    if (prefetch && t >= next_prefetch) {
+      next_prefetch = slot_prefetch_tick(t);
+    }
+    /* Same seconds in both modes: the staged frame is whatever the prefetch mode has just prepared */
+    if (aim && bench_edit_staged(t, lead_s, staged_edits)) {
+      aim = false;
+      staged_edits++;
+      if (prefetch) {
+        next_prefetch = slot_prefetch_tick(t);
+      }
+    }
+    for (uint32_t i = 0; i < g_env.due_len; i++) {
+      bench_claim(r, g_env.due[i]);
+    }
+    /* Release frees the buffer for the next head */
+    if (prefetch && g_env.due_len) {
+      next_prefetch = slot_prefetch_tick(t);
+    }
+    g_env.due_len = 0u;
+  }
+}
+
+static int bench_cmp_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void bench_report(bench_result_t *r, slot_prefetch_stats_t *st_out)
+{
+  slot_prefetch_stats_t st;
+  slot_prefetch_get_stats(&st);
+  *st_out = st;
+  qsort(r->lat_us, r->samples, sizeof(r->lat_us[0]), bench_cmp_u32);
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < r->samples; i++) {
+    sum += r->lat_us[i];
+  }
+  uint32_t n = r->samples;
+  uint32_t claims = st.hits + st.misses;
+  printf("%-12s %6u %6u %6u %7.1f%% %8.1f %8u %8u %8u %6u %6u %6u %6u %6u\n", r->name,
+         (unsigned)r->dues, (unsigned)st.hits, (unsigned)st.misses,
+         claims ? 100.0 * (double)st.hits / (double)claims : 0.0,
+         n ? (double)sum / (double)n : 0.0, n ? (unsigned)r->lat_us[n / 2u] : 0u,
+         n ? (unsigned)r->lat_us[(n * 99u) / 100u] : 0u, n ? (unsigned)r->lat_us[n - 1u] : 0u,
+         (unsigned)(st.saved_us_sum / 1000u), (unsigned)st.invalidated, (unsigned)st.wasted,
+         (unsigned)r->rejected, (unsigned)r->wrong);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t schedules = (argc > 1) ? (uint32_t)atoi(argv[1]) : 16u;
+  g_env.read_us = (argc > 2) ? (uint32_t)atoi(argv[2]) : 600u;
+  g_env.render_us = (argc > 3) ? (uint32_t)atoi(argv[3]) : 80u;
+  uint32_t edits = (argc > 4) ? (uint32_t)atoi(argv[4]) : 48u;
+  uint32_t lead_s = (argc > 5) ? (uint32_t)atoi(argv[5]) : SLOT_PREFETCH_LEAD_S;
+  if (schedules == 0u || schedules > BENCH_MAX_SCHEDULES || edits > BENCH_DAY_S) {
+    fprintf(stderr, "schedules must be 1..%u, edits <= %u\n", (unsigned)BENCH_MAX_SCHEDULES,
+            (unsigned)BENCH_DAY_S);
+    return 1;
+  }
+
+  printf("one day: %u schedules every %u..%u s over %u slots, %u table edits, %u slot rewrites, %u corruptions,\n"
+         "         %u rewrites / edits aimed at the staged frame\n",
+         (unsigned)schedules, (unsigned)BENCH_PERIOD_MIN_S, (unsigned)BENCH_PERIOD_MAX_S,
+         (unsigned)BENCH_SLOTS, (unsigned)edits, (unsigned)BENCH_REWRITES_DAY, (unsigned)BENCH_CORRUPT_DAY,
+         (unsigned)BENCH_STAGED_DAY);
+  printf("model: slot read %u us, render %u us, lead %u s\n\n", (unsigned)g_env.read_us,
+         (unsigned)g_env.render_us, (unsigned)lead_s);
+  printf("%-12s %6s %6s %6s %8s %8s %8s %8s %8s %6s %6s %6s %6s %6s\n", "mode", "dues", "hits", "misses",
+         "hit", "lat_us", "p50", "p99", "max", "saved", "inval", "wasted", "crc", "wrong");
+
+  static bench_result_t results[2];
+  static const char *const names[] = { "cold", "prefetch" };
+  int rc = 0;
+  slot_prefetch_stats_t st;
+  for (int m = 0; m < 2; m++) {
+    bench_result_t *r = &results[m];
+    memset(r, 0, sizeof(*r));
+    r->name = names[m];
+    bench_day(r, schedules, edits, lead_s, m == 1);
+    bench_report(r, &st);
+    if (r->wrong) {
+      rc = 1;
+    }
+  }
+  /* st is the prefetch run's: the aimed changes must have hit a staged frame */
+  if (!st.invalidated) {
+    rc = 1;
+  }
+  printf("\nlat_us: EVT_SCHEDULE_DUE to TX-ready frame (model); saved in ms; inval must be > 0, wrong must be 0\n");
+  printf("%s\n", rc ? "FAILED" : "ok");
+  return rc;
+}
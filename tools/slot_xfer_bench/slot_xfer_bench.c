@@ -0,0 +1,585 @@
+/* slot_xfer_bench.c — slot_xfer over a modelled BLE link: throughput, overhead and resume
+ *
+ * The device side is the real slot_xfer.c; the phone side is a minimal peer
+ * in this file. Frames travel through a loopback that models a BLE
+ * connection: every connection interval carries up to P packets per
+ * direction, and the device's notification queue holds Q frames (OS_EBUSY
+ * beyond that). Virtual time, so results are deterministic.
+ *
+ * Every slot is backed up (device export) and restored (device import), and
+ * the bytes are compared on both ends. For each MTU the run is repeated with
+ * window 1 (one request/response per chunk) and the configured window:
+ *
+ *   slot_xfer_bench [-s slots] [-b slot_bytes] [-w window] [-i interval_ms]
+ *                   [-p packets_per_event] [-q notify_queue] [-d drop_pct]
+ *
+ * -d drops the link once per slot and direction at drop_pct % progress and
+ * reconnects after SXB_RECONNECT_MS; the transfer resumes from the last
+ * acknowledged offset.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "os_crc32.h"
+#include "slot_xfer.h"
+
+#define SXB_MAX_SLOTS     64u
+#define SXB_MAX_SLOT_SIZE 8192u
+#define SXB_QUEUE_MAX     1024u
+#define SXB_TICK_MS       10u
+#define SXB_RECONNECT_MS  500u
+#define SXB_TIMEOUT_MS    600000u
+
+typedef struct {
+  uint32_t slots;
+  uint32_t slot_bytes;
+  uint32_t window;
+  uint32_t interval_us;
+  uint32_t packets;      /* per connection event and direction */
+  uint32_t notify_q;     /* device TX queue depth */
+  uint32_t drop_pct;     /* 0 = never */
+} sxb_config_t;
+
+/* -------------------------------------------------------------------------- */
+/* Link model                                                                 */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  uint64_t at_us;
+  uint16_t len;
+  uint8_t  data[SLOT_XFER_FRAME_MAX];
+} sxb_frame_t;
+
+typedef struct {
+  sxb_frame_t q[SXB_QUEUE_MAX];
+  uint32_t    head;
+  uint32_t    count;
+  uint64_t    event;     /* connection event of the last queued frame */
+  uint32_t    in_event;  /* frames already in that event */
+} sxb_dir_t;
+
+typedef struct {
+  sxb_config_t cfg;
+  uint64_t     now_us;
+  sxb_dir_t    to_phone;
+  sxb_dir_t    to_dev;
+  uint8_t      up;
+} sxb_link_t;
+
+static sxb_link_t g_link;
+
+static void sxb_dir_reset(sxb_dir_t *d)
+{
+  d->head = d->count = 0u;
+  d->event = 0u;
+  d->in_event = 0u;
+}
+
+/* Frames ride the first connection event after now with room left */
+static int sxb_enqueue(sxb_dir_t *d, const void *data, uint16_t len)
+{
+  if (d->count >= SXB_QUEUE_MAX) {
+    return 0;
+  }
+  uint64_t ev = g_link.now_us / g_link.cfg.interval_us + 1u;
+  if (ev <= d->event) {
+    ev = d->event;
+    if (d->in_event >= g_link.cfg.packets) {
+      ev++;
+    }
+  }
+  if (ev != d->event) {
+    d->event = ev;
+    d->in_event = 0u;
+  }
+  d->in_event++;
+
+  sxb_frame_t *f = &d->q[(d->head + d->count) % SXB_QUEUE_MAX];
+  f->at_us = ev * g_link.cfg.interval_us;
+  f->len = len;
+  memcpy(f->data, data, len);
+  d->count++;
+  return 1;
+}
+
+static os_err_t sxb_dev_send(const void *frame, uint16_t len, void *ctx)
+{
+  (void)ctx;
+  if (!g_link.up) {
+    return OS_EFAIL;
+  }
+  if (g_link.to_phone.count >= g_link.cfg.notify_q) {
+    return OS_EBUSY;
+  }
+  return sxb_enqueue(&g_link.to_phone, frame, len) ? OS_OK : OS_EBUSY;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Device storage                                                             */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  uint8_t  data[SXB_MAX_SLOT_SIZE];
+  uint32_t size;
+  uint32_t crc32;
+} sxb_slot_t;
+
+static sxb_slot_t g_dev_slots[SXB_MAX_SLOTS];
+static sxb_slot_t g_dev_import;     /* staging area of the slot being imported */
+static uint32_t   g_dev_import_written;
+static os_err_t   g_done_result;
+static int        g_done;
+
+static os_err_t sxb_info(uint16_t slot, uint32_t *size, uint32_t *crc32, void *ctx)
+{
+  (void)ctx;
+  if (slot >= SXB_MAX_SLOTS || !g_dev_slots[slot].size) {
+    return OS_EINVAL;
+  }
+  *size = g_dev_slots[slot].size;
+  *crc32 = g_dev_slots[slot].crc32;
+  return OS_OK;
+}
+
+static os_err_t sxb_read(uint16_t slot, uint32_t off, void *buf, uint16_t len, void *ctx)
+{
+  (void)ctx;
+  memcpy(buf, &g_dev_slots[slot].data[off], len);
+  return OS_OK;
+}
+
+static os_err_t sxb_begin(uint16_t slot, uint32_t size, void *ctx)
+{
+  (void)ctx;
+  if (slot >= SXB_MAX_SLOTS || size > SXB_MAX_SLOT_SIZE) {
+    return OS_EFULL;
+  }
+  g_dev_import.size = size;
+  g_dev_import_written = 0u;
+  return OS_OK;
+}
+
+static os_err_t sxb_write(uint16_t slot, uint32_t off, const void *data, uint16_t len, void *ctx)
+{
+  (void)slot;
+  (void)ctx;
+  if (off != g_dev_import_written) {
+    return OS_EFAIL;  /* slot_xfer promises in-order writes */
+  }
+  memcpy(&g_dev_import.data[off], data, len);
+  g_dev_import_written += len;
+  return OS_OK;
+}
+
+static os_err_t sxb_commit(uint16_t slot, uint32_t crc32, void *ctx)
+{
+  (void)ctx;
+  g_dev_import.crc32 = crc32;
+  g_dev_slots[slot] = g_dev_import;
+  return OS_OK;
+}
+
+static void sxb_done(slot_xfer_dir_t dir, uint16_t slot, os_err_t result, void *user_ctx)
+{
+  (void)dir;
+  (void)slot;
+  (void)user_ctx;
+  g_done_result = result;
+  g_done = 1;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Phone peer                                                                 */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  uint8_t  data[SXB_MAX_SLOT_SIZE];
+  uint32_t size;
+  uint32_t crc32;
+  uint32_t crc_run;
+  uint32_t next;       /* receiving: next expected; sending: acked */
+  uint32_t sent;
+  uint32_t since_ack;
+  uint8_t  credit;
+  uint8_t  started;    /* sending: device acked the START */
+  uint8_t  done;
+  os_err_t result;
+  uint16_t chunk;
+  uint16_t slot;
+} sxb_phone_t;
+
+static sxb_phone_t g_phone;
+static uint8_t g_phone_window;
+
+static void sxb_put32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t sxb_get32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void sxb_phone_send(const uint8_t *frame, uint16_t len)
+{
+  if (g_link.up) {
+    sxb_enqueue(&g_link.to_dev, frame, len);
+  }
+}
+
+static void sxb_phone_ack(uint8_t flags, os_err_t status)
+{
+  uint8_t f[8] = { SLOT_XFER_T_ACK, flags };
+  sxb_put32(&f[2], g_phone.next);
+  f[6] = g_phone_window;
+  f[7] = (uint8_t)(int8_t)status;
+  sxb_phone_send(f, sizeof(f));
+  g_phone.since_ack = 0u;
+}
+
+static void sxb_phone_req(void)
+{
+  uint8_t f[8] = { SLOT_XFER_T_REQ, 0u, (uint8_t)g_phone.slot, (uint8_t)(g_phone.slot >> 8) };
+  sxb_put32(&f[4], g_phone.next);
+  sxb_phone_send(f, sizeof(f));
+}
+
+static void sxb_phone_start(void)
+{
+  uint8_t f[16] = { SLOT_XFER_T_START, 0u, (uint8_t)g_phone.slot, (uint8_t)(g_phone.slot >> 8) };
+  sxb_put32(&f[4], g_phone.size);
+  sxb_put32(&f[8], g_phone.crc32);
+  sxb_put32(&f[12], 0u);
+  g_phone.started = 0u;
+  sxb_phone_send(f, sizeof(f));
+}
+
+static void sxb_phone_pump(void)
+{
+  uint8_t f[SLOT_XFER_FRAME_MAX];
+  uint8_t window = g_phone.credit < g_phone_window ? g_phone.credit : g_phone_window;
+  uint32_t in_flight_max = (uint32_t)window * g_phone.chunk;
+  while (g_phone.started && g_phone.sent < g_phone.size && g_phone.sent - g_phone.next < in_flight_max) {
+    uint32_t n = g_phone.size - g_phone.sent < g_phone.chunk ? g_phone.size - g_phone.sent : g_phone.chunk;
+    f[0] = SLOT_XFER_T_DATA;
+    f[1] = (g_phone.sent + n == g_phone.size || g_phone.sent + n - g_phone.next >= in_flight_max)
+             ? SLOT_XFER_F_ACKREQ : 0u;
+    sxb_put32(&f[2], g_phone.sent);
+    memcpy(&f[SLOT_XFER_DATA_HDR_LEN], &g_phone.data[g_phone.sent], n);
+    sxb_phone_send(f, (uint16_t)(SLOT_XFER_DATA_HDR_LEN + n));
+    g_phone.sent += n;
+  }
+}
+
+static void sxb_phone_on_rx(const uint8_t *f, uint16_t len)
+{
+  switch (f[0]) {
+  case SLOT_XFER_T_START:  /* backup: size, crc, first offset */
+    g_phone.size = sxb_get32(&f[4]);
+    g_phone.crc32 = sxb_get32(&f[8]);
+    if (sxb_get32(&f[12]) == 0u) {
+      g_phone.next = 0u;
+      g_phone.crc_run = OS_CRC32_INIT;
+    }
+    break;
+  case SLOT_XFER_T_DATA: {
+    uint32_t off = sxb_get32(&f[2]);
+    uint16_t n = (uint16_t)(len - SLOT_XFER_DATA_HDR_LEN);
+    if (off != g_phone.next) {
+      if (off > g_phone.next) {
+        sxb_phone_ack(0u, OS_OK);
+      }
+      break;
+    }
+    memcpy(&g_phone.data[off], &f[SLOT_XFER_DATA_HDR_LEN], n);
+    g_phone.crc_run = os_crc32_update(g_phone.crc_run, &f[SLOT_XFER_DATA_HDR_LEN], n);
+    g_phone.next += n;
+    if (g_phone.next == g_phone.size) {
+      g_phone.result = (g_phone.crc_run == g_phone.crc32) ? OS_OK : OS_ECRC;
+      g_phone.done = 1u;
+      sxb_phone_ack(SLOT_XFER_F_DONE, g_phone.result);
+    } else if (++g_phone.since_ack >= SLOT_XFER_ACK_EVERY || (f[1] & SLOT_XFER_F_ACKREQ)) {
+      sxb_phone_ack(0u, OS_OK);
+    }
+    break;
+  }
+  case SLOT_XFER_T_ACK: {  /* restore */
+    uint32_t next = sxb_get32(&f[2]);
+    g_phone.credit = f[6] ? f[6] : 1u;
+    if (f[1] & SLOT_XFER_F_DONE) {
+      g_phone.result = (int8_t)f[7];
+      g_phone.done = 1u;
+      break;
+    }
+    if (!g_phone.started) {
+      g_phone.started = 1u;
+      g_phone.next = g_phone.sent = next;  /* 0, or where a resumed import stands */
+    } else if (next > g_phone.next) {
+      g_phone.next = next;
+    } else if (next < g_phone.sent) {
+      g_phone.sent = next;
+    }
+    sxb_phone_pump();
+    break;
+  }
+  case SLOT_XFER_T_ABORT:
+    g_phone.result = (int8_t)f[2];
+    g_phone.done = 1u;
+    break;
+  default:
+    break;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Run                                                                        */
+/* -------------------------------------------------------------------------- */
+
+static void sxb_link_set(uint8_t up)
+{
+  g_link.up = up;
+  sxb_dir_reset(&g_link.to_phone);
+  sxb_dir_reset(&g_link.to_dev);
+  evt_ble_conn_changed_t conn = { .state = up ? OS_LINK_UP : OS_LINK_DOWN };
+  os_evt_t evt = { .id = EVT_BLE_CONN_CHANGED, .src = OS_MOD_BLE, .len = sizeof(conn) };
+  memcpy(evt.payload, &conn, sizeof(conn));
+  slot_xfer_process(&evt);
+}
+
+static void sxb_set_mtu(uint16_t mtu)
+{
+  evt_ble_sec_changed_t sec = { .bonded = 1, .encrypted = 1, .mtu = mtu };
+  os_evt_t evt = { .id = EVT_BLE_SEC_CHANGED, .src = OS_MOD_BLE, .len = sizeof(sec) };
+  memcpy(evt.payload, &sec, sizeof(sec));
+  slot_xfer_process(&evt);
+}
+
+/* Percent of the current slot the phone has (backup) or the device has acked (restore) */
+static uint32_t sxb_progress(void)
+{
+  return g_phone.size ? (uint32_t)((uint64_t)g_phone.next * 100u / g_phone.size) : 0u;
+}
+
+/* Runs the link until both ends report the end of the transfer; returns 0 on success */
+static int sxb_transfer(int restore, uint16_t mtu)
+{
+  uint64_t next_tick_us = g_link.now_us;
+  uint64_t deadline_us = g_link.now_us + (uint64_t)SXB_TIMEOUT_MS * 1000u;
+  int dropped = 0;
+  g_done = 0;
+  g_phone.done = 0u;
+
+  if (restore) {
+    sxb_phone_start();
+  } else {
+    sxb_phone_req();
+  }
+  while (!(g_done && g_phone.done) && g_link.now_us < deadline_us) {
+    if (!dropped && g_link.cfg.drop_pct && sxb_progress() >= g_link.cfg.drop_pct) {
+      dropped = 1;
+      sxb_link_set(0u);
+      g_link.now_us += (uint64_t)SXB_RECONNECT_MS * 1000u;
+      sxb_link_set(1u);
+      sxb_set_mtu(mtu);
+      if (restore) {
+        sxb_phone_start();  /* the device answers with where it stands */
+      } else {
+        sxb_phone_req();    /* ask for the rest */
+      }
+      continue;
+    }
+
+    sxb_dir_t *d = NULL;
+    if (g_link.to_phone.count && (!g_link.to_dev.count ||
+                                  g_link.to_phone.q[g_link.to_phone.head].at_us <=
+                                  g_link.to_dev.q[g_link.to_dev.head].at_us)) {
+      d = &g_link.to_phone;
+    } else if (g_link.to_dev.count) {
+      d = &g_link.to_dev;
+    }
+    if (!d || d->q[d->head].at_us > next_tick_us) {
+      g_link.now_us = next_tick_us;
+      slot_xfer_tick((uint32_t)(g_link.now_us / 1000u));
+      next_tick_us += SXB_TICK_MS * 1000u;
+      continue;
+    }
+
+    sxb_frame_t *f = &d->q[d->head];
+    if (f->at_us > g_link.now_us) {
+      g_link.now_us = f->at_us;
+    }
+    d->head = (d->head + 1u) % SXB_QUEUE_MAX;
+    d->count--;
+    if (d == &g_link.to_phone) {
+      sxb_phone_on_rx(f->data, f->len);
+      slot_xfer_tick((uint32_t)(g_link.now_us / 1000u));  /* notification queue drained */
+    } else {
+      slot_xfer_on_rx(f->data, f->len);
+    }
+  }
+  return (g_done && g_phone.done && g_done_result == OS_OK && g_phone.result == OS_OK) ? 0 : 1;
+}
+
+typedef struct {
+  double   seconds;   /* modelled link time */
+  double   host_s;
+  uint64_t bytes;
+  int      failed;
+} sxb_phase_t;
+
+static double sxb_now_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void sxb_fill_slots(const sxb_config_t *cfg)
+{
+  uint32_t x = 0x12345678u;
+  for (uint32_t s = 0; s < cfg->slots; s++) {
+    g_dev_slots[s].size = cfg->slot_bytes - (s % 4u) * 4u;  /* not all a chunk multiple */
+    for (uint32_t i = 0; i < g_dev_slots[s].size; i++) {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      g_dev_slots[s].data[i] = (uint8_t)x;
+    }
+    g_dev_slots[s].crc32 = os_crc32_update(OS_CRC32_INIT, g_dev_slots[s].data, g_dev_slots[s].size);
+  }
+}
+
+static int sxb_run(const sxb_config_t *cfg, uint16_t mtu, uint8_t window, sxb_phase_t *backup, sxb_phase_t *restore,
+                   slot_xfer_stats_t *stats)
+{
+  static sxb_slot_t saved[SXB_MAX_SLOTS];
+  slot_xfer_config_t xcfg = {
+    .transport = { .send = sxb_dev_send },
+    .store = { .info = sxb_info, .read = sxb_read, .begin = sxb_begin, .write = sxb_write, .commit = sxb_commit },
+    .done = sxb_done,
+    .window = window,
+  };
+  memset(&g_link, 0, sizeof(g_link));
+  g_link.cfg = *cfg;
+  g_phone_window = window;
+  sxb_fill_slots(cfg);
+  if (slot_xfer_init(&xcfg) != OS_OK) {
+    return 1;
+  }
+  sxb_link_set(1u);
+  sxb_set_mtu(mtu);
+  memset(backup, 0, sizeof(*backup));
+  memset(restore, 0, sizeof(*restore));
+
+  /* Backup every slot to the phone */
+  uint64_t t0 = g_link.now_us;
+  double h0 = sxb_now_s();
+  for (uint32_t s = 0; s < cfg->slots; s++) {
+    memset(&g_phone, 0, sizeof(g_phone));
+    g_phone.slot = (uint16_t)s;
+    backup->failed += sxb_transfer(0, mtu);
+    saved[s].size = g_phone.size;
+    memcpy(saved[s].data, g_phone.data, g_phone.size);
+    backup->failed += (g_phone.size != g_dev_slots[s].size ||
+                       memcmp(g_phone.data, g_dev_slots[s].data, g_phone.size) != 0);
+    backup->bytes += g_dev_slots[s].size;
+  }
+  backup->seconds = (double)(g_link.now_us - t0) * 1e-6;
+  backup->host_s = sxb_now_s() - h0;
+
+  /* Wipe the device and restore every slot from the phone */
+  static sxb_slot_t originals[SXB_MAX_SLOTS];
+  memcpy(originals, g_dev_slots, sizeof(originals));
+  memset(g_dev_slots, 0, sizeof(g_dev_slots));
+  t0 = g_link.now_us;
+  h0 = sxb_now_s();
+  for (uint32_t s = 0; s < cfg->slots; s++) {
+    memset(&g_phone, 0, sizeof(g_phone));
+    g_phone.slot = (uint16_t)s;
+    g_phone.size = saved[s].size;
+    memcpy(g_phone.data, saved[s].data, saved[s].size);
+    g_phone.crc32 = os_crc32_update(OS_CRC32_INIT, g_phone.data, g_phone.size);
+    g_phone.chunk = (uint16_t)(mtu - SLOT_XFER_ATT_OVERHEAD - SLOT_XFER_DATA_HDR_LEN);
+    g_phone.credit = 1u;
+    restore->failed += sxb_transfer(1, mtu);
+    restore->failed += (g_dev_slots[s].size != originals[s].size ||
+                        memcmp(g_dev_slots[s].data, originals[s].data, originals[s].size) != 0);
+    restore->bytes += originals[s].size;
+  }
+  restore->seconds = (double)(g_link.now_us - t0) * 1e-6;
+  restore->host_s = sxb_now_s() - h0;
+  slot_xfer_get_stats(stats);
+  return backup->failed || restore->failed;
+}
+
+static int sxb_usage(void)
+{
+  fprintf(stderr, "usage: slot_xfer_bench [-s slots] [-b slot_bytes] [-w window] [-i interval_ms]\n"
+                  "                       [-p packets_per_event] [-q notify_queue] [-d drop_pct]\n");
+  return 2;
+}
+
+int main(int argc, char **argv)
+{
+  sxb_config_t cfg = {
+    .slots = 32u,
+    .slot_bytes = 2048u,   /* 512 RMT symbols */
+    .window = SLOT_XFER_WINDOW,
+    .interval_us = 30000u,
+    .packets = 4u,
+    .notify_q = 8u,
+  };
+  for (int i = 1; i < argc; i += 2) {
+    if (i + 1 >= argc || argv[i][0] != '-' || !argv[i][1] || argv[i][2]) {
+      return sxb_usage();
+    }
+    uint32_t v = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+    switch (argv[i][1]) {
+    case 's': cfg.slots = v; break;
+    case 'b': cfg.slot_bytes = v; break;
+    case 'w': cfg.window = v; break;
+    case 'i': cfg.interval_us = v * 1000u; break;
+    case 'p': cfg.packets = v; break;
+    case 'q': cfg.notify_q = v; break;
+    case 'd': cfg.drop_pct = v; break;
+    default: return sxb_usage();
+    }
+  }
+  if (!cfg.slots || cfg.slots > SXB_MAX_SLOTS || cfg.slot_bytes < 16u || cfg.slot_bytes > SXB_MAX_SLOT_SIZE ||
+      !cfg.window || cfg.window > 255u || !cfg.interval_us || !cfg.packets || !cfg.notify_q) {
+    return sxb_usage();
+  }
+
+  printf("%u slots of ~%u B, %u ms interval, %u packets/event, notify queue %u, drop at %u%%\n",
+         (unsigned)cfg.slots, (unsigned)cfg.slot_bytes, (unsigned)(cfg.interval_us / 1000u), (unsigned)cfg.packets,
+         (unsigned)cfg.notify_q, (unsigned)cfg.drop_pct);
+  printf("slot_xfer RAM: %u B (context + one %u B frame)\n\n", (unsigned)slot_xfer_ram_bytes(),
+         (unsigned)SLOT_XFER_FRAME_MAX);
+  printf("%4s %6s  %12s %12s  %7s %6s %5s %5s %7s  %9s\n", "mtu", "window", "backup B/s", "restore B/s",
+         "frames", "acks", "retx", "busy", "resumes", "host MB/s");
+
+  static const uint16_t mtus[] = { 23u, 185u, 247u };
+  int failed = 0;
+  for (size_t m = 0; m < sizeof(mtus) / sizeof(mtus[0]); m++) {
+    const uint8_t windows[] = { 1u, (uint8_t)cfg.window };
+    for (size_t w = 0; w < (cfg.window > 1u ? 2u : 1u); w++) {
+      sxb_phase_t b;
+      sxb_phase_t r;
+      slot_xfer_stats_t st;
+      int bad = sxb_run(&cfg, mtus[m], windows[w], &b, &r, &st);
+      failed |= bad;
+      printf("%4u %6u  %12.0f %12.0f  %7u %6u %5u %5u %7u  %9.1f%s\n", (unsigned)mtus[m], (unsigned)windows[w],
+             (double)b.bytes / b.seconds, (double)r.bytes / r.seconds, (unsigned)(st.frames_tx + st.frames_rx),
+             (unsigned)(st.acks_tx + st.acks_rx), (unsigned)st.retransmits, (unsigned)st.busy,
+             (unsigned)st.resumes, (double)(b.bytes + r.bytes) / (b.host_s + r.host_s) * 1e-6,
+             bad ? "  FAILED" : "");
+    }
+  }
+  return failed;
+}
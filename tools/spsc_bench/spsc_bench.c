@@ -0,0 +1,445 @@
+/* spsc_bench.c — cross-thread hand-off: os_spsc ring vs a mutex/condvar queue
+ *
+ * Part 1 (ring): a producer thread stamps N records with a sequence number
+ * and the send time, a consumer thread checks the order and takes the
+ * latency. Same record sizes and capacities for both queues:
+ *
+ *   spsc     os_spsc.c; on full / empty the thread yields and retries
+ *   mutex    pthread mutex + two condvars around a plain ring (the lock a
+ *            FreeRTOS queue takes on every send and receive)
+ *
+ * Part 2 (pipeline): the infrared_test RX path on real code. Stage 1 is
+ * ir_decoder_decode() on captured NEC frames (ir_rx task), stage 2 is what
+ * app_main does per frame: ir_symbols_normalize_frame() and os_crc32 over
+ * the result. Run once on one thread, once split over an os_spsc ring.
+ *
+ *   spsc_bench [-n records] [-f frames] [-p]      -p pins the two threads to CPU 0 / 1
+ *
+ * Exits 1 on a lost, duplicated or reordered record or a frame that does
+ * not decode to the sent code.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "os_spsc.h"
+#include "os_crc32.h"
+#include "ir_decoder.h"
+#include "ir_nec_encoder.h"
+#include "ir_symbol_kernels.h"
+#include "rmt_host.h"
+
+#define BENCH_MAX_RECORD    512u
+#define BENCH_MAX_CAP       256u
+#define BENCH_FRAME_SYMBOLS 64u
+#define BENCH_PIPE_DEPTH    4u      /* EXAMPLE_IR_RX_RING_DEPTH */
+#define BENCH_CODES         256u
+
+typedef enum { BENCH_SPSC, BENCH_MUTEX } bench_kind_t;
+
+/* ---- Mutex/condvar baseline -------------------------------------------- */
+
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t  not_empty;
+  pthread_cond_t  not_full;
+  uint8_t        *buf;
+  uint32_t        cap;
+  uint32_t        elem_size;
+  uint32_t        head;
+  uint32_t        tail;
+  uint32_t        full;
+} mq_t;
+
+static void mq_init(mq_t *q, void *buf, uint32_t elem_size, uint32_t cap)
+{
+  memset(q, 0, sizeof(*q));
+  pthread_mutex_init(&q->lock, NULL);
+  pthread_cond_init(&q->not_empty, NULL);
+  pthread_cond_init(&q->not_full, NULL);
+  q->buf = buf;
+  q->cap = cap;
+  q->elem_size = elem_size;
+}
+
+static void mq_destroy(mq_t *q)
+{
+  pthread_mutex_destroy(&q->lock);
+  pthread_cond_destroy(&q->not_empty);
+  pthread_cond_destroy(&q->not_full);
+}
+
+static void mq_push(mq_t *q, const void *item)
+{
+  pthread_mutex_lock(&q->lock);
+  if (q->head - q->tail == q->cap) {
+    q->full++;
+    while (q->head - q->tail == q->cap) {
+      pthread_cond_wait(&q->not_full, &q->lock);
+    }
+  }
+  memcpy(q->buf + (size_t)(q->head % q->cap) * q->elem_size, item, q->elem_size);
+  q->head++;
+  pthread_cond_signal(&q->not_empty);
+  pthread_mutex_unlock(&q->lock);
+}
+
+static void mq_pop(mq_t *q, void *item)
+{
+  pthread_mutex_lock(&q->lock);
+  while (q->head == q->tail) {
+    pthread_cond_wait(&q->not_empty, &q->lock);
+  }
+  memcpy(item, q->buf + (size_t)(q->tail % q->cap) * q->elem_size, q->elem_size);
+  q->tail++;
+  pthread_cond_signal(&q->not_full);
+  pthread_mutex_unlock(&q->lock);
+}
+
+/* ---- Helpers ----------------------------------------------------------- */
+
+static int g_pin;
+
+static uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void bench_pin(int cpu)
+{
+  if (!g_pin) {
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    fprintf(stderr, "warning: could not pin to CPU %d\n", cpu);
+  }
+}
+
+static int bench_cmp_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static uint32_t bench_pct(uint32_t *sorted, uint32_t n, uint32_t pct)
+{
+  return n ? sorted[(uint64_t)(n - 1u) * pct / 100u] : 0u;
+}
+
+/* ---- Part 1: ring ------------------------------------------------------ */
+
+typedef struct {
+  uint32_t seq;
+  uint32_t pad;
+  uint64_t sent_ns;
+} bench_hdr_t;
+
+typedef struct {
+  bench_kind_t kind;
+  uint32_t     elem_size;
+  uint32_t     cap;
+  uint32_t     records;
+  os_spsc_t    spsc;
+  mq_t         mq;
+  uint32_t    *lat_ns;
+  uint32_t     errors;
+} ring_run_t;
+
+static void *ring_producer(void *arg)
+{
+  ring_run_t *r = arg;
+  uint8_t rec[BENCH_MAX_RECORD];
+  memset(rec, 0xA5, sizeof(rec));
+  bench_pin(0);
+  for (uint32_t i = 0; i < r->records; i++) {
+    bench_hdr_t hdr = { .seq = i, .sent_ns = bench_now_ns() };
+    if (r->kind == BENCH_SPSC) {
+      uint8_t *slot;
+      while ((slot = os_spsc_claim(&r->spsc)) == NULL) {
+        sched_yield();
+      }
+      /* Write in place, as the RX task does into the claimed record */
+      memcpy(slot + sizeof(hdr), rec, r->elem_size - sizeof(hdr));
+      memcpy(slot, &hdr, sizeof(hdr));
+      os_spsc_publish(&r->spsc);
+    } else {
+      memcpy(rec, &hdr, sizeof(hdr));
+      mq_push(&r->mq, rec);
+    }
+  }
+  return NULL;
+}
+
+static void *ring_consumer(void *arg)
+{
+  ring_run_t *r = arg;
+  uint8_t rec[BENCH_MAX_RECORD];
+  bench_pin(1);
+  for (uint32_t i = 0; i < r->records; i++) {
+    bench_hdr_t hdr;
+    if (r->kind == BENCH_SPSC) {
+      const uint8_t *slot;
+      while ((slot = os_spsc_peek(&r->spsc)) == NULL) {
+        sched_yield();
+      }
+      memcpy(&hdr, slot, sizeof(hdr));
+      if (r->elem_size > sizeof(hdr) && slot[r->elem_size - 1u] != 0xA5) {
+        r->errors++;
+      }
+      os_spsc_release(&r->spsc);
+    } else {
+      mq_pop(&r->mq, rec);
+      memcpy(&hdr, rec, sizeof(hdr));
+    }
+    uint64_t lat = bench_now_ns() - hdr.sent_ns;
+    r->lat_ns[i] = lat > UINT32_MAX ? UINT32_MAX : (uint32_t)lat;
+    if (hdr.seq != i) {
+      r->errors++;
+    }
+  }
+  return NULL;
+}
+
+static int ring_run(bench_kind_t kind, uint32_t elem_size, uint32_t cap, uint32_t records)
+{
+  static uint8_t buf[BENCH_MAX_CAP * BENCH_MAX_RECORD];
+  ring_run_t r = { .kind = kind, .elem_size = elem_size, .cap = cap, .records = records };
+  r.lat_ns = malloc(sizeof(uint32_t) * records);
+  if (!r.lat_ns) {
+    return 1;
+  }
+  if (kind == BENCH_SPSC) {
+    os_spsc_init(&r.spsc, buf, elem_size, cap);
+  } else {
+    mq_init(&r.mq, buf, elem_size, cap);
+  }
+
+  pthread_t prod, cons;
+  uint64_t t0 = bench_now_ns();
+  pthread_create(&cons, NULL, ring_consumer, &r);
+  pthread_create(&prod, NULL, ring_producer, &r);
+  pthread_join(prod, NULL);
+  pthread_join(cons, NULL);
+  double secs = (double)(bench_now_ns() - t0) / 1e9;
+
+  uint32_t full;
+  if (kind == BENCH_SPSC) {
+    os_spsc_stats_t st;
+    os_spsc_get_stats(&r.spsc, &st);
+    full = st.full;
+    if (st.pushed != records || st.popped != records || st.depth) {
+      r.errors++;
+    }
+  } else {
+    full = r.mq.full;
+    mq_destroy(&r.mq);
+  }
+
+  qsort(r.lat_ns, records, sizeof(uint32_t), bench_cmp_u32);
+  printf("| %-5s | %4u B | %4u | %7.2f | %8.1f | %8.1f | %9u | %6u |\n",
+         kind == BENCH_SPSC ? "spsc" : "mutex", (unsigned)elem_size, (unsigned)cap,
+         records / secs / 1e6, bench_pct(r.lat_ns, records, 50) / 1000.0,
+         bench_pct(r.lat_ns, records, 99) / 1000.0, (unsigned)full, (unsigned)r.errors);
+  free(r.lat_ns);
+  return r.errors ? 1 : 0;
+}
+
+/* ---- Part 2: IR pipeline ----------------------------------------------- */
+
+typedef struct {
+  rmt_symbol_word_t symbols[BENCH_FRAME_SYMBOLS];
+  size_t            symbol_num;
+  uint16_t          address;
+  uint16_t          command;
+} bench_capture_t;
+
+/* ir_rx_frame_t of the infrared_test app */
+typedef struct {
+  rmt_symbol_word_t   symbols[BENCH_FRAME_SYMBOLS];
+  size_t              symbol_num;
+  const ir_decoder_t *decoder;
+  ir_scan_code_t      scan_code;
+  uint32_t            index;
+} bench_rx_frame_t;
+
+typedef struct {
+  const bench_capture_t *captures;
+  uint32_t               frames;
+  os_spsc_t              ring;
+  bench_rx_frame_t       slots[BENCH_PIPE_DEPTH];
+  uint32_t               crc;
+  uint32_t               errors;
+} pipe_run_t;
+
+static void pipe_decode(const bench_capture_t *cap, bench_rx_frame_t *f, uint32_t index)
+{
+  memcpy(f->symbols, cap->symbols, cap->symbol_num * sizeof(rmt_symbol_word_t));
+  f->symbol_num = cap->symbol_num;
+  f->decoder = ir_decoder_decode(f->symbols, f->symbol_num, &f->scan_code);
+  f->index = index;
+}
+
+static void pipe_store(pipe_run_t *p, const bench_rx_frame_t *f)
+{
+  const bench_capture_t *cap = &p->captures[f->index % BENCH_CODES];
+  rmt_symbol_word_t normalized[BENCH_FRAME_SYMBOLS];
+  if (!f->decoder || f->scan_code.address != cap->address || f->scan_code.command != cap->command) {
+    p->errors++;
+  }
+  ir_symbols_normalize_frame(f->symbols, normalized, f->symbol_num);
+  p->crc = os_crc32_update(p->crc, normalized, f->symbol_num * sizeof(rmt_symbol_word_t));
+}
+
+static void *pipe_rx_task(void *arg)
+{
+  pipe_run_t *p = arg;
+  bench_pin(0);
+  for (uint32_t i = 0; i < p->frames; i++) {
+    bench_rx_frame_t *f;
+    while ((f = os_spsc_claim(&p->ring)) == NULL) {
+      sched_yield();
+    }
+    pipe_decode(&p->captures[i % BENCH_CODES], f, i);
+    os_spsc_publish(&p->ring);
+  }
+  return NULL;
+}
+
+static void *pipe_app_task(void *arg)
+{
+  pipe_run_t *p = arg;
+  bench_pin(1);
+  for (uint32_t i = 0; i < p->frames; i++) {
+    const bench_rx_frame_t *f;
+    while ((f = os_spsc_peek(&p->ring)) == NULL) {
+      sched_yield();
+    }
+    if (f->index != i) {
+      p->errors++;
+    }
+    pipe_store(p, f);
+    os_spsc_release(&p->ring);
+  }
+  return NULL;
+}
+
+static int pipe_bench(const bench_capture_t *captures, uint32_t frames)
+{
+  pipe_run_t p = { .captures = captures, .frames = frames, .crc = OS_CRC32_INIT };
+
+  uint64_t t0 = bench_now_ns();
+  for (uint32_t i = 0; i < frames; i++) {
+    pipe_decode(&captures[i % BENCH_CODES], &p.slots[0], i);
+    pipe_store(&p, &p.slots[0]);
+  }
+  double one = (double)(bench_now_ns() - t0) / 1e9;
+  uint32_t crc_one = p.crc;
+
+  p.crc = OS_CRC32_INIT;
+  os_spsc_init(&p.ring, p.slots, sizeof(bench_rx_frame_t), BENCH_PIPE_DEPTH);
+  pthread_t rx, app;
+  t0 = bench_now_ns();
+  pthread_create(&app, NULL, pipe_app_task, &p);
+  pthread_create(&rx, NULL, pipe_rx_task, &p);
+  pthread_join(rx, NULL);
+  pthread_join(app, NULL);
+  double two = (double)(bench_now_ns() - t0) / 1e9;
+  if (p.crc != crc_one) {
+    p.errors++;
+  }
+
+  os_spsc_stats_t st;
+  os_spsc_get_stats(&p.ring, &st);
+  printf("| 1 thread  | %8.0f | %5.2f | - | - |\n", frames / one, one * 1e9 / frames / 1000.0);
+  printf("| 2 threads | %8.0f | %5.2f | %u / %u | %u |\n", frames / two, two * 1e9 / frames / 1000.0,
+         (unsigned)st.high_water, (unsigned)BENCH_PIPE_DEPTH, (unsigned)st.full);
+  printf("speedup %.2fx, errors %u\n", one / two, (unsigned)p.errors);
+  return p.errors ? 1 : 0;
+}
+
+/* What the RX channel captures from the encoder output: levels inverted
+ * (active-low receiver) and the ending space cut by the idle threshold */
+static int pipe_make_captures(bench_capture_t *captures)
+{
+  static struct rmt_channel_t tx;
+  rmt_encoder_handle_t nec = NULL;
+  ir_nec_encoder_config_t enc_cfg = { .resolution = 1000000 };
+  if (rmt_new_ir_nec_encoder(&enc_cfg, &nec) != ESP_OK || ir_decoder_register_defaults() != ESP_OK) {
+    return 1;
+  }
+  rmt_host_channel_init(&tx, RMT_HOST_MEM_BLOCK_SYMBOLS);
+  srand(1);
+  for (uint32_t i = 0; i < BENCH_CODES; i++) {
+    bench_capture_t *c = &captures[i];
+    ir_nec_scan_code_t code = { .address = (uint16_t)rand(), .command = (uint16_t)rand() };
+    rmt_symbol_word_t sym[BENCH_FRAME_SYMBOLS];
+    size_t num = rmt_host_transmit(&tx, nec, &code, sizeof(code), sym, BENCH_FRAME_SYMBOLS);
+    if (!num) {
+      return 1;
+    }
+    sym[num - 1u].duration1 = 0;
+    ir_symbols_invert(sym, c->symbols, num);
+    c->symbol_num = num;
+    c->address = code.address;
+    c->command = code.command;
+  }
+  return 0;
+}
+
+/* ---- Main -------------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+  uint32_t records = 1000000u;
+  uint32_t frames = 200000u;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      records = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      frames = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "-p")) {
+      g_pin = 1;
+    } else {
+      fprintf(stderr, "usage: spsc_bench [-n records] [-f frames] [-p]\n");
+      return 2;
+    }
+  }
+  if (!records || !frames) {
+    return 2;
+  }
+
+  static const uint32_t sizes[] = { 16u, sizeof(bench_rx_frame_t) };
+  static const uint32_t caps[] = { 4u, 256u };
+  int fail = 0;
+  printf("ring hand-off, %u records, %ld CPUs%s\n\n", (unsigned)records, sysconf(_SC_NPROCESSORS_ONLN),
+         g_pin ? ", pinned" : "");
+  printf("| Queue | Record | Cap | Mrec/s | p50 (us) | p99 (us) | Full | Errors |\n");
+  printf("|---|---|---|---|---|---|---|---|\n");
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    for (size_t c = 0; c < sizeof(caps) / sizeof(caps[0]); c++) {
+      fail |= ring_run(BENCH_SPSC, sizes[s], caps[c], records);
+      fail |= ring_run(BENCH_MUTEX, sizes[s], caps[c], records);
+    }
+  }
+
+  static bench_capture_t captures[BENCH_CODES];
+  if (pipe_make_captures(captures)) {
+    printf("setup failed\n");
+    return 1;
+  }
+  printf("\nIR pipeline (decode | normalize + crc32), %u frames\n\n", (unsigned)frames);
+  printf("| Layout | Frames/s | us/frame | Ring hwm | Full |\n");
+  printf("|---|---|---|---|---|\n");
+  fail |= pipe_bench(captures, frames);
+  return fail;
+}
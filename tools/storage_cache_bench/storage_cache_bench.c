@@ -0,0 +1,302 @@
+/* storage_cache_bench.c — flash writes/day and write latency, write-back vs write-through
+ *
+ * Runs the real storage_cache.c against a modelled flash backend for one
+ * simulated day. Costs are a model (override on the command line), the
+ * counts are exact. Every NVS write, journal append and commit is one flash
+ * program; the bytes programmed follow the NVS entry layout and the journal
+ * record size:
+ *
+ *   storage_cache_bench [schedules] [period_s] [nvs_write_us] [journal_append_us] [commit_us]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "storage_cache.h"
+
+#define BENCH_DAY_S          86400u
+#define BENCH_RECORDS        128u
+#define BENCH_JOURNAL_RECS   256u   /* one 4 KiB sector of 16-byte records */
+#define BENCH_NVS_PAGE_ENTRIES 126u /* 32-byte entries per 4 KiB NVS page */
+#define BENCH_NVS_ENTRY_BYTES  32u
+#define BENCH_NVS_INLINE_MAX   8u   /* NVS stores values up to 8 bytes in the entry itself */
+#define BENCH_COMMIT_BYTES     32u  /* one commit record (free on NVS: an upper bound) */
+#define BENCH_SLOT_UPDATES   6u     /* slot metadata writes per day */
+#define BENCH_CONFIG_UPDATES 2u
+#define BENCH_POWER_CHANGES  6u     /* sleep/idle transitions per day */
+#define BENCH_MAX_SCHEDULES  64u
+
+typedef struct {
+  uint32_t nvs_write_us;
+  uint32_t journal_append_us;
+  uint32_t commit_us;
+} bench_cost_t;
+
+typedef struct {
+  scache_key_t key;
+  uint16_t     len;
+  uint8_t      used;
+  uint8_t      value[SCACHE_MAX_VALUE];
+} bench_rec_t;
+
+typedef struct {
+  bench_cost_t         cost;
+  uint64_t             clock_us;      /* modelled time */
+  bench_rec_t          flash[BENCH_RECORDS];
+  scache_journal_rec_t journal[BENCH_JOURNAL_RECS];
+  uint32_t             journal_len;
+  uint64_t             nvs_writes;
+  uint64_t             journal_appends;
+  uint64_t             journal_erases;
+  uint64_t             commits;
+  uint64_t             bytes;         /* programmed: NVS entries + journal records + commits */
+} bench_flash_t;
+
+static bench_flash_t g_flash;
+
+/* -------------------------------------------------------------------------- */
+/* Modelled backend                                                           */
+/* -------------------------------------------------------------------------- */
+
+static os_err_t bench_read(scache_key_t key, void *buf, uint16_t cap, uint16_t *len, void *ctx)
+{
+  (void)ctx;
+  for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+    if (g_flash.flash[i].used && g_flash.flash[i].key == key && g_flash.flash[i].len <= cap) {
+      memcpy(buf, g_flash.flash[i].value, g_flash.flash[i].len);
+      *len = g_flash.flash[i].len;
+      return OS_OK;
+    }
+  }
+  return OS_EINVAL;
+}
+
+/* Header entry, plus the data entries of a value too long to be inline */
+static uint32_t bench_nvs_bytes(uint16_t len)
+{
+  if (len <= BENCH_NVS_INLINE_MAX) {
+    return BENCH_NVS_ENTRY_BYTES;
+  }
+  return BENCH_NVS_ENTRY_BYTES * (1u + (len + BENCH_NVS_ENTRY_BYTES - 1u) / BENCH_NVS_ENTRY_BYTES);
+}
+
+static os_err_t bench_write(scache_key_t key, const void *buf, uint16_t len, void *ctx)
+{
+  (void)ctx;
+  bench_rec_t *slot = NULL;
+  for (uint32_t i = 0; i < BENCH_RECORDS && !slot; i++) {
+    if (g_flash.flash[i].used && g_flash.flash[i].key == key) {
+      slot = &g_flash.flash[i];
+    }
+  }
+  for (uint32_t i = 0; i < BENCH_RECORDS && !slot; i++) {
+    if (!g_flash.flash[i].used) {
+      slot = &g_flash.flash[i];
+    }
+  }
+  if (!slot) {
+    return OS_EFULL;
+  }
+  slot->used = 1u;
+  slot->key = key;
+  slot->len = len;
+  memcpy(slot->value, buf, len);
+  g_flash.nvs_writes++;
+  g_flash.bytes += bench_nvs_bytes(len);
+  g_flash.clock_us += g_flash.cost.nvs_write_us;
+  return OS_OK;
+}
+
+static os_err_t bench_commit(void *ctx)
+{
+  (void)ctx;
+  g_flash.commits++;
+  g_flash.bytes += BENCH_COMMIT_BYTES;
+  g_flash.clock_us += g_flash.cost.commit_us;
+  return OS_OK;
+}
+
+static os_err_t bench_journal_append(const scache_journal_rec_t *rec, void *ctx)
+{
+  (void)ctx;
+  if (g_flash.journal_len >= BENCH_JOURNAL_RECS) {
+    return OS_EFULL;
+  }
+  g_flash.journal[g_flash.journal_len++] = *rec;
+  g_flash.journal_appends++;
+  g_flash.bytes += sizeof(*rec);
+  g_flash.clock_us += g_flash.cost.journal_append_us;
+  return OS_OK;
+}
+
+static os_err_t bench_journal_replay(scache_replay_cb_t cb, void *cb_ctx, void *ctx)
+{
+  (void)ctx;
+  for (uint32_t i = 0; i < g_flash.journal_len; i++) {
+    cb(&g_flash.journal[i], cb_ctx);
+  }
+  return OS_OK;
+}
+
+static os_err_t bench_journal_reset(void *ctx)
+{
+  (void)ctx;
+  if (g_flash.journal_len) {
+    g_flash.journal_erases++;
+  }
+  g_flash.journal_len = 0u;
+  return OS_OK;
+}
+
+static uint32_t bench_now_us(void *ctx)
+{
+  (void)ctx;
+  return (uint32_t)g_flash.clock_us;
+}
+
+static os_err_t bench_cache_init(void)
+{
+  const scache_config_t cfg = {
+    .backend = {
+      .read = bench_read,
+      .write = bench_write,
+      .commit = bench_commit,
+      .journal_append = bench_journal_append,
+      .journal_replay = bench_journal_replay,
+      .journal_reset = bench_journal_reset,
+      .now_us = bench_now_us,
+    },
+  };
+  return scache_init(&cfg);
+}
+
+/* -------------------------------------------------------------------------- */
+/* One simulated day                                                          */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  const char *name;
+  uint64_t    puts;
+  uint64_t    put_us_sum;
+  uint32_t    put_us_max;
+  uint32_t    last_run[BENCH_MAX_SCHEDULES];
+} bench_result_t;
+
+static void bench_put(bench_result_t *r, scache_key_t key, const void *v, uint16_t len, uint32_t flags)
+{
+  uint64_t t0 = g_flash.clock_us;
+  if (scache_put(key, v, len, flags) != OS_OK) {
+    fprintf(stderr, "put failed key=0x%08x\n", (unsigned)key);
+    exit(1);
+  }
+  uint32_t dt = (uint32_t)(g_flash.clock_us - t0);
+  r->puts++;
+  r->put_us_sum += dt;
+  if (dt > r->put_us_max) {
+    r->put_us_max = dt;
+  }
+}
+
+static void bench_day(bench_result_t *r, bool write_back, uint32_t schedules, uint32_t period_s)
+{
+  const uint32_t last_run_flags = write_back ? SCACHE_F_JOURNAL : SCACHE_F_SYNC;
+  const uint32_t plain_flags = write_back ? 0u : SCACHE_F_SYNC;
+  uint8_t meta[16] = {0};
+
+  for (uint32_t t = 1; t <= BENCH_DAY_S; t++) {
+    for (uint32_t id = 0; id < schedules; id++) {
+      /* Stagger schedules across the period */
+      if ((t + id * (period_s / schedules)) % period_s == 0u) {
+        r->last_run[id] = t;
+        bench_put(r, SCACHE_KEY(SCACHE_NS_SCHED, id), &t, sizeof(t), last_run_flags);
+      }
+    }
+    if (t % (BENCH_DAY_S / BENCH_SLOT_UPDATES) == 0u) {
+      meta[0]++;
+      bench_put(r, SCACHE_KEY(SCACHE_NS_SLOT_META, meta[0] % 4u), meta, sizeof(meta), plain_flags);
+    }
+    if (t % (BENCH_DAY_S / BENCH_CONFIG_UPDATES) == 0u) {
+      meta[1]++;
+      bench_put(r, SCACHE_KEY(SCACHE_NS_CONFIG, 1), meta, sizeof(meta), plain_flags);
+    }
+    if (write_back) {
+      if (t % (BENCH_DAY_S / BENCH_POWER_CHANGES) == 0u) {
+        (void)scache_flush(SCACHE_FLUSH_POWER);
+      }
+      (void)scache_tick(t);
+    }
+  }
+}
+
+/* Reboot without a final flush: replayed state must equal the last persisted */
+static bool bench_reboot_check(const bench_result_t *r, uint32_t schedules)
+{
+  if (bench_cache_init() != OS_OK) {
+    return false;
+  }
+  for (uint32_t id = 0; id < schedules; id++) {
+    uint32_t v = 0;
+    uint16_t len = 0;
+    if (scache_get(SCACHE_KEY(SCACHE_NS_SCHED, id), &v, sizeof(v), &len) != OS_OK || v != r->last_run[id]) {
+      printf("  reboot check: schedule %u last_run=%u expected %u\n", (unsigned)id, (unsigned)v,
+             (unsigned)r->last_run[id]);
+      return false;
+    }
+  }
+  return true;
+}
+
+static void bench_report(const bench_result_t *r)
+{
+  uint64_t nvs_pages = (g_flash.nvs_writes + BENCH_NVS_PAGE_ENTRIES - 1u) / BENCH_NVS_PAGE_ENTRIES;
+  uint64_t programs = g_flash.nvs_writes + g_flash.journal_appends + g_flash.commits;
+  printf("%-14s %10llu %10llu %10llu %10llu %10llu %10llu %12llu %10.1f %10u\n", r->name,
+         (unsigned long long)r->puts, (unsigned long long)g_flash.nvs_writes,
+         (unsigned long long)g_flash.journal_appends, (unsigned long long)g_flash.commits,
+         (unsigned long long)programs, (unsigned long long)g_flash.bytes,
+         (unsigned long long)(nvs_pages + g_flash.journal_erases),
+         r->puts ? (double)r->put_us_sum / (double)r->puts : 0.0, (unsigned)r->put_us_max);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t schedules = (argc > 1) ? (uint32_t)atoi(argv[1]) : 16u;
+  uint32_t period_s = (argc > 2) ? (uint32_t)atoi(argv[2]) : 900u;
+  bench_cost_t cost = {
+    .nvs_write_us = (argc > 3) ? (uint32_t)atoi(argv[3]) : 1500u,
+    .journal_append_us = (argc > 4) ? (uint32_t)atoi(argv[4]) : 120u,
+    .commit_us = (argc > 5) ? (uint32_t)atoi(argv[5]) : 50u,
+  };
+  if (schedules == 0u || schedules > BENCH_MAX_SCHEDULES || period_s < schedules) {
+    fprintf(stderr, "schedules must be 1..%u and period_s >= schedules\n", (unsigned)BENCH_MAX_SCHEDULES);
+    return 1;
+  }
+
+  printf("one day: %u schedules every %u s, %u slot + %u config updates, %u power changes\n",
+         (unsigned)schedules, (unsigned)period_s, (unsigned)BENCH_SLOT_UPDATES,
+         (unsigned)BENCH_CONFIG_UPDATES, (unsigned)BENCH_POWER_CHANGES);
+  printf("cache: %u entries, flush every %u s, journal %u records\n", (unsigned)SCACHE_MAX_ENTRIES,
+         (unsigned)SCACHE_DEFAULT_FLUSH_S, (unsigned)BENCH_JOURNAL_RECS);
+  printf("model: nvs write %u us, journal append %u us, commit %u us\n\n",
+         (unsigned)cost.nvs_write_us, (unsigned)cost.journal_append_us, (unsigned)cost.commit_us);
+  printf("%-14s %10s %10s %10s %10s %10s %10s %12s %10s %10s\n", "mode", "puts", "nvs_wr", "journal",
+         "commits", "programs", "bytes", "erases(est)", "put_us", "put_max");
+
+  static const bool modes[] = { false, true };
+  bool ok = true;
+  for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+    bench_result_t r = { .name = modes[m] ? "write-back" : "write-through" };
+    memset(&g_flash, 0, sizeof(g_flash));
+    g_flash.cost = cost;
+    if (bench_cache_init() != OS_OK) {
+      return 1;
+    }
+    bench_day(&r, modes[m], schedules, period_s);
+    bench_report(&r);
+    if (modes[m] && !bench_reboot_check(&r, schedules)) {
+      ok = false;
+    }
+  }
+  printf("\nreboot check (no final flush, journal replay): %s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}